@@ -7,36 +7,44 @@
 #include <stdbool.h>
 #include "fsrs.h"
 
-#define MAX_CARDS 100
 #define MAX_REVIEWS 100
+// Days start at 4am UTC
+#define DAY_ROLLOVER_HOUR 4
+#define JOURNAL_COMPACT_THRESHOLD 1000
 
 typedef struct {
     time_t timestamp;
     int grade;
 } Review;
 
+// A card's text and review history. Its scheduling state lives in a card store, at the
+// same index as in the cards array.
 typedef struct {
     char question[51], answer[51];
-    float difficulty, stability;
-    int interval;
-    time_t last_review;
     Review reviews[MAX_REVIEWS];
     size_t review_count;
 } Card;
 
-size_t load_cards(Card cards[], const char* filename) {
+size_t load_cards(Card** cards_out, const char* filename) {
     FILE* file = fopen(filename, "r");
     if (!file) return 0;
     
-    int count = 0;
+    Card* cards = NULL;
+    size_t count = 0, capacity = 0;
     char line[4096];
 
-    while (count < MAX_CARDS) {
+    while (true) {
         // Parse question (first line)
         if (!fgets(line, sizeof(line), file)) break;
         line[strcspn(line, "\n")] = 0;
         if (strlen(line) == 0) continue;  // Skip empty lines
         
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            Card* const grown = realloc(cards, capacity * sizeof(Card));
+            if (!grown) break;
+            cards = grown;
+        }
         strncpy(cards[count].question, line, sizeof(cards[count].question) - 1);
         cards[count].question[sizeof(cards[count].question) - 1] = '\0';
 
@@ -52,11 +60,6 @@ size_t load_cards(Card cards[], const char* filename) {
         if (!fgets(line, sizeof(line), file)) break;
         line[strcspn(line, "\n")] = 0;
 
-        // Initialize card defaults
-        cards[count].difficulty = 5.0f;
-        cards[count].stability = 2.5f;
-        cards[count].interval = 1;
-        cards[count].last_review = 0;
         cards[count].review_count = 0;
         
         // Parse review history
@@ -75,7 +78,6 @@ size_t load_cards(Card cards[], const char* filename) {
                 cards[count].reviews[cards[count].review_count].timestamp = timestamp;
                 cards[count].reviews[cards[count].review_count].grade = grade;
                 cards[count].review_count++;
-                cards[count].last_review = timestamp;
                 
                 token = strtok(NULL, " ");
             }
@@ -85,6 +87,7 @@ size_t load_cards(Card cards[], const char* filename) {
     }
     
     fclose(file);
+    *cards_out = cards;
     return count;
 }
 
@@ -118,66 +121,128 @@ void save_cards(Card cards[], size_t count, const char* filename) {
     fclose(file);
 }
 
-void save_parameters(const float* params, const char* filename) {
-    FILE* file = fopen(filename, "w");
-    if (!file) {
-        perror("Failed to open parameter file for writing");
+// Replaces each card's review history with the one recorded in the journal. A new
+// journal is seeded with the histories read from cards.txt instead.
+void load_reviews(fsrs_Journal* journal, Card cards[], size_t card_count) {
+    const fsrs_JournalContents contents = fsrs_journal_contents(journal);
+    if (contents.logs.num_cards == 0) {
+        for (size_t i = 0; i < card_count; i++) {
+            for (size_t j = 0; j < cards[i].review_count; j++) {
+                const fsrs_JournalReview review = {
+                    (int64_t)i,
+                    (int64_t)cards[i].reviews[j].timestamp,
+                    (uint32_t)cards[i].reviews[j].grade
+                };
+                fsrs_journal_append(journal, &review, 1);
+            }
+        }
         return;
     }
-    for (size_t i = 0; i < 19; i++) {
-        fprintf(file, "%.6f\n", params[i]);
-    }
-    fclose(file);
-}
 
-bool load_parameters(float* params, const char* filename) {
-    FILE* file = fopen(filename, "r");
-    if (!file) return false;
-    for (size_t i = 0; i < 19; i++) {
-        if (fscanf(file, "%f", &params[i]) != 1) {
-            fclose(file);
-            return false;
+    for (size_t i = 0; i < contents.logs.num_cards; i++) {
+        const int64_t card_id = contents.card_ids[i];
+        if (card_id < 0 || (size_t)card_id >= card_count) continue;
+        Card* const card = &cards[card_id];
+        card->review_count = 0;
+        for (size_t k = contents.logs.offsets[i]; k < contents.logs.offsets[i + 1]; k++) {
+            if (card->review_count == MAX_REVIEWS) break;
+            card->reviews[card->review_count].timestamp = (time_t)contents.logs.timestamps[k];
+            card->reviews[card->review_count].grade = (int)contents.logs.ratings[k];
+            card->review_count++;
         }
     }
-    fclose(file);
-    return true;
 }
 
-// Helper function to create a contiguous array from array of pointers
-fsrs_FSRSItem* create_contiguous_items(fsrs_FSRSItem* const* const item_pointers, 
-                                             const size_t count) {
-
-    if (count == 0 || !item_pointers) {
-        return NULL;
+// Persists the session: cards.txt is only rewritten when there is no journal or the
+// card set itself changed, and the journal is compacted once enough reviews pile up.
+void save_session(fsrs_Journal* journal, Card cards[], size_t card_count, bool cards_changed) {
+    if (!journal || cards_changed) {
+        save_cards(cards, card_count, "cards.txt");
     }
-    
-    fsrs_FSRSItem* const contiguous_items = malloc(count * sizeof(fsrs_FSRSItem));
-    if (!contiguous_items) {
-        return NULL;
+    if (journal) {
+        if (fsrs_journal_pending(journal) >= JOURNAL_COMPACT_THRESHOLD) {
+            fsrs_journal_compact(journal);
+        }
+        fsrs_journal_free(journal);
     }
-    
-    for (size_t i = 0; i < count; i++) {
-        if (item_pointers[i]) {
-            contiguous_items[i] = *item_pointers[i];
+}
+
+// Flattens all review histories into one array each of timestamps and ratings, with card
+// i's reviews at [offsets[i], offsets[i + 1]). The arrays must hold every review.
+void flatten_reviews(Card cards[], size_t card_count, int64_t* timestamps, uint32_t* ratings, size_t* offsets) {
+    size_t review_index = 0;
+    for (size_t i = 0; i < card_count; i++) {
+        offsets[i] = review_index;
+        for (size_t j = 0; j < cards[i].review_count; j++) {
+            timestamps[review_index] = (int64_t)cards[i].reviews[j].timestamp;
+            ratings[review_index] = (uint32_t)cards[i].reviews[j].grade;
+            review_index++;
         }
     }
-    
-    return contiguous_items;
+    offsets[card_count] = review_index;
 }
 
-// Function to free FSRSItems array
-void free_fsrs_items(fsrs_FSRSItem** const items, const size_t count) {
-    if (!items) {
-        return;
+size_t count_reviews(Card cards[], size_t card_count) {
+    size_t total_reviews = 0;
+    for (size_t i = 0; i < card_count; i++) {
+        total_reviews += cards[i].review_count;
     }
-    
-    for (size_t i = 0; i < count; i++) {
-        fsrs_item_free(items[i]);
+    return total_reviews;
+}
+
+int32_t day_of(time_t timestamp) {
+    return (int32_t)(((int64_t)timestamp - DAY_ROLLOVER_HOUR * 3600) / 86400);
+}
+
+// Stores the memory state and due day replayed from a card's history; card ids are
+// indices into the cards array.
+void store_rescheduled(void* user_data, const fsrs_RescheduledCard* rescheduled, size_t len) {
+    fsrs_CardState* const states = user_data;
+    for (size_t i = 0; i < len; i++) {
+        states[rescheduled[i].card_id].memory = rescheduled[i].memory;
+        states[rescheduled[i].card_id].due_day = rescheduled[i].due_day;
     }
-    free(items);
 }
 
-float* optimize_parameters(Card cards[], size_t card_count, const fsrs_FSRS* fsrs) {
+// Builds the card store by replaying every card's review history. Cards never reviewed
+// are new and due today.
+fsrs_CardStore* build_store(const fsrs_FSRS* fsrs, Card cards[], size_t card_count, int32_t today) {
+    const size_t total_reviews = count_reviews(cards, card_count);
+    int64_t* timestamps = malloc((total_reviews + 1) * sizeof(int64_t));
+    uint32_t* ratings = malloc((total_reviews + 1) * sizeof(uint32_t));
+    fsrs_FSRSReview* reviews = malloc((total_reviews + 1) * sizeof(fsrs_FSRSReview));
+    size_t* offsets = malloc((card_count + 1) * sizeof(size_t));
+    int64_t* card_ids = malloc((card_count + 1) * sizeof(int64_t));
+    int32_t* last_review_days = malloc((card_count + 1) * sizeof(int32_t));
+    fsrs_CardState* states = malloc((card_count + 1) * sizeof(fsrs_CardState));
+    fsrs_CardStore* store = NULL;
+    if (timestamps && ratings && reviews && offsets && card_ids && last_review_days && states) {
+        flatten_reviews(cards, card_count, timestamps, ratings, offsets);
+        for (size_t i = 0; i < card_count; i++) {
+            const size_t count = cards[i].review_count;
+            card_ids[i] = (int64_t)i;
+            last_review_days[i] = count ? day_of(cards[i].reviews[count - 1].timestamp) : today;
+            states[i] = (fsrs_CardState){.last_review_day = count ? last_review_days[i] : 0, .due_day = today};
+        }
+        fsrs_FsrsReviewLogs logs = {timestamps, ratings, offsets, card_count};
+        fsrs_review_histories_from_logs(&logs, 0, DAY_ROLLOVER_HOUR, reviews);
+        fsrs_FsrsReviewHistories histories = {reviews, offsets, card_count};
+        fsrs_reschedule(fsrs, &histories, card_ids, last_review_days, 0.9f, store_rescheduled, states);
+
+        store = fsrs_card_store_new(card_count);
+        fsrs_card_store_push(store, card_ids, states, card_count);
+    }
+    free(timestamps);
+    free(ratings);
+    free(reviews);
+    free(offsets);
+    free(card_ids);
+    free(last_review_days);
+    free(states);
+    return store;
+}
+
+float* optimize_parameters(Card cards[], size_t card_count, const fsrs_FSRS* fsrs, size_t* params_len) {
     if (card_count == 0) {
         printf("No cards available for optimization\n");
         return NULL;
@@ -185,94 +250,68 @@ float* optimize_parameters(Card cards[], size_t card_count, const fsrs_FSRS* fsr
     
     printf("Processing %zu cards for optimization...\n", card_count);
     
-    // Create array to hold all FSRSItem pointers from all cards
-    fsrs_FSRSItem** items = malloc(card_count * MAX_REVIEWS * sizeof(fsrs_FSRSItem*));
-    if (!items) {
-        printf("Failed to allocate memory for items array\n");
+    // Flatten all review histories into one array, with card i's reviews at
+    // [offsets[i], offsets[i + 1])
+    size_t total_reviews = count_reviews(cards, card_count);
+    
+    int64_t* timestamps = malloc((total_reviews + 1) * sizeof(int64_t));
+    uint32_t* ratings = malloc((total_reviews + 1) * sizeof(uint32_t));
+    fsrs_FSRSReview* reviews = malloc((total_reviews + 1) * sizeof(fsrs_FSRSReview));
+    size_t* offsets = malloc((card_count + 1) * sizeof(size_t));
+    fsrs_FSRSReview* kept_reviews = malloc((total_reviews + 1) * sizeof(fsrs_FSRSReview));
+    size_t* kept_offsets = malloc((card_count + 1) * sizeof(size_t));
+    if (!timestamps || !ratings || !reviews || !offsets || !kept_reviews || !kept_offsets) {
+        printf("Failed to allocate memory for review histories\n");
+        free(timestamps);
+        free(ratings);
+        free(reviews);
+        free(offsets);
+        free(kept_reviews);
+        free(kept_offsets);
         return NULL;
     }
     
-    size_t valid_items = 0;
+    flatten_reviews(cards, card_count, timestamps, ratings, offsets);
     
-    // Process each card and create multiple FSRSItems from its review history
-    for (size_t i = 0; i < card_count; i++) {
-        if (cards[i].review_count < 2) {
-            continue;  // Need at least 2 reviews to create meaningful items
-        }
-        
-        // Create multiple FSRSItems from this card's history (like optimize.c does)
-        for (size_t seq_len = 2; seq_len <= cards[i].review_count; seq_len++) {
-            fsrs_FSRSReview* reviews = malloc(seq_len * sizeof(fsrs_FSRSReview));
-            if (!reviews) continue;
+    // Let the library turn timestamps into day intervals (UTC days starting at 4am)
+    // and build every usable review sequence from them
+    fsrs_FsrsReviewLogs logs = {timestamps, ratings, offsets, card_count};
+    fsrs_review_histories_from_logs(&logs, 0, DAY_ROLLOVER_HOUR, reviews);
+    
+    fsrs_FsrsReviewHistories histories = {reviews, offsets, card_count};
 
-            // Convert the actual review history to FSRSReview format
-            bool has_positive_delta_t = false;
+    // Drop manual reschedules and implausible intervals; same-day repeats are real
+    // learning steps here, so duplicates are kept
+    fsrs_HistoryFilter filter = fsrs_history_filter_default();
+    fsrs_HistoryFilterCounts dropped =
+        fsrs_review_histories_filter(&histories, &filter, kept_reviews, kept_offsets);
+    printf("Filtered out %zu manual, %zu duplicate and %zu out-of-range reviews\n",
+           dropped.manual_reviews, dropped.duplicate_reviews, dropped.extreme_delta_t_reviews);
 
-            for (size_t j = 0; j < seq_len; j++) {
-                if (j == 0) {
-                    reviews[j].delta_t = 0;  // First review always 0
-                } else {
-                    // Calculate days between reviews
-                    time_t prev_time = cards[i].reviews[j-1].timestamp;
-                    time_t curr_time = cards[i].reviews[j].timestamp;
-                    uint32_t delta_days = (uint32_t)((curr_time - prev_time) / (24 * 60 * 60));
-                    reviews[j].delta_t = delta_days;
-                    if (delta_days > 0) {
-                        has_positive_delta_t = true;
-                    }
-                }
-                
-                // Use actual grade from review history
-                reviews[j].rating = (uint32_t)cards[i].reviews[j].grade;
-            }
-            
-            // Only create items with valid review sequences
-            if (has_positive_delta_t && seq_len > 1) {
-                fsrs_FsrsReviews review_collection = {reviews, seq_len};
-                fsrs_FSRSItem* item = fsrs_item_new(&review_collection);
-                
-                if (item) {
-                    items[valid_items] = item;
-                    valid_items++;
-                }
-            }
-            
-            free(reviews);
-        }
-    }
+    fsrs_FsrsReviewHistories kept = {kept_reviews, kept_offsets, card_count};
+    fsrs_FsrsItems* train_set = fsrs_train_set_from_histories(&kept);
     
-    printf("Created %zu valid items from review history\n", valid_items);
+    free(timestamps);
+    free(ratings);
+    free(reviews);
+    free(offsets);
+    free(kept_reviews);
+    free(kept_offsets);
     
-    if (valid_items < 3) {  // Need sufficient items for meaningful optimization
-        printf("Need at least 3 items for optimization, only have %zu\n", valid_items);
-        for (size_t i = 0; i < valid_items; i++) {
-            fsrs_item_free(items[i]);
-        }
-        free(items);
+    printf("Created %zu valid items from review history\n", train_set->len);
+    
+    if (train_set->len < 3) {  // Need sufficient items for meaningful optimization
+        printf("Need at least 3 items for optimization, only have %zu\n", train_set->len);
+        fsrs_items_free(train_set);
         return NULL;
     }
 
-    // Create contiguous array for the train_set
-    fsrs_FSRSItem* const contiguous_items = create_contiguous_items(items, valid_items);
-    if (!contiguous_items) {
-        printf("Error: Failed to create contiguous items array\n");
-        free_fsrs_items(items, valid_items);
-        return NULL;
-    }
-    
-    // Create FsrsItems structure for optimization
-    fsrs_FsrsItems train_set = {
-        .items = contiguous_items, 
-        .len = valid_items
-    };
-
     // Optimize the FSRS model using the created items
     printf("\nOptimizing parameters...\n");
-    float* const optimized_parameters = fsrs_compute_parameters(fsrs, &train_set);
+    float* const optimized_parameters = fsrs_compute_parameters(fsrs, train_set, params_len);
     
     // Clean up
-    free(contiguous_items);
-    free_fsrs_items(items, valid_items);
+    fsrs_items_free(train_set);
 
     return optimized_parameters;
 }
@@ -280,32 +319,35 @@ float* optimize_parameters(Card cards[], size_t card_count, const fsrs_FSRS* fsr
 int main() {
     // Set locale for UTF-8 support (required for CJK characters)
     setlocale(LC_ALL, "");
-    float params[] = {
+    const float params[] = {
         0.40255f, 1.18385f, 3.173f, 15.69105f, 7.1949f, 0.5345f, 
         1.4604f, 0.0046f, 1.54575f, 0.1192f, 1.01925f, 1.9395f, 
         0.11f, 0.29605f, 2.2698f, 0.2315f, 2.9898f, 0.51655f, 0.6621f
     };
 
-    if (load_parameters(params, "fsrs_params.txt")) {
-        printf("Loaded parameters from fsrs_params.txt\n");
+    const fsrs_FSRS* fsrs = fsrs_snapshot_load("fsrs_params.bin");
+    if (fsrs) {
+        printf("Loaded parameters from fsrs_params.bin\n");
     } else {
         printf("No custom parameters found, using defaults\n");
+        fsrs = fsrs_new(params, sizeof(params) / sizeof(params[0]));
     }
-
-    const fsrs_FSRS* fsrs = fsrs_new(params, 19);
     
-    Card cards[MAX_CARDS];
-    size_t card_count = load_cards(cards, "cards.txt");
+    Card* cards = NULL;
+    size_t card_count = load_cards(&cards, "cards.txt");
+    const bool cards_created = card_count == 0;
     if (card_count == 0) {
         printf("No cards found, creating some sample cards\n");
         
+        free(cards);
+        cards = malloc(sizeof(Card));
+        if (!cards) {
+            fsrs_free(fsrs);
+            return EXIT_FAILURE;
+        }
         cards[0] = (Card) {
             .question = "こんにちは (Hello in Japanese)",
             .answer = "Konnichiwa - A greeting meaning 'hello' or 'good afternoon'",
-            .difficulty = 5.0f,
-            .stability = 2.5f,
-            .interval = 3,
-            .last_review = time(NULL) - 86400 * 3,
             .review_count = 2
         };
         
@@ -317,13 +359,21 @@ int main() {
         card_count = 1;
     }
     
+    // Review history lives in an append-only journal: a session appends only its own
+    // reviews, and startup reads the last snapshot plus the journal tail
+    fsrs_Journal* const journal = fsrs_journal_open("reviews.journal", "reviews.snapshot");
+    if (journal) {
+        load_reviews(journal, cards, card_count);
+    }
+    
     printf("Flashcard App\n1. Review cards\n2. Optimize parameters\n3. Quit\nChoice: ");
     int choice;
     scanf("%d", &choice);
     getchar();
     
     if (choice == 3) {
-        save_cards(cards, card_count, "cards.txt");
+        save_session(journal, cards, card_count, cards_created);
+        free(cards);
         fsrs_free(fsrs);
         printf("Goodbye!\n");
         return EXIT_SUCCESS;
@@ -331,14 +381,16 @@ int main() {
     
     if (choice == 2) {
         printf("Optimizing parameters...\n");
-        float* optimized = optimize_parameters(cards, card_count, fsrs);
+        size_t optimized_len = 0;
+        float* optimized = optimize_parameters(cards, card_count, fsrs, &optimized_len);
         if (optimized) {
             fsrs_free(fsrs);
-            fsrs = fsrs_new(optimized, 19);
+            fsrs = fsrs_new(optimized, optimized_len);
             printf("Parameters optimized based on your review history!\n");
-            save_parameters(optimized, "fsrs_params.txt");
-            printf("Saved new parameters to fsrs_params.txt\n");
-            fsrs_parameters_free(optimized);
+            if (fsrs_snapshot_save(fsrs, "fsrs_params.bin")) {
+                printf("Saved new parameters to fsrs_params.bin\n");
+            }
+            fsrs_parameters_free(optimized, optimized_len);
         } else {
             printf("Need at least 3 items with review history for optimization\n");
         }
@@ -346,59 +398,63 @@ int main() {
 
     
     time_t now = time(NULL);
+    const int32_t today = day_of(now);
+    fsrs_CardStore* const store = build_store(fsrs, cards, card_count, today);
+    size_t* const due = malloc(card_count * sizeof(size_t));
+    if (!store || !due) {
+        printf("Failed to allocate memory for the card store\n");
+        fsrs_card_store_free(store);
+        free(due);
+        save_session(journal, cards, card_count, cards_created);
+        free(cards);
+        fsrs_free(fsrs);
+        return EXIT_FAILURE;
+    }
+    const size_t due_count = fsrs_card_store_due(store, today, due, card_count);
     size_t cards_reviewed = 0;
-    for (size_t i = 0; i < card_count; i++) {
-        if (now - cards[i].last_review >= cards[i].interval * 86400) {
-            printf("\nCard: %s\n", cards[i].question);
-            printf("Press Enter to see answer...");
-            getchar();
-            printf("Answer: %s\n", cards[i].answer);
-            printf("Rate (1=Again, 2=Hard, 3=Good, 4=Easy, 0=Quit): ");
-            
-            int rating;
-            scanf("%d", &rating);
-            getchar();
-            
-            if (rating == 0) {
-                printf("Quitting review session...\n");
-                break;
-            }
-            
-            if (rating < 1 || rating > 4) rating = 3;
-            
-            fsrs_MemoryState* memory = fsrs_memory_state_new(cards[i].stability, cards[i].difficulty);
-            uint32_t days_elapsed = (now - cards[i].last_review) / 86400;
-            fsrs_NextStates* states = fsrs_next_states(fsrs, memory, 0.9f, days_elapsed);
-            
-            fsrs_ItemState new_state;
-            switch (rating) {
-                case 1: new_state = fsrs_next_states_again(states); break;
-                case 2: new_state = fsrs_next_states_hard(states); break;
-                case 3: new_state = fsrs_next_states_good(states); break;
-                case 4: new_state = fsrs_next_states_easy(states); break;
-            }
-            
-            cards[i].difficulty = new_state.memory.difficulty;
-            cards[i].stability = new_state.memory.stability;
-            cards[i].interval = (int)new_state.interval;
-            cards[i].last_review = now;
-            
-            // Add review to history
-            if (cards[i].review_count < MAX_REVIEWS) {
-                cards[i].reviews[cards[i].review_count].timestamp = now;
-                cards[i].reviews[cards[i].review_count].grade = rating;
-                cards[i].review_count++;
-            }
-            
-            printf("Next review in %" PRId32 " days\n", cards[i].interval);
-            cards_reviewed++;
-            
-            fsrs_next_states_free(states);
-            fsrs_memory_state_free(memory);
+    for (size_t d = 0; d < due_count; d++) {
+        const size_t i = due[d];
+        printf("\nCard: %s\n", cards[i].question);
+        printf("Press Enter to see answer...");
+        getchar();
+        printf("Answer: %s\n", cards[i].answer);
+        printf("Rate (1=Again, 2=Hard, 3=Good, 4=Easy, 0=Quit): ");
+        
+        int rating;
+        scanf("%d", &rating);
+        getchar();
+        
+        if (rating == 0) {
+            printf("Quitting review session...\n");
+            break;
         }
+        
+        if (rating < 1 || rating > 4) rating = 3;
+        
+        const uint32_t grade = (uint32_t)rating;
+        fsrs_card_store_review(fsrs, store, &i, &grade, 1, today, 0.9f);
+        fsrs_CardState state;
+        fsrs_card_store_get(store, i, &state);
+        
+        // Add review to history
+        if (cards[i].review_count < MAX_REVIEWS) {
+            cards[i].reviews[cards[i].review_count].timestamp = now;
+            cards[i].reviews[cards[i].review_count].grade = rating;
+            cards[i].review_count++;
+        }
+        if (journal) {
+            const fsrs_JournalReview review = {(int64_t)i, (int64_t)now, grade};
+            fsrs_journal_append(journal, &review, 1);
+        }
+        
+        printf("Next review in %" PRId32 " days\n", state.due_day - today);
+        cards_reviewed++;
     }
     
-    save_cards(cards, card_count, "cards.txt");
+    fsrs_card_store_free(store);
+    free(due);
+    save_session(journal, cards, card_count, cards_created);
+    free(cards);
     fsrs_free(fsrs);
     if (cards_reviewed > 0) {
         printf("Session complete! Reviewed %zu cards.\n", cards_reviewed);
@@ -0,0 +1,68 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include "fsrs.h"
+
+// Default FSRS parameters (equivalent to DEFAULT_PARAMETERS in Python)
+static const float DEFAULT_PARAMETERS[] = {
+    0.40255f, 1.18385f, 3.173f, 15.69105f, 7.1949f, 0.5345f, 1.4604f, 0.0046f, 
+    1.54575f, 0.1192f, 1.01925f, 1.9395f, 0.11f, 0.29605f, 2.2698f, 0.2315f, 
+    2.9898f, 0.51655f, 0.6621f
+};
+static const size_t DEFAULT_PARAMETERS_LEN = sizeof(DEFAULT_PARAMETERS) / sizeof(DEFAULT_PARAMETERS[0]);
+
+#define DEFAULT_CALLS 20000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Times the single-card scheduling path: one fsrs_next_states call and its free.
+static double time_next_states(const fsrs_FSRS* const fsrs, const size_t calls) {
+    const double start = now_seconds();
+    for (size_t i = 0; i < calls; i++) {
+        fsrs_MemoryState memory_state = {1.0f + (float)(i % 100), 5.0f};
+        fsrs_NextStates* const next_states = fsrs_next_states(fsrs, &memory_state, 0.9f, (uint32_t)(i % 30));
+        fsrs_next_states_free(next_states);
+    }
+    return (now_seconds() - start) / (double)calls;
+}
+
+// Times a call that does almost no work, so the cost of crossing into the library
+// dominates: the retrievability of a single card.
+static double time_retrievability(const fsrs_FSRS* const fsrs, const size_t calls) {
+    volatile float sink = 0.0f;
+    const double start = now_seconds();
+    for (size_t i = 0; i < calls; i++) {
+        const fsrs_MemoryState memory_state = {1.0f + (float)(i % 100), 5.0f};
+        const uint32_t days_elapsed = (uint32_t)(i % 30);
+        float retrievability;
+        fsrs_retrievability_batch(fsrs, &memory_state, &days_elapsed, &retrievability, 1);
+        sink += retrievability;
+    }
+    (void)sink;
+    return (now_seconds() - start) / (double)calls;
+}
+
+// Prints the per-call cost of the single-card paths. lto.sh builds it against the
+// shared library, the static library and the LTO build.
+int main(int argc, char** argv) {
+    const size_t calls = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_CALLS;
+    const fsrs_FSRS* const fsrs = fsrs_new(DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
+
+    // Warm up caches and lazy initialization before timing
+    time_next_states(fsrs, calls / 10 + 1);
+    time_retrievability(fsrs, calls / 10 + 1);
+
+    const double next_states_ns = time_next_states(fsrs, calls) * 1e9;
+    const double retrievability_ns = time_retrievability(fsrs, calls * 10) * 1e9;
+    printf("%-32s %10.1f ns/call\n", "fsrs_next_states + free", next_states_ns);
+    printf("%-32s %10.1f ns/call\n", "fsrs_retrievability_batch (1)", retrievability_ns);
+
+    fsrs_free(fsrs);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,120 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+// FSRS-6 parameters; each deck below scales the initial stabilities and the decay
+static const float PARAMETERS[] = {
+    0.212f, 1.2931f, 2.3065f, 8.2956f, 6.4133f, 0.8334f, 3.0194f, 0.001f,
+    1.8722f, 0.1666f, 0.796f, 1.4835f, 0.0614f, 0.2629f, 1.6483f, 0.6014f,
+    1.8729f, 0.5425f, 0.0912f, 0.0658f, 0.1542f
+};
+#define PARAMETERS_LEN (sizeof(PARAMETERS) / sizeof(PARAMETERS[0]))
+
+#define NUM_CARDS 6000
+// Deck NULL_DECK has no handle, and decks past NUM_HANDLES do not exist
+#define NUM_HANDLES 4
+#define NULL_DECK 2
+#define NUM_DECKS 6
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+static const fsrs_FSRS* new_deck(const size_t deck) {
+    float parameters[PARAMETERS_LEN];
+    for (size_t i = 0; i < PARAMETERS_LEN; i++) {
+        parameters[i] = PARAMETERS[i] * (i < 4 ? 1.0f + 0.5f * (float)deck : 1.0f);
+    }
+    parameters[PARAMETERS_LEN - 1] += 0.1f * (float)deck;
+    return fsrs_new(parameters, PARAMETERS_LEN);
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* handles[NUM_HANDLES];
+    for (size_t deck = 0; deck < NUM_HANDLES; deck++) {
+        handles[deck] = deck == NULL_DECK ? NULL : new_deck(deck);
+    }
+    uint32_t* const decks = malloc(NUM_CARDS * sizeof(uint32_t));
+    fsrs_MemoryState* const memory_states = malloc(NUM_CARDS * sizeof(fsrs_MemoryState));
+    uint32_t* const days_elapsed = malloc(NUM_CARDS * sizeof(uint32_t));
+    fsrs_NextStates* const next_states = malloc(NUM_CARDS * sizeof(fsrs_NextStates));
+    fsrs_NextStates* const untouched = malloc(NUM_CARDS * sizeof(fsrs_NextStates));
+    if (!handles[0] || !handles[1] || !handles[3] || !decks || !memory_states || !days_elapsed || !next_states
+        || !untouched) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // Decks interleaved at random, every eighth card new; the output starts out filled
+    // with a marker that cards without a handle must keep
+    uint64_t random = 11;
+    size_t invalid = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        decks[i] = next_random(&random) % NUM_DECKS;
+        invalid += decks[i] == NULL_DECK || decks[i] >= NUM_HANDLES;
+        memory_states[i] = i % 8 == 0 ? (fsrs_MemoryState){0}
+            : (fsrs_MemoryState){
+                .stability = 0.5f + (float)(next_random(&random) % 3000) / 10.0f,
+                .difficulty = 1.0f + (float)(next_random(&random) % 90) / 10.0f,
+            };
+        days_elapsed[i] = next_random(&random) % 200;
+        next_states[i] = (fsrs_NextStates){.good.interval = -1.0f};
+    }
+    memcpy(untouched, next_states, NUM_CARDS * sizeof(fsrs_NextStates));
+
+    // Each card matches a single-card call on its own deck's handle
+    const size_t failed = fsrs_next_states_batch_multi(handles, NUM_HANDLES, decks, memory_states, days_elapsed, 0.9f,
+                                                       next_states, NUM_CARDS);
+    size_t mismatched = 0;
+    size_t differ_from_first_deck = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        if (decks[i] == NULL_DECK || decks[i] >= NUM_HANDLES) {
+            mismatched += memcmp(&next_states[i], &untouched[i], sizeof(fsrs_NextStates)) != 0;
+            continue;
+        }
+        fsrs_MemoryState* const memory = memory_states[i].stability > 0.0f ? &memory_states[i] : NULL;
+        fsrs_NextStates* const expected = fsrs_next_states(handles[decks[i]], memory, 0.9f, days_elapsed[i]);
+        fsrs_NextStates* const first_deck = fsrs_next_states(handles[0], memory, 0.9f, days_elapsed[i]);
+        if (!expected || !first_deck || memcmp(expected, &next_states[i], sizeof(fsrs_NextStates)) != 0) {
+            mismatched++;
+        }
+        differ_from_first_deck += decks[i] != 0 && first_deck
+            && memcmp(first_deck, &next_states[i], sizeof(fsrs_NextStates)) != 0;
+        fsrs_next_states_free(expected);
+        fsrs_next_states_free(first_deck);
+    }
+    printf("Scheduled %d cards over %d decks: %zu failed, %zu different from their deck's handle\n",
+           NUM_CARDS, NUM_DECKS, failed, mismatched);
+    printf("%zu cards scheduled differently from the first deck\n", differ_from_first_deck);
+    bool ok = failed == invalid && mismatched == 0 && differ_from_first_deck > 0;
+
+    // Without any handles every card fails and none is written
+    memcpy(next_states, untouched, NUM_CARDS * sizeof(fsrs_NextStates));
+    const size_t failed_without_handles =
+        fsrs_next_states_batch_multi(NULL, 0, decks, memory_states, days_elapsed, 0.9f, next_states, NUM_CARDS);
+    const bool refused = failed_without_handles == NUM_CARDS
+        && memcmp(next_states, untouched, NUM_CARDS * sizeof(fsrs_NextStates)) == 0;
+    printf("Cards without a handle refused: %s\n", refused ? "yes" : "no");
+    ok &= refused;
+
+    for (size_t deck = 0; deck < NUM_HANDLES; deck++) {
+        if (handles[deck]) {
+            fsrs_free(handles[deck]);
+        }
+    }
+    free(decks);
+    free(memory_states);
+    free(days_elapsed);
+    free(next_states);
+    free(untouched);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Batches over several decks do not match their handles\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "fsrs.h"
+
+#define NUM_CARDS 3000
+#define NUM_REVIEWS 5000
+#define TODAY 500
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+static bool same_state(const fsrs_CardState* const a, const fsrs_CardState* const b) {
+    return a->memory.stability == b->memory.stability && a->memory.difficulty == b->memory.difficulty
+        && a->last_review_day == b->last_review_day && a->due_day == b->due_day;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_CardStore* const store = fsrs_card_store_new(0);
+    fsrs_CardStore* const one_by_one = fsrs_card_store_new(NUM_CARDS);
+    int64_t* const card_ids = malloc(NUM_CARDS * sizeof(int64_t));
+    fsrs_CardState* const states = malloc(NUM_CARDS * sizeof(fsrs_CardState));
+    size_t* const due = malloc(NUM_CARDS * sizeof(size_t));
+    size_t* const indices = malloc(NUM_REVIEWS * sizeof(size_t));
+    uint32_t* const ratings = malloc(NUM_REVIEWS * sizeof(uint32_t));
+    if (!fsrs || !store || !one_by_one || !card_ids || !states || !due || !indices || !ratings) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // Every fifth card is new; the others were reviewed over the last 400 days
+    uint64_t random = 3;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        card_ids[i] = 7000000 + (int64_t)i;
+        const int32_t last_review_day = TODAY - 400 + (int32_t)(next_random(&random) % 400);
+        states[i] = i % 5 == 0 ? (fsrs_CardState){.due_day = TODAY}
+            : (fsrs_CardState){
+                .memory = {.stability = 0.5f + (float)(next_random(&random) % 2000) / 10.0f,
+                           .difficulty = 1.0f + (float)(next_random(&random) % 90) / 10.0f},
+                .last_review_day = last_review_day,
+                .due_day = last_review_day + 1 + (int32_t)(next_random(&random) % 300),
+            };
+    }
+    // Pushed in two parts, the second continuing the indices of the first
+    const size_t first = fsrs_card_store_push(store, card_ids, states, NUM_CARDS / 2);
+    const size_t second = fsrs_card_store_push(store, &card_ids[NUM_CARDS / 2], &states[NUM_CARDS / 2],
+                                               NUM_CARDS - NUM_CARDS / 2);
+    fsrs_card_store_push(one_by_one, card_ids, states, NUM_CARDS);
+    bool ok = first == 0 && second == NUM_CARDS / 2 && fsrs_card_store_len(store) == NUM_CARDS;
+
+    // Cards read back as pushed, through both accessors
+    const fsrs_CardStoreColumns columns = fsrs_card_store_columns(store);
+    size_t misread = columns.len == NUM_CARDS ? 0 : 1;
+    for (size_t i = 0; i < NUM_CARDS && misread == 0; i++) {
+        fsrs_CardState state;
+        misread += !fsrs_card_store_get(store, i, &state) || !same_state(&state, &states[i])
+            || columns.ids[i] != card_ids[i] || columns.stability[i] != states[i].memory.stability
+            || columns.difficulty[i] != states[i].memory.difficulty
+            || columns.last_review_days[i] != states[i].last_review_day || columns.due_days[i] != states[i].due_day;
+    }
+    fsrs_CardState unread = states[0];
+    misread += fsrs_card_store_get(store, NUM_CARDS, &unread) || !same_state(&unread, &states[0]);
+    printf("Stored %zu cards, %zu read back wrong\n", fsrs_card_store_len(store), misread);
+    ok &= misread == 0;
+
+    // The due scan lists exactly the cards due by today, in index order, and counts the
+    // ones that do not fit
+    size_t expected_due = 0;
+    size_t misplaced = 0;
+    const size_t due_count = fsrs_card_store_due(store, TODAY, due, NUM_CARDS);
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        if (states[i].due_day <= TODAY) {
+            misplaced += expected_due >= due_count || due[expected_due] != i;
+            expected_due++;
+        }
+    }
+    const size_t counted = fsrs_card_store_due(store, TODAY, NULL, 0);
+    const size_t truncated = fsrs_card_store_due(store, TODAY, indices, 10);
+    bool truncated_ok = truncated == expected_due;
+    for (size_t i = 0; i < 10 && i < expected_due; i++) {
+        truncated_ok &= indices[i] == due[i];
+    }
+    printf("%zu cards due on day %d, %zu misplaced\n", due_count, TODAY, misplaced);
+    ok &= due_count == expected_due && counted == expected_due && misplaced == 0 && truncated_ok;
+
+    // A batch reviewing some cards several times, with a few invalid indices and ratings,
+    // must equal the same reviews applied one call at a time
+    size_t invalid = 0;
+    for (size_t i = 0; i < NUM_REVIEWS; i++) {
+        indices[i] = i % 3 == 0 ? next_random(&random) % 50 : next_random(&random) % NUM_CARDS;
+        ratings[i] = 1 + next_random(&random) % 4;
+        if (i % 701 == 0) {
+            indices[i] = NUM_CARDS + i;
+            invalid++;
+        } else if (i % 503 == 0) {
+            ratings[i] = i % 2 == 0 ? 0 : 5;
+            invalid++;
+        }
+    }
+    const size_t skipped = fsrs_card_store_review(fsrs, store, indices, ratings, NUM_REVIEWS, TODAY, 0.9f);
+    size_t skipped_one_by_one = 0;
+    for (size_t i = 0; i < NUM_REVIEWS; i++) {
+        skipped_one_by_one += fsrs_card_store_review(fsrs, one_by_one, &indices[i], &ratings[i], 1, TODAY, 0.9f);
+    }
+    size_t different = 0;
+    size_t unscheduled = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        fsrs_CardState batched;
+        fsrs_CardState sequential;
+        fsrs_card_store_get(store, i, &batched);
+        fsrs_card_store_get(one_by_one, i, &sequential);
+        different += !same_state(&batched, &sequential);
+        unscheduled += batched.last_review_day == TODAY && batched.due_day <= TODAY;
+    }
+    printf("Reviewed %d times: %zu skipped, %zu cards differ from one review per call\n",
+           NUM_REVIEWS, skipped, different);
+    ok &= skipped == invalid && skipped_one_by_one == invalid && different == 0 && unscheduled == 0;
+
+    // A missing array appends nothing to any column
+    const size_t null_ids = fsrs_card_store_push(store, NULL, states, 5);
+    const size_t null_states = fsrs_card_store_push(store, card_ids, NULL, 5);
+    const size_t empty = fsrs_card_store_push(store, NULL, NULL, 0);
+    const fsrs_CardStoreColumns after = fsrs_card_store_columns(store);
+    const bool nulls_rejected = null_ids == 0 && null_states == 0 && empty == NUM_CARDS
+        && fsrs_card_store_len(store) == NUM_CARDS && after.len == NUM_CARDS;
+    printf("Pushes with a NULL array rejected: %s\n", nulls_rejected ? "yes" : "no");
+    ok &= nulls_rejected;
+
+    fsrs_card_store_free(store);
+    fsrs_card_store_free(one_by_one);
+    free(card_ids);
+    free(states);
+    free(due);
+    free(indices);
+    free(ratings);
+    fsrs_free(fsrs);
+
+    if (!ok) {
+        fprintf(stderr, "Error: The card store does not match the cards pushed and reviewed\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
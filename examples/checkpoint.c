@@ -0,0 +1,119 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+static const float DEFAULT_PARAMETERS[] = {
+    0.40255f, 1.18385f, 3.173f, 15.69105f, 7.1949f, 0.5345f, 1.4604f, 0.0046f,
+    1.54575f, 0.1192f, 1.01925f, 1.9395f, 0.11f, 0.29605f, 2.2698f, 0.2315f,
+    2.9898f, 0.51655f, 0.6621f
+};
+static const size_t DEFAULT_PARAMETERS_LEN = sizeof(DEFAULT_PARAMETERS) / sizeof(DEFAULT_PARAMETERS[0]);
+
+#define NUM_CARDS 2000
+#define MAX_REVIEWS 24
+// Reviews become visible in this many steps, as if synced from a server over time.
+#define NUM_STEPS 4
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+// Builds the histories made of the first `step / NUM_STEPS` of each card's reviews.
+static void visible_histories(const fsrs_FSRSReview* const reviews,
+                              const size_t* const offsets,
+                              const size_t step,
+                              fsrs_FSRSReview* const out_reviews,
+                              size_t* const out_offsets) {
+    size_t written = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        const size_t len = offsets[i + 1] - offsets[i];
+        const size_t visible = len * step / NUM_STEPS;
+        out_offsets[i] = written;
+        memcpy(&out_reviews[written], &reviews[offsets[i]], visible * sizeof(fsrs_FSRSReview));
+        written += visible;
+    }
+    out_offsets[NUM_CARDS] = written;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
+    fsrs_FSRSReview* const reviews = malloc(NUM_CARDS * MAX_REVIEWS * sizeof(fsrs_FSRSReview));
+    fsrs_FSRSReview* const step_reviews = malloc(NUM_CARDS * MAX_REVIEWS * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    size_t* const step_offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    fsrs_MemoryCheckpoint* const incremental = calloc(NUM_CARDS, sizeof(fsrs_MemoryCheckpoint));
+    fsrs_MemoryCheckpoint* const replayed = calloc(NUM_CARDS, sizeof(fsrs_MemoryCheckpoint));
+    if (!fsrs || !reviews || !step_reviews || !offsets || !step_offsets || !incremental || !replayed) {
+        fprintf(stderr, "Error: Failed to set up checkpoints\n");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t random = 42;
+    size_t total = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        offsets[i] = total;
+        const size_t len = 1 + next_random(&random) % MAX_REVIEWS;
+        uint32_t interval = 1;
+        for (size_t k = 0; k < len; k++) {
+            const uint32_t rating = 1 + next_random(&random) % 4;
+            reviews[total++] = (fsrs_FSRSReview){
+                .rating = rating,
+                .delta_t = k == 0 ? 0 : interval,
+            };
+            interval = rating == 1 ? 1 : interval * (1 + rating / 2) % 36500 + 1;
+        }
+    }
+    offsets[NUM_CARDS] = total;
+
+    // Advance one set of checkpoints step by step as reviews arrive ...
+    size_t failed = 0;
+    fsrs_FsrsReviewHistories histories = {
+        .reviews = step_reviews,
+        .offsets = step_offsets,
+        .num_cards = NUM_CARDS,
+    };
+    for (size_t step = 1; step <= NUM_STEPS; step++) {
+        visible_histories(reviews, offsets, step, step_reviews, step_offsets);
+        failed += fsrs_checkpoints_advance(fsrs, &histories, incremental);
+    }
+
+    // ... and another over every review at once, starting from nothing.
+    histories.reviews = reviews;
+    histories.offsets = offsets;
+    failed += fsrs_checkpoints_advance(fsrs, &histories, replayed);
+
+    size_t mismatched = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        if (memcmp(&incremental[i].memory, &replayed[i].memory, sizeof(fsrs_MemoryState)) != 0
+            || incremental[i].last_review_day != replayed[i].last_review_day
+            || incremental[i].review_count != replayed[i].review_count
+            || incremental[i].review_count != offsets[i + 1] - offsets[i]) {
+            mismatched++;
+        }
+    }
+    const size_t invalid = fsrs_checkpoints_validate(fsrs, &histories, incremental, NUM_CARDS, 7);
+
+    printf("Checkpoints of %d cards advanced in %d steps over %zu reviews\n",
+           NUM_CARDS, NUM_STEPS, total);
+    printf("Failed to advance: %zu\n", failed);
+    printf("Different from a single replay: %zu\n", mismatched);
+    printf("Different from a full replay: %zu\n", invalid);
+
+    free(reviews);
+    free(step_reviews);
+    free(offsets);
+    free(step_offsets);
+    free(incremental);
+    free(replayed);
+    fsrs_free(fsrs);
+
+    if (failed != 0 || mismatched != 0 || invalid != 0) {
+        fprintf(stderr, "Error: Checkpoint replay differs from a full replay\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
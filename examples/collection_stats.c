@@ -0,0 +1,144 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fsrs.h"
+
+// Enough cards to be split over several parallel tasks
+#define NUM_CARDS 200000
+#define TODAY 1000
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+// The histogram bins as documented on fsrs_COLLECTION_STATS_BINS
+static size_t clamp_bin(const float position) {
+    if (!(position > 0.0f)) {
+        return 0;
+    }
+    const size_t bin = (size_t)position;
+    return bin < fsrs_COLLECTION_STATS_BINS ? bin : fsrs_COLLECTION_STATS_BINS - 1;
+}
+
+static size_t stability_bin(const float stability) {
+    int exponent = 0;
+    frexpf(stability, &exponent);
+    // floor(log2(stability)) + 1, so stabilities below 1 day land in bin 0
+    if (exponent < 0) {
+        return 0;
+    }
+    return (size_t)exponent < fsrs_COLLECTION_STATS_BINS ? (size_t)exponent : fsrs_COLLECTION_STATS_BINS - 1;
+}
+
+// Computes the statistics one card at a time, without the library's parallel pass.
+static fsrs_CollectionStats naive_stats(const fsrs_FSRS* const fsrs,
+                                        const fsrs_CardState* const cards,
+                                        const size_t len) {
+    fsrs_CollectionStats stats = {0};
+    double retrievability_sum = 0.0;
+    double stability_sum = 0.0;
+    double difficulty_sum = 0.0;
+    for (size_t i = 0; i < len; i++) {
+        const fsrs_CardState* const card = &cards[i];
+        stats.cards++;
+        const int64_t days_until_due = (int64_t)card->due_day - TODAY;
+        if (days_until_due < 0) {
+            stats.overdue_cards++;
+        } else if (days_until_due < fsrs_COLLECTION_STATS_FORECAST_DAYS) {
+            stats.due_forecast[days_until_due]++;
+        }
+        if (!(card->memory.stability > 0.0f)) {
+            continue;
+        }
+        const int64_t elapsed = (int64_t)TODAY - card->last_review_day;
+        const uint32_t days_elapsed = elapsed > 0 ? (uint32_t)elapsed : 0;
+        float retrievability = 0.0f;
+        fsrs_retrievability_batch(fsrs, &card->memory, &days_elapsed, &retrievability, 1);
+        const float bins = (float)fsrs_COLLECTION_STATS_BINS;
+        stats.reviewed_cards++;
+        stats.retrievability_histogram[clamp_bin(retrievability * bins)]++;
+        stats.stability_histogram[stability_bin(card->memory.stability)]++;
+        stats.difficulty_histogram[clamp_bin((card->memory.difficulty - 1.0f) * bins / 9.0f)]++;
+        retrievability_sum += retrievability;
+        stability_sum += card->memory.stability;
+        difficulty_sum += card->memory.difficulty;
+    }
+    if (stats.reviewed_cards > 0) {
+        stats.mean_retrievability = retrievability_sum / stats.reviewed_cards;
+        stats.mean_stability = stability_sum / stats.reviewed_cards;
+        stats.mean_difficulty = difficulty_sum / stats.reviewed_cards;
+    }
+    return stats;
+}
+
+static bool same_counts(const uint64_t* const a, const uint64_t* const b, const size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (a[i] != b[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Means are summed in a different order, so they may differ in the last bits
+static bool close(const double a, const double b) {
+    return fabs(a - b) <= 1e-9 * fmax(fabs(a), fabs(b));
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_CardState* const cards = malloc(NUM_CARDS * sizeof(fsrs_CardState));
+    if (!fsrs || !cards) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // A mix of new, overdue, soon due and long-interval cards
+    uint64_t random = 7;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        const bool reviewed = next_random(&random) % 10 != 0;
+        const int32_t last_review_day = TODAY - (int32_t)(next_random(&random) % 400);
+        cards[i] = (fsrs_CardState){
+            .memory = {
+                .stability = reviewed ? exp2f((float)(next_random(&random) % 2400) / 100.0f - 4.0f) : 0.0f,
+                .difficulty = reviewed ? 1.0f + (float)(next_random(&random) % 9001) / 1000.0f : 0.0f,
+            },
+            .last_review_day = last_review_day,
+            .due_day = TODAY - 20 + (int32_t)(next_random(&random) % 80),
+        };
+    }
+
+    fsrs_CollectionStats stats;
+    fsrs_collection_stats(fsrs, cards, NUM_CARDS, TODAY, &stats);
+    const fsrs_CollectionStats expected = naive_stats(fsrs, cards, NUM_CARDS);
+
+    const bool counts_match = stats.cards == expected.cards
+        && stats.reviewed_cards == expected.reviewed_cards
+        && stats.overdue_cards == expected.overdue_cards
+        && same_counts(stats.retrievability_histogram, expected.retrievability_histogram, fsrs_COLLECTION_STATS_BINS)
+        && same_counts(stats.stability_histogram, expected.stability_histogram, fsrs_COLLECTION_STATS_BINS)
+        && same_counts(stats.difficulty_histogram, expected.difficulty_histogram, fsrs_COLLECTION_STATS_BINS)
+        && same_counts(stats.due_forecast, expected.due_forecast, fsrs_COLLECTION_STATS_FORECAST_DAYS);
+    const bool means_match = close(stats.mean_retrievability, expected.mean_retrievability)
+        && close(stats.mean_stability, expected.mean_stability)
+        && close(stats.mean_difficulty, expected.mean_difficulty);
+
+    printf("%llu cards, %llu reviewed, %llu overdue\n", (unsigned long long)stats.cards,
+           (unsigned long long)stats.reviewed_cards, (unsigned long long)stats.overdue_cards);
+    printf("Mean retrievability %.4f, stability %.2f days, difficulty %.3f\n",
+           stats.mean_retrievability, stats.mean_stability, stats.mean_difficulty);
+    printf("Counts match a card-by-card loop: %s\n", counts_match ? "yes" : "no");
+    printf("Means match a card-by-card loop: %s\n", means_match ? "yes" : "no");
+
+    free(cards);
+    fsrs_free(fsrs);
+
+    if (!counts_match || !means_match) {
+        fprintf(stderr, "Error: Collection stats differ from a card-by-card loop\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
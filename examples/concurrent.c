@@ -0,0 +1,180 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "fsrs.h"
+
+// Default FSRS parameters (equivalent to DEFAULT_PARAMETERS in Python)
+static const float DEFAULT_PARAMETERS[] = {
+    0.40255f, 1.18385f, 3.173f, 15.69105f, 7.1949f, 0.5345f, 1.4604f, 0.0046f, 
+    1.54575f, 0.1192f, 1.01925f, 1.9395f, 0.11f, 0.29605f, 2.2698f, 0.2315f, 
+    2.9898f, 0.51655f, 0.6621f
+};
+static const size_t DEFAULT_PARAMETERS_LEN = sizeof(DEFAULT_PARAMETERS) / sizeof(DEFAULT_PARAMETERS[0]);
+
+#define NUM_INPUTS 64
+#define CALLS_PER_THREAD 2000
+#define MAX_THREADS 64
+
+// One scheduling query and the single-threaded answer it must reproduce
+typedef struct {
+    fsrs_MemoryState memory_state;
+    uint32_t days_elapsed;
+    fsrs_NextStates expected;
+} Query;
+
+// Shared, read-only state handed to every worker thread
+typedef struct {
+    const fsrs_FSRS* fsrs;
+    const Query* queries;
+    float desired_retention;
+} Workload;
+
+typedef struct {
+    const Workload* workload;
+    size_t offset;
+    size_t mismatches;
+    size_t failures;
+} Worker;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Each worker cycles through all queries on the shared handle and checks every
+// result bit for bit against the reference computed before any thread started.
+static void* run_worker(void* arg) {
+    Worker* const worker = arg;
+    const Workload* const workload = worker->workload;
+
+    for (size_t i = 0; i < CALLS_PER_THREAD; i++) {
+        const Query* const query = &workload->queries[(worker->offset + i) % NUM_INPUTS];
+        fsrs_MemoryState memory_state = query->memory_state;
+        fsrs_NextStates* const next_states = fsrs_next_states(
+            workload->fsrs, &memory_state, workload->desired_retention, query->days_elapsed);
+        if (!next_states) {
+            worker->failures++;
+            continue;
+        }
+        if (memcmp(next_states, &query->expected, sizeof(fsrs_NextStates)) != 0) {
+            worker->mismatches++;
+        }
+        fsrs_next_states_free(next_states);
+    }
+    return NULL;
+}
+
+// Runs CALLS_PER_THREAD calls on each of `num_threads` threads and returns the
+// elapsed wall time, or a negative value if any thread reported an error.
+static double run_round(const Workload* const workload, const size_t num_threads) {
+    pthread_t threads[MAX_THREADS];
+    Worker workers[MAX_THREADS];
+
+    const double start = now_seconds();
+    for (size_t t = 0; t < num_threads; t++) {
+        workers[t] = (Worker){
+            .workload = workload,
+            .offset = t * 7,
+            .mismatches = 0,
+            .failures = 0
+        };
+        if (pthread_create(&threads[t], NULL, run_worker, &workers[t]) != 0) {
+            fprintf(stderr, "Error: Failed to start thread %zu\n", t);
+            for (size_t j = 0; j < t; j++) {
+                pthread_join(threads[j], NULL);
+            }
+            return -1.0;
+        }
+    }
+
+    size_t mismatches = 0;
+    size_t failures = 0;
+    for (size_t t = 0; t < num_threads; t++) {
+        pthread_join(threads[t], NULL);
+        mismatches += workers[t].mismatches;
+        failures += workers[t].failures;
+    }
+    const double elapsed = now_seconds() - start;
+
+    if (mismatches > 0 || failures > 0) {
+        fprintf(stderr, "Error: %zu threads produced %zu mismatched and %zu failed results\n",
+                num_threads, mismatches, failures);
+        return -1.0;
+    }
+    return elapsed;
+}
+
+int32_t main(void) {
+    printf("FSRS Shared Handle Stress Test\n");
+    printf("==============================\n\n");
+
+    const fsrs_FSRS* const fsrs = fsrs_new(DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
+    if (!fsrs) {
+        fprintf(stderr, "Error: Failed to create FSRS instance\n");
+        return EXIT_FAILURE;
+    }
+
+    // Build the reference answers on this thread before any sharing happens
+    static Query queries[NUM_INPUTS];
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        queries[i].memory_state = (fsrs_MemoryState){
+            .stability = 0.5f + (float)i * 3.0f,
+            .difficulty = 1.0f + (float)(i % 10)
+        };
+        queries[i].days_elapsed = (uint32_t)(i * 5 % 97);
+
+        fsrs_NextStates* const next_states = fsrs_next_states(
+            fsrs, &queries[i].memory_state, 0.9f, queries[i].days_elapsed);
+        if (!next_states) {
+            fprintf(stderr, "Error: Failed to compute reference states\n");
+            fsrs_free(fsrs);
+            return EXIT_FAILURE;
+        }
+        queries[i].expected = *next_states;
+        fsrs_next_states_free(next_states);
+    }
+
+    const Workload workload = {
+        .fsrs = fsrs,
+        .queries = queries,
+        .desired_retention = 0.9f
+    };
+
+    const long online = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t max_threads = online > 0 ? (size_t)online : 1U;
+
+    // Every thread does the same amount of work, so with no hidden locking the
+    // wall time stays flat and throughput grows linearly with the thread count.
+    double single_thread_rate = 0.0;
+    bool ok = true;
+    for (size_t num_threads = 1; num_threads <= max_threads && num_threads <= MAX_THREADS; num_threads *= 2) {
+        const double elapsed = run_round(&workload, num_threads);
+        if (elapsed < 0.0) {
+            ok = false;
+            break;
+        }
+
+        const double rate = (double)(num_threads * CALLS_PER_THREAD) / elapsed;
+        if (num_threads == 1) {
+            single_thread_rate = rate;
+        }
+        printf("%2zu threads: %10.0f calls/s, speedup %5.2fx, efficiency %5.1f%%\n",
+               num_threads, rate, rate / single_thread_rate,
+               100.0 * rate / (single_thread_rate * (double)num_threads));
+    }
+
+    fsrs_free(fsrs);
+
+    if (!ok) {
+        return EXIT_FAILURE;
+    }
+    printf("\nAll concurrent results matched the single-threaded reference\n");
+    return EXIT_SUCCESS;
+}
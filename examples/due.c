@@ -0,0 +1,135 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fsrs.h"
+
+#define NUM_CARDS 20000
+// Enough for the latest window: the last review day plus a capped interval and its fuzz
+#define NUM_DAYS 45000
+#define UNASSIGNED -1
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+// Anki's fuzz window for an interval, as fsrs_assign_due_days computes it.
+static void fuzz_range(float interval, int32_t* const min, int32_t* const max) {
+    interval = fminf(interval, 36500.0f);
+    if (interval < 2.5f) {
+        *min = *max = (int32_t)fmaxf(roundf(interval), 1.0f);
+        return;
+    }
+    static const float ranges[3][3] = {{2.5f, 7.0f, 0.15f}, {7.0f, 20.0f, 0.1f}, {20.0f, INFINITY, 0.05f}};
+    float delta = 0.0f;
+    for (size_t r = 0; r < 3; r++) {
+        delta += ranges[r][2] * fmaxf(fminf(interval, ranges[r][1]) - ranges[r][0], 0.0f);
+    }
+    delta += 1.0f;
+    *max = (int32_t)roundf(interval + delta);
+    *min = (int32_t)roundf(interval - delta);
+    *min = *min < 2 ? 2 : *min > *max ? *max : *min;
+}
+
+int32_t main(void) {
+    float* const intervals = malloc(NUM_CARDS * sizeof(float));
+    int32_t* const last_review_days = malloc(NUM_CARDS * sizeof(int32_t));
+    int32_t* const due_days = malloc(NUM_CARDS * sizeof(int32_t));
+    int32_t* const repeated = malloc(NUM_CARDS * sizeof(int32_t));
+    uint32_t* const counts = calloc(NUM_DAYS, sizeof(uint32_t));
+    fsrs_DueHistogram* const histogram = fsrs_due_histogram_new(0);
+    fsrs_DueHistogram* const again = fsrs_due_histogram_new(0);
+    if (!intervals || !last_review_days || !due_days || !repeated || !counts || !histogram || !again) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // Cards reviewed over the last 1000 days, with intervals from a day to past the cap.
+    // A few intervals are broken and must not be assigned.
+    uint64_t random = 5;
+    size_t broken = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        last_review_days[i] = (int32_t)(next_random(&random) % 1000);
+        intervals[i] = i % 4 == 0 ? 1.0f + (float)(next_random(&random) % 30)
+            : i % 4 == 1 ? (float)(next_random(&random) % 400000) / 10.0f
+                         : (float)(next_random(&random) % 3000) / 7.0f;
+        if (i % 997 == 0) {
+            intervals[i] = i % 2 == 0 ? NAN : INFINITY;
+            broken++;
+        }
+        due_days[i] = repeated[i] = UNASSIGNED;
+    }
+
+    // The rest of the collection is already due on the first few hundred days
+    int32_t existing[3000];
+    for (size_t i = 0; i < 3000; i++) {
+        existing[i] = (int32_t)(next_random(&random) % 400);
+        counts[existing[i]]++;
+    }
+    fsrs_due_histogram_add(histogram, existing, 3000);
+    fsrs_due_histogram_add(again, existing, 3000);
+    size_t miscounted = 0;
+    for (int32_t day = 0; day < 400; day++) {
+        miscounted += fsrs_due_histogram_count(histogram, day) != counts[day];
+    }
+
+    const size_t assigned = fsrs_assign_due_days(histogram, intervals, last_review_days, due_days, NUM_CARDS, 99);
+    const size_t assigned_again = fsrs_assign_due_days(again, intervals, last_review_days, repeated, NUM_CARDS, 99);
+
+    // Each card lands inside its fuzz window, on a day no busier than any other in it at
+    // the time it was placed
+    size_t outside = 0;
+    size_t busier = 0;
+    int32_t widest = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        if (!isfinite(intervals[i])) {
+            outside += due_days[i] != UNASSIGNED;
+            continue;
+        }
+        int32_t min;
+        int32_t max;
+        fuzz_range(intervals[i], &min, &max);
+        const int32_t first = last_review_days[i] + min;
+        const int32_t last = last_review_days[i] + max;
+        widest = max - min + 1 > widest ? max - min + 1 : widest;
+        if (due_days[i] < first || due_days[i] > last) {
+            outside++;
+            continue;
+        }
+        for (int32_t day = first; day <= last; day++) {
+            if (counts[day] < counts[due_days[i]]) {
+                busier++;
+                break;
+            }
+        }
+        counts[due_days[i]]++;
+    }
+    for (int32_t day = 0; day < NUM_DAYS; day++) {
+        miscounted += fsrs_due_histogram_count(histogram, day) != counts[day];
+    }
+    // Days before the first tracked one are never counted
+    miscounted += fsrs_due_histogram_count(histogram, -1) != 0;
+    const bool same = memcmp(due_days, repeated, NUM_CARDS * sizeof(int32_t)) == 0;
+    printf("Assigned %zu of %d cards, widest window %d days\n", assigned, NUM_CARDS, widest);
+    printf("%zu outside their window, %zu on a busier day than needed, %zu days miscounted\n",
+           outside, busier, miscounted);
+    printf("Same days for the same seed: %s\n", same ? "yes" : "no");
+
+    fsrs_due_histogram_free(histogram);
+    fsrs_due_histogram_free(again);
+    free(intervals);
+    free(last_review_days);
+    free(due_days);
+    free(repeated);
+    free(counts);
+
+    if (assigned != NUM_CARDS - broken || assigned_again != assigned || outside != 0 || busier != 0
+        || miscounted != 0 || !same) {
+        fprintf(stderr, "Error: Due days are not balanced within their fuzz windows\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
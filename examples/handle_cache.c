@@ -0,0 +1,74 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "fsrs.h"
+
+// FSRS-6 parameters; each parameter set below nudges the first one
+static const float PARAMETERS[] = {
+    0.212f, 1.2931f, 2.3065f, 8.2956f, 6.4133f, 0.8334f, 3.0194f, 0.001f,
+    1.8722f, 0.1666f, 0.796f, 1.4835f, 0.0614f, 0.2629f, 1.6483f, 0.6014f,
+    1.8729f, 0.5425f, 0.0912f, 0.0658f, 0.1542f
+};
+#define PARAMETERS_LEN (sizeof(PARAMETERS) / sizeof(PARAMETERS[0]))
+
+#define CAPACITY 8
+#define NUM_MISSES 2000
+
+// Acquires the handle for the `index`-th parameter set.
+static const fsrs_FSRS* acquire(const fsrs_HandleCache* const cache, const size_t index) {
+    float parameters[PARAMETERS_LEN];
+    for (size_t i = 0; i < PARAMETERS_LEN; i++) {
+        parameters[i] = PARAMETERS[i];
+    }
+    parameters[0] += 0.0001f * (float)index;
+    return fsrs_handle_cache_acquire(cache, parameters, PARAMETERS_LEN);
+}
+
+int32_t main(void) {
+    fsrs_HandleCache* const cache = fsrs_handle_cache_new(CAPACITY);
+    if (!cache) {
+        fprintf(stderr, "Error: Failed to create handle cache\n");
+        return EXIT_FAILURE;
+    }
+
+    // One handle stays held throughout, and one is acquired again after every miss
+    const fsrs_FSRS* const held = acquire(cache, 0);
+    const fsrs_FSRS* const hot = acquire(cache, 1);
+    fsrs_handle_cache_release(hot);
+    size_t failures = !held || !hot;
+    size_t hot_misses = 0;
+    for (size_t i = 2; i < NUM_MISSES; i++) {
+        const fsrs_FSRS* const cold = acquire(cache, i);
+        failures += !cold;
+        fsrs_handle_cache_release(cold);
+        const fsrs_FSRS* const again = acquire(cache, 1);
+        hot_misses += again != hot;
+        fsrs_handle_cache_release(again);
+    }
+
+    // A handle in use must never be evicted, however many misses pass
+    const fsrs_FSRS* const held_again = acquire(cache, 0);
+    const bool held_kept = held_again == held;
+    fsrs_handle_cache_release(held_again);
+    fsrs_handle_cache_release(held);
+
+    // NULL and empty parameters share the defaults' handle
+    const fsrs_FSRS* const from_null = fsrs_handle_cache_acquire(cache, NULL, 0);
+    const fsrs_FSRS* const from_empty = fsrs_handle_cache_acquire(cache, PARAMETERS, 0);
+    const bool defaults_shared = from_null && from_null == from_empty;
+    fsrs_handle_cache_release(from_null);
+    fsrs_handle_cache_release(from_empty);
+    fsrs_handle_cache_free(cache);
+
+    printf("%d cold parameter sets through a cache of %d\n", NUM_MISSES - 2, CAPACITY);
+    printf("Held handle kept: %s\n", held_kept ? "yes" : "no");
+    printf("Frequently used handle rebuilt %zu times\n", hot_misses);
+    printf("NULL and empty parameters share a handle: %s\n", defaults_shared ? "yes" : "no");
+
+    if (failures != 0 || !held_kept || hot_misses != 0 || !defaults_shared) {
+        fprintf(stderr, "Error: The cache evicted a handle it should have kept\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,179 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+static const char* const JOURNAL_PATH = "journal_example.jrnl";
+static const char* const SNAPSHOT_PATH = "journal_example.snap";
+
+// Size of one journal record, as written by fsrs_journal_append
+#define RECORD_LEN 32
+
+// Keeps the first `len` bytes of a file, or replaces it with `bytes` if not NULL,
+// as a crash in the middle of a write would.
+static bool rewrite_file(const char* const path, const char* const bytes, long len) {
+    char buffer[4096];
+    if (!bytes) {
+        FILE* const in = fopen(path, "rb");
+        if (!in) {
+            return false;
+        }
+        const size_t read = fread(buffer, 1, sizeof(buffer), in);
+        fclose(in);
+        if (len < 0 || (size_t)len > read) {
+            return false;
+        }
+    }
+    FILE* const out = fopen(path, "wb");
+    if (!out) {
+        return false;
+    }
+    const bool written = fwrite(bytes ? bytes : buffer, 1, (size_t)len, out) == (size_t)len;
+    return fclose(out) == 0 && written;
+}
+
+static size_t count_reviews(fsrs_Journal* const journal) {
+    const fsrs_JournalContents contents = fsrs_journal_contents(journal);
+    return contents.logs.offsets[contents.logs.num_cards];
+}
+
+static uint64_t fnv1a64(const unsigned char* const bytes, const size_t len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 0x00000100000001b3ULL;
+    }
+    return hash;
+}
+
+// Appends `value` in little-endian byte order.
+static size_t put(unsigned char* const out, size_t at, const uint64_t value, const size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        out[at++] = (unsigned char)(value >> (8 * i));
+    }
+    return at;
+}
+
+static bool check(const bool ok, const char* const what) {
+    printf("%s: %s\n", what, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int32_t main(void) {
+    remove(JOURNAL_PATH);
+    remove(SNAPSHOT_PATH);
+    bool ok = true;
+
+    const fsrs_JournalReview reviews[] = {
+        {.card_id = 1, .timestamp = 1700000000, .rating = 3},
+        {.card_id = 2, .timestamp = 1700000100, .rating = 1},
+        {.card_id = 1, .timestamp = 1700086400, .rating = 4},
+    };
+    const size_t reviews_len = sizeof(reviews) / sizeof(reviews[0]);
+
+    fsrs_Journal* journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    if (!journal) {
+        fprintf(stderr, "Error: Failed to open journal\n");
+        return EXIT_FAILURE;
+    }
+    ok &= check(fsrs_journal_append(journal, reviews, reviews_len), "Append reviews");
+    fsrs_journal_free(journal);
+
+    // A crash while appending the last record leaves part of it behind.
+    const long torn_len = 12 + 2 * RECORD_LEN + RECORD_LEN / 2;
+    if (!rewrite_file(JOURNAL_PATH, NULL, torn_len)) {
+        fprintf(stderr, "Error: Failed to truncate journal\n");
+        return EXIT_FAILURE;
+    }
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    ok &= check(journal != NULL, "Open journal with a torn tail");
+    if (journal) {
+        ok &= check(fsrs_journal_pending(journal) == 2 && count_reviews(journal) == 2,
+                    "Torn record discarded");
+        ok &= check(fsrs_journal_append(journal, &reviews[2], 1), "Append after recovery");
+        fsrs_journal_free(journal);
+    }
+
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    ok &= check(journal != NULL, "Reopen recovered journal");
+    if (journal) {
+        ok &= check(fsrs_journal_pending(journal) == 3 && count_reviews(journal) == 3,
+                    "Recovered journal keeps every acknowledged review");
+        ok &= check(fsrs_journal_compact(journal), "Compact journal");
+        fsrs_journal_free(journal);
+    }
+
+    // A crash while creating the journal file leaves part of its header behind.
+    if (!rewrite_file(JOURNAL_PATH, "FSRSJ", 5)) {
+        fprintf(stderr, "Error: Failed to write torn header\n");
+        return EXIT_FAILURE;
+    }
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    ok &= check(journal != NULL, "Open journal with a torn header");
+    if (journal) {
+        ok &= check(fsrs_journal_pending(journal) == 0 && count_reviews(journal) == 3,
+                    "Snapshot loaded behind torn header");
+        ok &= check(fsrs_journal_append(journal, reviews, 1), "Append after torn header");
+        fsrs_journal_free(journal);
+    }
+
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    ok &= check(journal != NULL && fsrs_journal_pending(journal) == 1
+                && count_reviews(journal) == 4,
+                "Reopen journal after torn header");
+    fsrs_journal_free(journal);
+
+    // Ratings are stored as u32 in the snapshot too, so compaction keeps values that do
+    // not fit in a byte.
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    const fsrs_JournalReview wide = {.card_id = 3, .timestamp = 1700172800, .rating = 300};
+    ok &= check(journal != NULL && fsrs_journal_append(journal, &wide, 1) && fsrs_journal_compact(journal),
+                "Compact a rating above 255");
+    fsrs_journal_free(journal);
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    bool kept = false;
+    if (journal) {
+        const fsrs_JournalContents contents = fsrs_journal_contents(journal);
+        for (size_t i = 0; i < contents.logs.num_cards; i++) {
+            kept |= contents.card_ids[i] == 3 && contents.logs.offsets[i + 1] == contents.logs.offsets[i] + 1
+                && contents.logs.ratings[contents.logs.offsets[i]] == 300;
+        }
+        kept &= fsrs_journal_pending(journal) == 0 && count_reviews(journal) == 5;
+    }
+    ok &= check(kept, "Rating above 255 survives the snapshot");
+    fsrs_journal_free(journal);
+
+    // Snapshots written before ratings were widened, with one byte per rating, still load
+    unsigned char old_snapshot[128];
+    size_t len = 0;
+    memcpy(old_snapshot, "FSRSSNAP", 8);
+    len = put(old_snapshot, 8, 1, 4);
+    len = put(old_snapshot, len, 2, 8);
+    len = put(old_snapshot, len, 1, 8);
+    len = put(old_snapshot, len, 2, 8);
+    len = put(old_snapshot, len, 42, 8);
+    len = put(old_snapshot, len, 0, 8);
+    len = put(old_snapshot, len, 2, 8);
+    len = put(old_snapshot, len, 1700000000, 8);
+    len = put(old_snapshot, len, 1700086400, 8);
+    len = put(old_snapshot, len, 3, 1);
+    len = put(old_snapshot, len, 4, 1);
+    len = put(old_snapshot, len, fnv1a64(old_snapshot, len), 8);
+    remove(JOURNAL_PATH);
+    ok &= check(rewrite_file(SNAPSHOT_PATH, (const char*)old_snapshot, (long)len), "Write a version 1 snapshot");
+    journal = fsrs_journal_open(JOURNAL_PATH, SNAPSHOT_PATH);
+    bool loaded = false;
+    if (journal) {
+        const fsrs_JournalContents contents = fsrs_journal_contents(journal);
+        loaded = contents.logs.num_cards == 1 && contents.card_ids[0] == 42 && contents.logs.offsets[1] == 2
+            && contents.logs.ratings[0] == 3 && contents.logs.ratings[1] == 4
+            && contents.logs.timestamps[1] == 1700086400;
+    }
+    ok &= check(loaded, "Version 1 snapshot loaded");
+    fsrs_journal_free(journal);
+
+    remove(JOURNAL_PATH);
+    remove(SNAPSHOT_PATH);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "fsrs.h"
+
+// Reviews per card; each card gives one training item per review after its first
+#define REVIEWS_PER_CARD 8
+
+// Small enough to train quickly in a debug build, while showing how the peak grows
+static const size_t CARD_COUNTS[] = {1000, 2000, 4000};
+static const size_t CARD_COUNTS_LEN = sizeof(CARD_COUNTS) / sizeof(CARD_COUNTS[0]);
+
+// Trains on `num_cards` synthetic cards and compares the peak heap use with the estimate.
+// Returns the measured peak divided by the estimate, or a negative value on failure.
+static double measure(const fsrs_FSRS* const fsrs, const size_t num_cards) {
+    const size_t num_reviews = num_cards * REVIEWS_PER_CARD;
+    fsrs_FSRSReview* const reviews = malloc(num_reviews * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((num_cards + 1) * sizeof(size_t));
+    if (!reviews || !offsets) {
+        free(reviews);
+        free(offsets);
+        return -1.0;
+    }
+    uint64_t random = num_cards;
+    for (size_t i = 0; i < num_cards; i++) {
+        offsets[i] = i * REVIEWS_PER_CARD;
+        uint32_t interval = 1;
+        for (size_t k = 0; k < REVIEWS_PER_CARD; k++) {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint32_t rating = 1 + (uint32_t)(random >> 62);
+            reviews[i * REVIEWS_PER_CARD + k] = (fsrs_FSRSReview){
+                .rating = rating,
+                .delta_t = k == 0 ? 0 : interval,
+            };
+            interval = rating == 1 ? 1 : interval * 2;
+        }
+    }
+    offsets[num_cards] = num_reviews;
+    const fsrs_FsrsReviewHistories histories = {reviews, offsets, num_cards};
+    fsrs_FsrsItems* const train_set = fsrs_train_set_from_histories(&histories);
+    free(reviews);
+    free(offsets);
+    if (!train_set) {
+        return -1.0;
+    }
+
+    size_t item_reviews = 0;
+    for (size_t i = 0; i < train_set->len; i++) {
+        item_reviews += train_set->items[i].len;
+    }
+    const size_t estimate = fsrs_compute_parameters_memory_estimate(train_set->len, item_reviews);
+
+    // Only what training allocates counts, not the train set passed in
+    fsrs_MemoryUsage before;
+    fsrs_memory_usage(&before);
+    fsrs_memory_reset_peak();
+    size_t parameters_len = 0;
+    float* const parameters = fsrs_compute_parameters(fsrs, train_set, &parameters_len);
+    fsrs_MemoryUsage after;
+    fsrs_memory_usage(&after);
+    const size_t peak = after.peak_bytes - before.current_bytes;
+
+    printf("%6zu items, %7zu reviews: estimate %8.1f MiB, measured %8.1f MiB, peak RSS %8.1f MiB\n",
+           train_set->len, item_reviews, estimate / 1048576.0, peak / 1048576.0,
+           after.peak_rss_bytes / 1048576.0);
+    fsrs_parameters_free(parameters, parameters_len);
+    fsrs_items_free(train_set);
+    return parameters ? (double)peak / (double)estimate : -1.0;
+}
+
+int32_t main(void) {
+    if (!fsrs_memory_tracking_enable(true)) {
+        printf("Skipped: the library was built without the memory-tracking feature\n");
+        return EXIT_SUCCESS;
+    }
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    if (!fsrs) {
+        fprintf(stderr, "Error: Failed to create FSRS instance\n");
+        return EXIT_FAILURE;
+    }
+
+    double max_ratio = 0.0;
+    for (size_t i = 0; i < CARD_COUNTS_LEN; i++) {
+        const double ratio = measure(fsrs, CARD_COUNTS[i]);
+        if (ratio < 0.0) {
+            fprintf(stderr, "Error: Training on %zu cards failed\n", CARD_COUNTS[i]);
+            fsrs_free(fsrs);
+            return EXIT_FAILURE;
+        }
+        max_ratio = ratio > max_ratio ? ratio : max_ratio;
+    }
+    fsrs_free(fsrs);
+
+    printf("Largest measured peak: %.1f%% of the estimate\n", max_ratio * 100.0);
+    // The estimate is used to admit jobs, so it must never fall short of the real peak
+    if (max_ratio > 1.0) {
+        fprintf(stderr, "Error: The memory estimate is below the measured peak\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
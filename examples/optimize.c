@@ -393,13 +393,14 @@ int32_t main(void) {
 
     // Optimize the FSRS model using the created items
     printf("\nOptimizing parameters...\n");
-    float* const optimized_parameters = fsrs_compute_parameters(fsrs, &train_set);
+    size_t optimized_parameters_len = 0;
+    float* const optimized_parameters = fsrs_compute_parameters(fsrs, &train_set, &optimized_parameters_len);
     
     if (optimized_parameters) {
-        print_parameters(optimized_parameters, DEFAULT_PARAMETERS_LEN, "OPTIMIZED_PARAMETERS");
+        print_parameters(optimized_parameters, optimized_parameters_len, "OPTIMIZED_PARAMETERS");
         
         // Clean up optimized parameters
-        fsrs_parameters_free(optimized_parameters);
+        fsrs_parameters_free(optimized_parameters, optimized_parameters_len);
     } else {
         fprintf(stderr, "Error: Parameter optimization failed!\n");
     }
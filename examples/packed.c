@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <tgmath.h>
+#include "fsrs.h"
+
+// Error bounds documented for fsrs_PackedCardState
+static const double MAX_STABILITY_RELATIVE_ERROR = 0.0002;
+static const double MAX_DIFFICULTY_ERROR = 0.018;
+
+#define NUM_STATES 100000
+
+int32_t main(void) {
+    fsrs_CardState* const states = malloc(NUM_STATES * sizeof(fsrs_CardState));
+    fsrs_CardState* const unpacked = malloc(NUM_STATES * sizeof(fsrs_CardState));
+    fsrs_PackedCardState* const packed = malloc(NUM_STATES * sizeof(fsrs_PackedCardState));
+    if (!states || !unpacked || !packed) {
+        fprintf(stderr, "Error: Failed to allocate card states\n");
+        free(states);
+        free(unpacked);
+        free(packed);
+        return EXIT_FAILURE;
+    }
+
+    // Sweep the whole packable range: stability 2^-10 to 2^22 days, difficulty 1 to 10,
+    // last review days up to 16777215 and intervals up to 65535 days.
+    for (size_t i = 0; i < NUM_STATES; i++) {
+        const double t = (double)i / (NUM_STATES - 1);
+        const int32_t last_review_day = (int32_t)((i * 7919U) % 16777216U);
+        states[i] = (fsrs_CardState){
+            .memory = {
+                .stability = (float)exp2(-10.0 + 32.0 * t),
+                .difficulty = (float)(1.0 + 9.0 * fmod(t * 997.0, 1.0)),
+            },
+            .last_review_day = last_review_day,
+            .due_day = last_review_day + (int32_t)((i * 104729U) % 65536U),
+        };
+    }
+
+    const size_t clamped = fsrs_card_states_pack(states, packed, NUM_STATES);
+    fsrs_card_states_unpack(packed, unpacked, NUM_STATES);
+
+    double max_stability_error = 0.0;
+    double max_difficulty_error = 0.0;
+    size_t wrong_days = 0;
+    for (size_t i = 0; i < NUM_STATES; i++) {
+        const double stability_error =
+            fabs((double)unpacked[i].memory.stability / states[i].memory.stability - 1.0);
+        const double difficulty_error =
+            fabs((double)unpacked[i].memory.difficulty - states[i].memory.difficulty);
+        max_stability_error = fmax(max_stability_error, stability_error);
+        max_difficulty_error = fmax(max_difficulty_error, difficulty_error);
+        if (unpacked[i].last_review_day != states[i].last_review_day
+            || unpacked[i].due_day != states[i].due_day) {
+            wrong_days++;
+        }
+    }
+
+    printf("Packed %d states into %zu bytes each, %zu clamped\n",
+           NUM_STATES, sizeof(fsrs_PackedCardState), clamped);
+    printf("Max stability relative error: %.6f (bound %.6f)\n",
+           max_stability_error, MAX_STABILITY_RELATIVE_ERROR);
+    printf("Max difficulty error: %.6f (bound %.6f)\n",
+           max_difficulty_error, MAX_DIFFICULTY_ERROR);
+    printf("States with wrong days: %zu\n", wrong_days);
+
+    // Out-of-range values are clamped and reported.
+    const fsrs_CardState out_of_range[] = {
+        {.memory = {.stability = 1e9f, .difficulty = 5.0f}, .last_review_day = 0, .due_day = 1},
+        {.memory = {.stability = 1.0f, .difficulty = 11.0f}, .last_review_day = 0, .due_day = 1},
+        {.memory = {.stability = 1.0f, .difficulty = 5.0f}, .last_review_day = -1, .due_day = 1},
+        {.memory = {.stability = 1.0f, .difficulty = 5.0f}, .last_review_day = 0, .due_day = 70000},
+    };
+    const size_t out_of_range_len = sizeof(out_of_range) / sizeof(out_of_range[0]);
+    fsrs_PackedCardState out_of_range_packed[sizeof(out_of_range) / sizeof(out_of_range[0])];
+    const size_t out_of_range_clamped =
+        fsrs_card_states_pack(out_of_range, out_of_range_packed, out_of_range_len);
+    printf("Out-of-range states clamped: %zu of %zu\n", out_of_range_clamped, out_of_range_len);
+
+    free(states);
+    free(unpacked);
+    free(packed);
+
+    if (clamped != 0 || max_stability_error >= MAX_STABILITY_RELATIVE_ERROR
+        || max_difficulty_error >= MAX_DIFFICULTY_ERROR || wrong_days != 0
+        || out_of_range_clamped != out_of_range_len) {
+        fprintf(stderr, "Error: Packed states exceed their documented error bounds\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "fsrs.h"
+
+#define NUM_CARDS 200
+#define REVIEWS_PER_CARD 6
+// Training returns FSRS-6 parameters, the last two of which set the forgetting curve
+#define FSRS6_PARAMETERS_LEN 21
+
+// Trains on the synthetic histories and checks the parameters against the reported count.
+// Returns the number of failed checks.
+static size_t check_training(const fsrs_FSRS* const fsrs, fsrs_FsrsItems* const train_set,
+                             const fsrs_TrainingConfig* const config) {
+    size_t parameters_len = SIZE_MAX;
+    float* const parameters = config
+        ? fsrs_compute_parameters_with_config(fsrs, train_set, config, &parameters_len)
+        : fsrs_compute_parameters(fsrs, train_set, &parameters_len);
+    if (!parameters) {
+        printf("Training failed, %zu parameters reported\n", parameters_len);
+        return 1;
+    }
+
+    // Every parameter up to the reported count must reach the new handle
+    const fsrs_FSRS* const trained = fsrs_new(parameters, parameters_len);
+    fsrs_MemoryState memory = {.stability = 10.0f, .difficulty = 5.0f};
+    fsrs_NextStates* const next_states = trained ? fsrs_next_states(trained, &memory, 0.9f, 10) : NULL;
+    printf("Trained %zu parameters%s, next states %s\n", parameters_len,
+           config ? " with a config" : "", next_states ? "computed" : "failed");
+    const size_t failures = (parameters_len != FSRS6_PARAMETERS_LEN) + !next_states;
+    fsrs_next_states_free(next_states);
+    fsrs_free(trained);
+    fsrs_parameters_free(parameters, parameters_len);
+    return failures;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_FSRSReview* const reviews = malloc(NUM_CARDS * REVIEWS_PER_CARD * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    if (!fsrs || !reviews || !offsets) {
+        fprintf(stderr, "Error: Failed to set up training\n");
+        return EXIT_FAILURE;
+    }
+    uint64_t random = 3;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        offsets[i] = i * REVIEWS_PER_CARD;
+        uint32_t interval = 1;
+        for (size_t k = 0; k < REVIEWS_PER_CARD; k++) {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint32_t rating = 1 + (uint32_t)(random >> 62);
+            reviews[i * REVIEWS_PER_CARD + k] = (fsrs_FSRSReview){
+                .rating = rating,
+                .delta_t = k == 0 ? 0 : interval,
+            };
+            interval = rating == 1 ? 1 : interval * 2;
+        }
+    }
+    offsets[NUM_CARDS] = NUM_CARDS * REVIEWS_PER_CARD;
+    const fsrs_FsrsReviewHistories histories = {reviews, offsets, NUM_CARDS};
+    fsrs_FsrsItems* const train_set = fsrs_train_set_from_histories(&histories);
+    free(reviews);
+    free(offsets);
+    if (!train_set) {
+        fprintf(stderr, "Error: Failed to build the train set\n");
+        fsrs_free(fsrs);
+        return EXIT_FAILURE;
+    }
+
+    const fsrs_TrainingConfig config = fsrs_training_config_default();
+    size_t failures = check_training(fsrs, train_set, NULL) + check_training(fsrs, train_set, &config);
+    fsrs_items_free(train_set);
+
+    // A failed run must report no parameters, so the count can't be used with a stale pointer
+    fsrs_FSRSItem no_items[1] = {{0}};
+    fsrs_FsrsItems empty = {no_items, 0};
+    size_t empty_len = SIZE_MAX;
+    float* const none = fsrs_compute_parameters(fsrs, &empty, &empty_len);
+    printf("Empty train set: %s, %zu parameters reported\n", none ? "trained" : "rejected", empty_len);
+    failures += none != NULL || empty_len != 0;
+    fsrs_parameters_free(none, empty_len);
+    fsrs_free(fsrs);
+
+    if (failures != 0) {
+        fprintf(stderr, "Error: The parameter count did not match the parameters\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,190 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+// Enough cards for several of fsrs_reschedule's chunks
+#define NUM_CARDS 40000
+#define MAX_REVIEWS 12
+// Cards per chunk handed over by the streaming source
+#define SOURCE_CHUNK 1500
+
+// Collects rescheduled cards in the order they are reported. The source below starts
+// with one, so both can share the callbacks' user data.
+typedef struct {
+    fsrs_RescheduledCard* cards;
+    size_t len;
+    size_t calls;
+} Collected;
+
+// Feeds the cards to fsrs_reschedule_stream through one reused buffer, as a reader of a
+// database too large to hold in memory would.
+typedef struct {
+    Collected collected;
+    const fsrs_FSRSReview* reviews;
+    const size_t* offsets;
+    const int64_t* card_ids;
+    const int32_t* last_review_days;
+    size_t next_card;
+    // Skip the last review days of this chunk, to check that only its cards are skipped
+    size_t broken_chunk;
+    size_t chunks;
+    fsrs_FSRSReview buffer_reviews[SOURCE_CHUNK * MAX_REVIEWS];
+    size_t buffer_offsets[SOURCE_CHUNK + 1];
+    int64_t buffer_card_ids[SOURCE_CHUNK];
+    int32_t buffer_last_review_days[SOURCE_CHUNK];
+} Source;
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+static void collect(void* const user_data, const fsrs_RescheduledCard* const cards, const size_t len) {
+    Collected* const collected = user_data;
+    memcpy(&collected->cards[collected->len], cards, len * sizeof(fsrs_RescheduledCard));
+    collected->len += len;
+    collected->calls++;
+}
+
+static bool next_chunk(void* const user_data, fsrs_RescheduleChunk* const chunk) {
+    Source* const source = user_data;
+    if (source->next_card == NUM_CARDS) {
+        return false;
+    }
+    const size_t first = source->next_card;
+    const size_t len = NUM_CARDS - first < SOURCE_CHUNK ? NUM_CARDS - first : SOURCE_CHUNK;
+    // Overwrite the previous chunk, which the library is done with by now
+    const size_t start = source->offsets[first];
+    for (size_t i = 0; i <= len; i++) {
+        source->buffer_offsets[i] = source->offsets[first + i] - start;
+    }
+    memcpy(source->buffer_reviews, &source->reviews[start],
+           source->buffer_offsets[len] * sizeof(fsrs_FSRSReview));
+    memcpy(source->buffer_card_ids, &source->card_ids[first], len * sizeof(int64_t));
+    memcpy(source->buffer_last_review_days, &source->last_review_days[first], len * sizeof(int32_t));
+    *chunk = (fsrs_RescheduleChunk){
+        .histories = {source->buffer_reviews, source->buffer_offsets, len},
+        .card_ids = source->buffer_card_ids,
+        .last_review_days = source->chunks == source->broken_chunk ? NULL : source->buffer_last_review_days,
+    };
+    source->next_card += len;
+    source->chunks++;
+    return true;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_FSRSReview* const reviews = malloc(NUM_CARDS * MAX_REVIEWS * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    int64_t* const card_ids = malloc(NUM_CARDS * sizeof(int64_t));
+    int32_t* const last_review_days = malloc(NUM_CARDS * sizeof(int32_t));
+    fsrs_MemoryCheckpoint* const replayed = calloc(NUM_CARDS, sizeof(fsrs_MemoryCheckpoint));
+    Collected all = {malloc(NUM_CARDS * sizeof(fsrs_RescheduledCard)), 0, 0};
+    Source* const source = calloc(1, sizeof(Source));
+    if (!fsrs || !reviews || !offsets || !card_ids || !last_review_days || !replayed || !all.cards || !source
+        || !(source->collected.cards = malloc(NUM_CARDS * sizeof(fsrs_RescheduledCard)))) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // Some cards have never been reviewed and must be skipped
+    uint64_t random = 11;
+    size_t total = 0;
+    size_t unreviewed = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        offsets[i] = total;
+        card_ids[i] = 1000000 + (int64_t)i;
+        replayed[i].last_review_day = 100 + (int32_t)(i % 50);
+        const size_t len = next_random(&random) % (MAX_REVIEWS + 1);
+        unreviewed += len == 0;
+        uint32_t interval = 1;
+        for (size_t k = 0; k < len; k++) {
+            const uint32_t rating = 1 + next_random(&random) % 4;
+            reviews[total++] = (fsrs_FSRSReview){.rating = rating, .delta_t = k == 0 ? 0 : interval};
+            interval = rating == 1 ? 1 : interval * (1 + rating / 2) % 3650 + 1;
+        }
+    }
+    offsets[NUM_CARDS] = total;
+    const fsrs_FsrsReviewHistories histories = {reviews, offsets, NUM_CARDS};
+
+    // Each card's memory state from a replay of its whole history, and its last review day
+    const size_t failed = fsrs_checkpoints_advance(fsrs, &histories, replayed);
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        last_review_days[i] = replayed[i].last_review_day;
+    }
+
+    const size_t skipped = fsrs_reschedule(fsrs, &histories, card_ids, last_review_days, 0.9f, collect, &all);
+    size_t wrong = 0;
+    for (size_t i = 0, card = 0; i < NUM_CARDS; i++) {
+        if (offsets[i] == offsets[i + 1]) {
+            continue;
+        }
+        if (card == all.len) {
+            wrong++;
+            break;
+        }
+        const fsrs_RescheduledCard* const rescheduled = &all.cards[card++];
+        if (rescheduled->card_id != card_ids[i]
+            || memcmp(&rescheduled->memory, &replayed[i].memory, sizeof(fsrs_MemoryState)) != 0
+            || rescheduled->due_day <= last_review_days[i]) {
+            wrong++;
+        }
+    }
+    printf("Rescheduled %zu cards in %zu callbacks, %zu skipped, %zu wrong\n", all.len, all.calls, skipped, wrong);
+    bool ok = failed == 0 && skipped == unreviewed && all.len + skipped == NUM_CARDS && wrong == 0;
+
+    // Streaming the same cards chunk by chunk must give the same records, except for the
+    // cards of the chunk whose last review days are missing
+    source->reviews = reviews;
+    source->offsets = offsets;
+    source->card_ids = card_ids;
+    source->last_review_days = last_review_days;
+    source->broken_chunk = 3;
+    const size_t stream_skipped = fsrs_reschedule_stream(fsrs, next_chunk, 0.9f, collect, source);
+    const size_t broken_first = source->broken_chunk * SOURCE_CHUNK;
+    size_t broken_reviewed = 0;
+    for (size_t i = broken_first; i < broken_first + SOURCE_CHUNK; i++) {
+        broken_reviewed += offsets[i] != offsets[i + 1];
+    }
+    size_t stream_wrong = source->collected.len + broken_reviewed == all.len ? 0 : 1;
+    for (size_t card = 0, streamed = 0; card < all.len && stream_wrong == 0; card++) {
+        const int64_t id = all.cards[card].card_id - 1000000;
+        if (id >= (int64_t)broken_first && id < (int64_t)(broken_first + SOURCE_CHUNK)) {
+            continue;
+        }
+        const fsrs_RescheduledCard* const expected = &all.cards[card];
+        const fsrs_RescheduledCard* const actual = &source->collected.cards[streamed++];
+        stream_wrong += actual->card_id != expected->card_id || actual->due_day != expected->due_day
+            || memcmp(&actual->memory, &expected->memory, sizeof(fsrs_MemoryState)) != 0;
+    }
+    printf("Streamed %zu chunks: %zu cards, %zu skipped, %s\n", source->chunks, source->collected.len,
+           stream_skipped, stream_wrong == 0 ? "same records" : "different records");
+    ok &= stream_wrong == 0 && stream_skipped == skipped + broken_reviewed;
+
+    // Missing card ids or days reschedule nothing and report every card
+    Collected none = {all.cards, 0, 0};
+    const size_t null_ids = fsrs_reschedule(fsrs, &histories, NULL, last_review_days, 0.9f, collect, &none);
+    const size_t null_days = fsrs_reschedule(fsrs, &histories, card_ids, NULL, 0.9f, collect, &none);
+    const bool nulls_reported = null_ids == NUM_CARDS && null_days == NUM_CARDS && none.calls == 0;
+    printf("NULL arrays reported as skipped: %s\n", nulls_reported ? "yes" : "no");
+    ok &= nulls_reported;
+
+    free(reviews);
+    free(offsets);
+    free(card_ids);
+    free(last_review_days);
+    free(replayed);
+    free(all.cards);
+    free(source->collected.cards);
+    free(source);
+    fsrs_free(fsrs);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Rescheduled cards differ from a full replay\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "fsrs.h"
+
+#define CAPACITY 64
+#define NUM_REQUESTS 20000
+#define BATCH 16
+
+// Offsets of the capacity and request tail in the ring header, used to corrupt it.
+#define CAPACITY_OFFSET 8
+#define REQUEST_TAIL_OFFSET 64
+
+static fsrs_ScheduleRequest make_request(const uint64_t id) {
+    return (fsrs_ScheduleRequest){
+        .request_id = id,
+        .memory = {.stability = (float)(1 + id % 50), .difficulty = 5.0f},
+        .desired_retention = 0.9f,
+        .days_elapsed = (uint32_t)(id % 20),
+    };
+}
+
+// Serves the ring from a child process until every request has been answered.
+static void serve(void* const memory, const size_t size) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    size_t served = 0;
+    while (fsrs && served < NUM_REQUESTS) {
+        served += fsrs_schedule_ring_serve(fsrs, memory, size, 32);
+    }
+    _exit(fsrs ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+// Checks that a ring with a corrupted header is left alone.
+static bool rejects_corruption(const void* const ring, const size_t size,
+                               const size_t offset, const uint64_t value) {
+    void* const copy = aligned_alloc(64, size);
+    if (!copy) {
+        return false;
+    }
+    memcpy(copy, ring, size);
+    memcpy((char*)copy + offset, &value, sizeof(value));
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_ScheduleRequest request = make_request(0);
+    fsrs_ScheduleResponse response;
+    const bool rejected = fsrs_schedule_ring_submit(copy, size, &request, 1) == 0
+        && fsrs_schedule_ring_serve(fsrs, copy, size, 32) == 0
+        && fsrs_schedule_ring_poll(copy, size, &response, 1) == 0;
+    fsrs_free(fsrs);
+    free(copy);
+    return rejected;
+}
+
+int32_t main(void) {
+    const size_t size = fsrs_schedule_ring_size(CAPACITY);
+    if (size == 0 || fsrs_schedule_ring_size(3) != 0) {
+        fprintf(stderr, "Error: Unexpected ring sizes\n");
+        return EXIT_FAILURE;
+    }
+    void* const memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    // A mapping too short for the capacity is refused
+    if (memory == MAP_FAILED || fsrs_schedule_ring_init(memory, size - 1, CAPACITY)
+        || !fsrs_schedule_ring_init(memory, size, CAPACITY)) {
+        fprintf(stderr, "Error: Failed to set up ring\n");
+        return EXIT_FAILURE;
+    }
+
+    const pid_t server = fork();
+    if (server < 0) {
+        fprintf(stderr, "Error: Failed to start server\n");
+        return EXIT_FAILURE;
+    }
+    if (server == 0) {
+        serve(memory, size);
+    }
+
+    // Keep the ring busy from this process and check each response as it comes back.
+    fsrs_ScheduleRequest requests[BATCH];
+    fsrs_ScheduleResponse responses[BATCH];
+    uint64_t submitted = 0;
+    uint64_t received = 0;
+    size_t wrong = 0;
+    while (received < NUM_REQUESTS) {
+        size_t len = 0;
+        for (; len < BATCH && submitted + len < NUM_REQUESTS; len++) {
+            requests[len] = make_request(submitted + len);
+        }
+        submitted += fsrs_schedule_ring_submit(memory, size, requests, len);
+        const size_t polled = fsrs_schedule_ring_poll(memory, size, responses, BATCH);
+        for (size_t i = 0; i < polled; i++) {
+            const fsrs_ScheduleResponse* const response = &responses[i];
+            if (response->request_id != received + i || response->status != 0
+                || !(response->next_states.good.interval > 0.0f)) {
+                wrong++;
+            }
+        }
+        received += polled;
+    }
+    int status = 0;
+    waitpid(server, &status, 0);
+    printf("Answered %llu requests through a ring of %d slots, %zu wrong\n",
+           (unsigned long long)received, CAPACITY, wrong);
+
+    const bool rejected = rejects_corruption(memory, size, CAPACITY_OFFSET, 0)
+        && rejects_corruption(memory, size, CAPACITY_OFFSET, 3)
+        && rejects_corruption(memory, size, CAPACITY_OFFSET, UINT64_MAX)
+        // Larger powers of two pass every check but the length of the mapping
+        && rejects_corruption(memory, size, CAPACITY_OFFSET, CAPACITY * 2)
+        && rejects_corruption(memory, size, CAPACITY_OFFSET, (uint64_t)1 << 40)
+        && rejects_corruption(memory, size, REQUEST_TAIL_OFFSET, UINT64_MAX / 2);
+    printf("Corrupted headers rejected: %s\n", rejected ? "yes" : "no");
+    munmap(memory, size);
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS || wrong != 0 || !rejected) {
+        fprintf(stderr, "Error: Ring did not answer every request correctly\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
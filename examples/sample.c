@@ -0,0 +1,156 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fsrs.h"
+
+#define NUM_CARDS 20000
+#define MAX_REVIEWS 12
+#define SAMPLE_SIZE 5000
+#define RECENT_SAMPLE_SIZE 1000
+
+static uint32_t next_random(uint64_t* const state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+static bool same_items(const fsrs_FSRSItem* const a, const fsrs_FSRSItem* const b) {
+    return a->len == b->len && memcmp(a->reviews, b->reviews, a->len * sizeof(fsrs_FSRSReview)) == 0;
+}
+
+static bool same_sets(const fsrs_FsrsItems* const a, const fsrs_FsrsItems* const b) {
+    if (a->len != b->len) {
+        return false;
+    }
+    for (size_t i = 0; i < a->len; i++) {
+        if (!same_items(&a->items[i], &b->items[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Finds the card each sampled item was cut from, scanning cards in order as the items
+// are. Returns false if an item is not a longer prefix of the same card than the one
+// before it, or of a later card. `last_reviews` counts the items that end at their
+// card's last review.
+static bool match_cards(const fsrs_FsrsItems* const sample, const fsrs_FsrsReviewHistories* const histories,
+                        size_t* const last_reviews) {
+    size_t card = 0;
+    size_t last_len = 0;
+    *last_reviews = 0;
+    for (size_t i = 0; i < sample->len; i++) {
+        const fsrs_FSRSItem* const item = &sample->items[i];
+        for (;; card++, last_len = 0) {
+            if (card == histories->num_cards) {
+                return false;
+            }
+            const size_t card_len = histories->offsets[card + 1] - histories->offsets[card];
+            if (item->len > last_len && item->len <= card_len
+                && memcmp(item->reviews, &histories->reviews[histories->offsets[card]],
+                          item->len * sizeof(fsrs_FSRSReview)) == 0) {
+                *last_reviews += item->len == card_len;
+                last_len = item->len;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+// Largest difference between the two sets in the share of items predicting each rating.
+static double rating_mix_difference(const fsrs_FsrsItems* const a, const fsrs_FsrsItems* const b) {
+    double shares[2][4] = {{0}};
+    const fsrs_FsrsItems* const sets[2] = {a, b};
+    for (size_t s = 0; s < 2; s++) {
+        for (size_t i = 0; i < sets[s]->len; i++) {
+            const fsrs_FSRSItem* const item = &sets[s]->items[i];
+            shares[s][item->reviews[item->len - 1].rating - 1] += 1.0 / (double)sets[s]->len;
+        }
+    }
+    double difference = 0.0;
+    for (size_t rating = 0; rating < 4; rating++) {
+        difference = fmax(difference, fabs(shares[0][rating] - shares[1][rating]));
+    }
+    return difference;
+}
+
+int32_t main(void) {
+    fsrs_FSRSReview* const reviews = malloc(NUM_CARDS * MAX_REVIEWS * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    if (!reviews || !offsets) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+    uint64_t random = 29;
+    size_t total = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        offsets[i] = total;
+        const size_t len = 1 + next_random(&random) % MAX_REVIEWS;
+        // A first interval of its own tells each card's items apart from the others'
+        uint32_t interval = 1 + (uint32_t)i;
+        for (size_t k = 0; k < len; k++) {
+            // Mostly Good, as in real collections
+            const uint32_t draw = next_random(&random) % 10;
+            const uint32_t rating = draw < 2 ? 1 : draw < 3 ? 2 : draw < 9 ? 3 : 4;
+            reviews[total++] = (fsrs_FSRSReview){.rating = rating, .delta_t = k == 0 ? 0 : interval};
+            interval = k == 0 ? interval : rating == 1 ? 1 : interval * 2 % 400 + 1;
+        }
+    }
+    offsets[NUM_CARDS] = total;
+    const fsrs_FsrsReviewHistories histories = {reviews, offsets, NUM_CARDS};
+
+    // The sample draws from the same items as the full set, and keeps all of them when
+    // there are few enough
+    size_t eligible = 0;
+    fsrs_FsrsItems* const full = fsrs_train_set_from_histories(&histories);
+    fsrs_FsrsItems* const everything = fsrs_train_set_sample_from_histories(&histories, SIZE_MAX, 0, 1, &eligible);
+    fsrs_FsrsItems* const sample = fsrs_train_set_sample_from_histories(&histories, SAMPLE_SIZE, 0, 1, NULL);
+    fsrs_FsrsItems* const again = fsrs_train_set_sample_from_histories(&histories, SAMPLE_SIZE, 0, 1, NULL);
+    fsrs_FsrsItems* const reseeded = fsrs_train_set_sample_from_histories(&histories, SAMPLE_SIZE, 0, 2, NULL);
+    fsrs_FsrsItems* const recent = fsrs_train_set_sample_from_histories(&histories, RECENT_SAMPLE_SIZE, 1, 1, NULL);
+    if (!full || !everything || !sample || !again || !reseeded || !recent) {
+        fprintf(stderr, "Error: Failed to build the train sets\n");
+        return EXIT_FAILURE;
+    }
+    const bool complete = eligible == full->len && same_sets(everything, full);
+    printf("Full set of %zu items, kept whole when it fits: %s\n", full->len, complete ? "yes" : "no");
+    bool ok = complete;
+
+    // About the requested size, every item from a card in order, the full set's mix of
+    // ratings, and the same items for the same seed only
+    size_t last_reviews = 0;
+    const bool matched = match_cards(sample, &histories, &last_reviews);
+    const double size_error = fabs((double)sample->len - SAMPLE_SIZE) / SAMPLE_SIZE;
+    const double mix_difference = rating_mix_difference(sample, full);
+    printf("Sampled %zu items (%.1f%% off), rating mix within %.2f%% of the full set\n", sample->len,
+           100.0 * size_error, 100.0 * mix_difference);
+    printf("Same sample for the same seed: %s, for another seed: %s\n", same_sets(sample, again) ? "yes" : "no",
+           same_sets(sample, reseeded) ? "yes" : "no");
+    ok &= matched && size_error < 0.05 && mix_difference < 0.02 && same_sets(sample, again)
+        && !same_sets(sample, reseeded);
+
+    // With room for fewer items than cards, only items ending at their card's last review
+    // are kept
+    const bool recent_matched = match_cards(recent, &histories, &last_reviews);
+    printf("Sampled %zu items preferring the last review, %zu of them end there\n", recent->len, last_reviews);
+    ok &= recent_matched && last_reviews == recent->len
+        && fabs((double)recent->len - RECENT_SAMPLE_SIZE) < 0.1 * RECENT_SAMPLE_SIZE;
+
+    fsrs_items_free(full);
+    fsrs_items_free(everything);
+    fsrs_items_free(sample);
+    fsrs_items_free(again);
+    fsrs_items_free(reseeded);
+    fsrs_items_free(recent);
+    free(reviews);
+    free(offsets);
+
+    if (!ok) {
+        fprintf(stderr, "Error: The sample does not represent the full train set\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
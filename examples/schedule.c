@@ -64,7 +64,7 @@ static void print_date(const time_t timestamp) {
 }
 
 // Function to schedule a new card
-static void schedule_new_card(void) {
+static void schedule_new_card(const fsrs_HandleCache* const cache) {
     printf("=== Scheduling a new card ===\n");
     
     // Create a new card
@@ -77,8 +77,8 @@ static void schedule_new_card(void) {
     // Set desired retention
     const float desired_retention = 0.9f;
     
-    // Create a new FSRS model
-    const fsrs_FSRS* const fsrs = fsrs_new(DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
+    // Get the FSRS model for these parameters, built once and shared through the cache
+    const fsrs_FSRS* const fsrs = fsrs_handle_cache_acquire(cache, DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
     if (!fsrs) {
         fprintf(stderr, "Error: Failed to create FSRS instance\n");
         card_free(card);
@@ -89,7 +89,7 @@ static void schedule_new_card(void) {
     fsrs_NextStates* const next_states = fsrs_next_states(fsrs, NULL, desired_retention, 0U);
     if (!next_states) {
         fprintf(stderr, "Error: Failed to get next states\n");
-        fsrs_free(fsrs);
+        fsrs_handle_cache_release(fsrs);
         card_free(card);
         return;
     }
@@ -115,7 +115,7 @@ static void schedule_new_card(void) {
     if (!card->memory_state) {
         fprintf(stderr, "Error: Failed to create memory state\n");
         fsrs_next_states_free(next_states);
-        fsrs_free(fsrs);
+        fsrs_handle_cache_release(fsrs);
         card_free(card);
         return;
     }
@@ -132,12 +132,12 @@ static void schedule_new_card(void) {
     
     // Cleanup
     fsrs_next_states_free(next_states);
-    fsrs_free(fsrs);
+    fsrs_handle_cache_release(fsrs);
     card_free(card);
 }
 
 // Function to schedule an existing card
-static void schedule_existing_card(void) {
+static void schedule_existing_card(const fsrs_HandleCache* const cache) {
     printf("\n=== Scheduling an existing card ===\n");
     
     // Create an existing card with memory state and last review date
@@ -164,8 +164,8 @@ static void schedule_existing_card(void) {
     // Set desired retention
     const float desired_retention = 0.9f;
     
-    // Create a new FSRS model
-    const fsrs_FSRS* const fsrs = fsrs_new(DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
+    // Get the FSRS model for these parameters, built once and shared through the cache
+    const fsrs_FSRS* const fsrs = fsrs_handle_cache_acquire(cache, DEFAULT_PARAMETERS, DEFAULT_PARAMETERS_LEN);
     if (!fsrs) {
         fprintf(stderr, "Error: Failed to create FSRS instance\n");
         card_free(card);
@@ -179,7 +179,7 @@ static void schedule_existing_card(void) {
     fsrs_NextStates* const next_states = fsrs_next_states(fsrs, card->memory_state, desired_retention, elapsed_days);
     if (!next_states) {
         fprintf(stderr, "Error: Failed to get next states\n");
-        fsrs_free(fsrs);
+        fsrs_handle_cache_release(fsrs);
         card_free(card);
         return;
     }
@@ -208,7 +208,7 @@ static void schedule_existing_card(void) {
     if (!card->memory_state) {
         fprintf(stderr, "Error: Failed to create new memory state\n");
         fsrs_next_states_free(next_states);
-        fsrs_free(fsrs);
+        fsrs_handle_cache_release(fsrs);
         card_free(card);
         return;
     }
@@ -225,12 +225,20 @@ static void schedule_existing_card(void) {
     
     // Cleanup
     fsrs_next_states_free(next_states);
-    fsrs_free(fsrs);
+    fsrs_handle_cache_release(fsrs);
     card_free(card);
 }
 
 int32_t main(void) {
-    schedule_new_card();
-    schedule_existing_card();
+    fsrs_HandleCache* const cache = fsrs_handle_cache_new(4);
+    if (!cache) {
+        fprintf(stderr, "Error: Failed to create handle cache\n");
+        return EXIT_FAILURE;
+    }
+
+    schedule_new_card(cache);
+    schedule_existing_card(cache);
+
+    fsrs_handle_cache_free(cache);
     return EXIT_SUCCESS;
 } 
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fsrs.h"
+
+#define LEARN_SPAN 30
+// Longer than the simulation, to check that days past its end are left alone
+#define FORECAST_DAYS 40
+#define UNTOUCHED -1.0f
+
+typedef struct {
+    float reviews[FORECAST_DAYS];
+    float learned[FORECAST_DAYS];
+    float memorized[FORECAST_DAYS];
+    float cost[FORECAST_DAYS];
+} Forecast;
+
+static bool simulate(const fsrs_FSRS* const fsrs, const fsrs_SimulationConfig* const config,
+                     const float desired_retention, const uint64_t seed, const size_t num_runs,
+                     Forecast* const out) {
+    for (size_t day = 0; day < FORECAST_DAYS; day++) {
+        out->reviews[day] = out->learned[day] = out->memorized[day] = out->cost[day] = UNTOUCHED;
+    }
+    const fsrs_WorkloadForecast forecast = {out->reviews, out->learned, out->memorized, out->cost, FORECAST_DAYS};
+    return fsrs_simulate(fsrs, config, desired_retention, seed, num_runs, &forecast);
+}
+
+static float total(const float* const per_day) {
+    float sum = 0.0f;
+    for (size_t day = 0; day < LEARN_SPAN; day++) {
+        sum += per_day[day];
+    }
+    return sum;
+}
+
+// Counts the days that break the limits of the config or were written past its span.
+static size_t implausible_days(const Forecast* const forecast, const fsrs_SimulationConfig* const config) {
+    size_t implausible = 0;
+    for (size_t day = 0; day < FORECAST_DAYS; day++) {
+        if (day >= LEARN_SPAN) {
+            implausible += forecast->reviews[day] != UNTOUCHED || forecast->learned[day] != UNTOUCHED
+                || forecast->memorized[day] != UNTOUCHED || forecast->cost[day] != UNTOUCHED;
+            continue;
+        }
+        implausible += !(forecast->reviews[day] >= 0.0f && forecast->reviews[day] <= (float)config->review_limit)
+            || !(forecast->learned[day] >= 0.0f && forecast->learned[day] <= (float)config->learn_limit)
+            || !(forecast->memorized[day] >= 0.0f && forecast->memorized[day] <= (float)config->deck_size)
+            || !(forecast->cost[day] >= 0.0f && isfinite(forecast->cost[day]));
+    }
+    return implausible;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    Forecast* const forecasts = malloc(5 * sizeof(Forecast));
+    if (!fsrs || !forecasts) {
+        fprintf(stderr, "Error: Failed to set up the simulation\n");
+        return EXIT_FAILURE;
+    }
+    fsrs_SimulationConfig config = fsrs_simulation_config_default();
+    config.deck_size = 300;
+    config.learn_span = LEARN_SPAN;
+    config.learn_limit = 10;
+
+    // The same seed gives the same forecast, and several runs average runs with
+    // consecutive seeds
+    Forecast* const first = &forecasts[0];
+    Forecast* const again = &forecasts[1];
+    Forecast* const seed_0 = &forecasts[2];
+    Forecast* const seed_1 = &forecasts[3];
+    Forecast* const strict = &forecasts[4];
+    bool ok = simulate(fsrs, &config, 0.9f, 42, 2, first) && simulate(fsrs, &config, 0.9f, 42, 2, again)
+        && simulate(fsrs, &config, 0.9f, 42, 1, seed_0) && simulate(fsrs, &config, 0.9f, 43, 1, seed_1)
+        && simulate(fsrs, &config, 0.97f, 42, 2, strict);
+    size_t different = 0;
+    for (size_t day = 0; ok && day < LEARN_SPAN; day++) {
+        different += first->cost[day] != again->cost[day] || first->memorized[day] != again->memorized[day]
+            || fabsf(first->reviews[day] - (seed_0->reviews[day] + seed_1->reviews[day]) / 2.0f) > 1e-3f
+            || fabsf(first->learned[day] - (seed_0->learned[day] + seed_1->learned[day]) / 2.0f) > 1e-3f;
+    }
+    const size_t implausible = implausible_days(first, &config) + implausible_days(strict, &config);
+    printf("Forecast %d days: %.0f reviews, %.0f learned, %.1f memorized, %.0f s\n", LEARN_SPAN,
+           total(first->reviews), total(first->learned), first->memorized[LEARN_SPAN - 1], total(first->cost));
+    printf("Forecast at 97%% retention: %.0f reviews\n", total(strict->reviews));
+    printf("%zu days differ from the runs they average, %zu implausible\n", different, implausible);
+    // A higher desired retention needs more reviews
+    ok &= different == 0 && implausible == 0 && total(strict->reviews) > total(first->reviews);
+
+    // The optimum is one of the retentions tried, and the same for the same seed
+    const float optimal = fsrs_optimal_retention(fsrs, &config, 0.75f, 0.95f, 7, 2);
+    const float repeated = fsrs_optimal_retention(fsrs, &config, 0.75f, 0.95f, 7, 2);
+    const float step = (optimal - 0.75f) / 0.01f;
+    printf("Optimal retention between 0.75 and 0.95: %.2f\n", optimal);
+    ok &= optimal >= 0.75f - 1e-4f && optimal <= 0.95f + 1e-4f && fabsf(step - roundf(step)) < 1e-2f
+        && optimal == repeated;
+
+    // Ranges that cannot be stepped through, and runs too many to hold, fail instead of
+    // exhausting memory
+    const bool refused = isnan(fsrs_optimal_retention(fsrs, &config, 0.75f, INFINITY, 7, 1))
+        && isnan(fsrs_optimal_retention(fsrs, &config, -INFINITY, 0.95f, 7, 1))
+        && isnan(fsrs_optimal_retention(fsrs, &config, NAN, 0.95f, 7, 1))
+        && isnan(fsrs_optimal_retention(fsrs, &config, 0.95f, 0.75f, 7, 1))
+        && isnan(fsrs_optimal_retention(fsrs, &config, 0.75f, 0.95f, 7, SIZE_MAX))
+        && !simulate(fsrs, &config, 0.9f, 42, SIZE_MAX, first) && first->cost[0] == UNTOUCHED;
+    printf("Unreasonable requests refused: %s\n", refused ? "yes" : "no");
+    ok &= refused;
+
+    free(forecasts);
+    fsrs_free(fsrs);
+
+    if (!ok) {
+        fprintf(stderr, "Error: The simulation does not match its settings\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include "fsrs.h"
+
+#define NUM_EASES 20
+#define NUM_INTERVALS 150
+#define NUM_CARDS (NUM_EASES * NUM_INTERVALS)
+#define SM2_RETENTION 0.9f
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    float* const ease_factors = malloc(NUM_CARDS * sizeof(float));
+    float* const intervals = malloc(NUM_CARDS * sizeof(float));
+    float* const sm2_retentions = malloc(NUM_CARDS * sizeof(float));
+    fsrs_MemoryState* const memory_states = malloc(NUM_CARDS * sizeof(fsrs_MemoryState));
+    uint32_t* const days_elapsed = malloc(NUM_CARDS * sizeof(uint32_t));
+    float* const retrievabilities = malloc(NUM_CARDS * sizeof(float));
+    if (!fsrs || !ease_factors || !intervals || !sm2_retentions || !memory_states || !days_elapsed
+        || !retrievabilities) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+
+    // Card e * NUM_INTERVALS + i has ease 130% + 10% * e and an interval of 1 + 2i days
+    for (size_t e = 0; e < NUM_EASES; e++) {
+        for (size_t i = 0; i < NUM_INTERVALS; i++) {
+            const size_t card = e * NUM_INTERVALS + i;
+            ease_factors[card] = 1.3f + 0.1f * (float)e;
+            intervals[card] = (float)(1 + 2 * i);
+            sm2_retentions[card] = SM2_RETENTION;
+            days_elapsed[card] = (uint32_t)(1 + 2 * i);
+        }
+    }
+    const size_t failed = fsrs_memory_states_from_sm2(
+        fsrs, ease_factors, intervals, sm2_retentions, memory_states, NUM_CARDS);
+
+    // A converted card is as likely to be recalled at the end of its SM-2 interval as SM-2
+    // scheduled it to be, and longer intervals and higher eases mean an easier card
+    fsrs_retrievability_batch(fsrs, memory_states, days_elapsed, retrievabilities, NUM_CARDS);
+    float max_error = 0.0f;
+    size_t out_of_order = 0;
+    for (size_t card = 0; card < NUM_CARDS; card++) {
+        const fsrs_MemoryState* const memory = &memory_states[card];
+        max_error = fmaxf(max_error, fabsf(retrievabilities[card] - SM2_RETENTION));
+        if (!(memory->stability > 0.0f) || !(memory->difficulty >= 1.0f && memory->difficulty <= 10.0f)
+            || (card % NUM_INTERVALS > 0 && memory->stability <= memory[-1].stability)
+            || (card >= NUM_INTERVALS && memory->difficulty > memory[-NUM_INTERVALS].difficulty)) {
+            out_of_order++;
+        }
+    }
+    printf("Converted %d cards, %zu failed\n", NUM_CARDS, failed);
+    printf("Largest retrievability error at the SM-2 due date: %.6f\n", max_error);
+    printf("Cards out of order by interval or ease: %zu\n", out_of_order);
+
+    // A NULL array, input or output, converts nothing and reports every card
+    fsrs_MemoryState untouched[2] = {{.stability = 5.0f, .difficulty = 5.0f}, {.stability = 5.0f, .difficulty = 5.0f}};
+    const size_t null_input = fsrs_memory_states_from_sm2(fsrs, NULL, intervals, sm2_retentions, untouched, 2);
+    const size_t null_output = fsrs_memory_states_from_sm2(fsrs, ease_factors, intervals, sm2_retentions, NULL, 2);
+    const size_t empty = fsrs_memory_states_from_sm2(fsrs, NULL, NULL, NULL, NULL, 0);
+    const bool nulls_reported = null_input == 2 && untouched[0].stability == 0.0f && null_output == 2 && empty == 0;
+    printf("NULL arrays reported as failures: %s\n", nulls_reported ? "yes" : "no");
+
+    free(ease_factors);
+    free(intervals);
+    free(sm2_retentions);
+    free(memory_states);
+    free(days_elapsed);
+    free(retrievabilities);
+    fsrs_free(fsrs);
+
+    if (failed != 0 || max_error > 1e-3f || out_of_order != 0 || !nulls_reported) {
+        fprintf(stderr, "Error: SM-2 conversion does not preserve the scheduled retention\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+static const char* const SNAPSHOT_PATH = "snapshot_example.bin";
+
+// FSRS-6 parameters; the last one is the decay of the forgetting curve
+static const float PARAMETERS[] = {
+    0.212f, 1.2931f, 2.3065f, 8.2956f, 6.4133f, 0.8334f, 3.0194f, 0.001f,
+    1.8722f, 0.1666f, 0.796f, 1.4835f, 0.0614f, 0.2629f, 1.6483f, 0.6014f,
+    1.8729f, 0.5425f, 0.0912f, 0.0658f, 0.1542f
+};
+static const size_t PARAMETERS_LEN = sizeof(PARAMETERS) / sizeof(PARAMETERS[0]);
+
+// Counts the cards whose next states differ, bit for bit, between the two handles.
+static size_t count_differences(const fsrs_FSRS* const a, const fsrs_FSRS* const b) {
+    size_t differences = 0;
+    for (uint32_t days_elapsed = 0; days_elapsed < 400; days_elapsed += 7) {
+        for (float stability = 0.5f; stability < 1000.0f; stability *= 1.7f) {
+            for (float difficulty = 1.0f; difficulty <= 10.0f; difficulty += 1.5f) {
+                fsrs_MemoryState memory = {.stability = stability, .difficulty = difficulty};
+                fsrs_NextStates* const expected = fsrs_next_states(a, &memory, 0.9f, days_elapsed);
+                fsrs_NextStates* const actual = fsrs_next_states(b, &memory, 0.9f, days_elapsed);
+                if (!expected || !actual || memcmp(expected, actual, sizeof(fsrs_NextStates)) != 0) {
+                    differences++;
+                }
+                fsrs_next_states_free(expected);
+                fsrs_next_states_free(actual);
+            }
+        }
+    }
+    return differences;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(PARAMETERS, PARAMETERS_LEN);
+    if (!fsrs) {
+        fprintf(stderr, "Error: Failed to create FSRS instance\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = true;
+
+    // Handles created from snapshots are counted like those from fsrs_new
+    fsrs_stats_enable(true);
+
+    // Through a file, as an app saving its optimized parameters would. The save goes
+    // through a temporary file, which must not be left behind, and replaces an older
+    // snapshot in place.
+    remove(SNAPSHOT_PATH);
+    const fsrs_FSRS* const other = fsrs_new(NULL, 0);
+    const bool saved = fsrs_snapshot_save(other, SNAPSHOT_PATH) && fsrs_snapshot_save(fsrs, SNAPSHOT_PATH);
+    fsrs_free(other);
+    char temporary_path[64];
+    snprintf(temporary_path, sizeof(temporary_path), "%s.tmp", SNAPSHOT_PATH);
+    FILE* const temporary = fopen(temporary_path, "rb");
+    printf("Temporary file left behind: %s\n", temporary ? "yes" : "no");
+    ok &= !temporary && !fsrs_snapshot_save(fsrs, "/nonexistent/snapshot.bin");
+    if (temporary) {
+        fclose(temporary);
+    }
+    const fsrs_FSRS* const from_file = saved ? fsrs_snapshot_load(SNAPSHOT_PATH) : NULL;
+    remove(SNAPSHOT_PATH);
+    if (from_file) {
+        const size_t differences = count_differences(fsrs, from_file);
+        printf("Loaded from file: %zu-byte snapshot, %zu cards scheduled differently\n",
+               fsrs_snapshot_size(from_file), differences);
+        ok &= differences == 0 && fsrs_snapshot_size(from_file) == fsrs_snapshot_size(fsrs);
+        fsrs_free(from_file);
+    } else {
+        printf("Failed to save and load the snapshot file\n");
+        ok = false;
+    }
+
+    // Through memory, as a server sharing one mapped snapshot would
+    const size_t size = fsrs_snapshot_size(fsrs);
+    uint8_t* const buffer = malloc(size);
+    const fsrs_FSRS* const from_buffer = buffer && fsrs_snapshot_write(fsrs, buffer, size) == size
+        ? fsrs_new_from_snapshot(buffer, size)
+        : NULL;
+    if (from_buffer) {
+        const size_t differences = count_differences(fsrs, from_buffer);
+        printf("Loaded from memory: %zu cards scheduled differently\n", differences);
+        ok &= differences == 0;
+        fsrs_free(from_buffer);
+    } else {
+        printf("Failed to write and read the snapshot in memory\n");
+        ok = false;
+    }
+
+    // A damaged snapshot must be rejected rather than loaded with other parameters
+    if (buffer) {
+        buffer[size / 2] ^= 1;
+        const fsrs_FSRS* const damaged = fsrs_new_from_snapshot(buffer, size);
+        printf("Damaged snapshot rejected: %s\n", damaged ? "no" : "yes");
+        ok &= !damaged;
+        fsrs_free(damaged);
+    }
+
+    // Dropping the decay, as building a handle from the first 19 parameters would,
+    // changes the schedule, so the round trips above must keep all 21
+    const fsrs_FSRS* const truncated = fsrs_new(PARAMETERS, 19);
+    if (truncated) {
+        const size_t differences = count_differences(fsrs, truncated);
+        printf("Without the decay: %zu cards scheduled differently\n", differences);
+        ok &= differences > 0;
+        fsrs_free(truncated);
+    }
+
+    // Two fsrs_new calls, and loads from the file, from memory and from the damaged buffer
+    fsrs_Stats stats;
+    fsrs_stats_snapshot(&stats);
+    printf("Handle creations counted: %llu\n", (unsigned long long)stats.new_handle.calls);
+    ok &= stats.new_handle.calls == 5;
+
+    free(buffer);
+    fsrs_free(fsrs);
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
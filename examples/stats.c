@@ -0,0 +1,72 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "fsrs.h"
+
+#define NUM_CALLS 1000
+
+// Checks that a function's counters agree with themselves and with the expected call count.
+static bool consistent(const char* const name, const fsrs_CallStats* const stats, const uint64_t calls) {
+    uint64_t bucketed = 0;
+    for (size_t i = 0; i < fsrs_STATS_HISTOGRAM_BUCKETS; i++) {
+        bucketed += stats->histogram[i];
+    }
+    printf("%-18s %5llu calls, %10llu ns total, %8llu ns max\n", name,
+           (unsigned long long)stats->calls, (unsigned long long)stats->total_ns,
+           (unsigned long long)stats->max_ns);
+    return stats->calls == calls && bucketed == calls && stats->max_ns <= stats->total_ns
+        && (calls == 0 || stats->total_ns > 0);
+}
+
+static void next_states(const fsrs_FSRS* const fsrs, const size_t calls) {
+    for (size_t i = 0; i < calls; i++) {
+        fsrs_MemoryState memory = {.stability = 1.0f + (float)(i % 50), .difficulty = 5.0f};
+        fsrs_next_states_free(fsrs_next_states(fsrs, &memory, 0.9f, (uint32_t)(i % 30)));
+    }
+}
+
+int32_t main(void) {
+    // Calls made while the counters are disabled must not be counted
+    const fsrs_FSRS* const uncounted = fsrs_new(NULL, 0);
+    if (!uncounted) {
+        fprintf(stderr, "Error: Failed to create FSRS instance\n");
+        return EXIT_FAILURE;
+    }
+    next_states(uncounted, NUM_CALLS);
+    fsrs_free(uncounted);
+
+    fsrs_stats_enable(true);
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    next_states(fsrs, NUM_CALLS);
+    fsrs_FSRSReview reviews[] = {{.rating = 3, .delta_t = 0}, {.rating = 3, .delta_t = 3}};
+    fsrs_FsrsReviews history = {reviews, 2};
+    fsrs_FSRSItem* const item = fsrs_item_new(&history);
+    // An empty train set fails quickly, but the call is still timed
+    fsrs_FsrsItems empty = {item, 0};
+    size_t parameters_len = 0;
+    fsrs_parameters_free(fsrs_compute_parameters(fsrs, &empty, &parameters_len), parameters_len);
+
+    fsrs_Stats stats;
+    fsrs_stats_snapshot(&stats);
+    bool ok = consistent("fsrs_new", &stats.new_handle, 1)
+        & consistent("fsrs_next_states", &stats.next_states, NUM_CALLS)
+        & consistent("fsrs_item_new", &stats.item_new, 1)
+        & consistent("compute_parameters", &stats.compute_parameters, 1);
+
+    fsrs_stats_reset();
+    fsrs_stats_snapshot(&stats);
+    const bool reset = stats.new_handle.calls == 0 && stats.next_states.calls == 0
+        && stats.next_states.total_ns == 0 && stats.next_states.max_ns == 0
+        && stats.next_states.histogram[0] == 0;
+    printf("Counters reset: %s\n", reset ? "yes" : "no");
+    ok &= reset;
+
+    fsrs_item_free(item);
+    fsrs_free(fsrs);
+    if (!ok) {
+        fprintf(stderr, "Error: The counters do not match the calls made\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,88 @@
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+#define NUM_THREADS 3
+#define NUM_CARDS 4096
+
+// Counts this process's threads in the shared pool, which are named "fsrs-<index>".
+// Returns -1 where /proc is not available.
+static int32_t count_pool_threads(void) {
+    DIR* const tasks = opendir("/proc/self/task");
+    if (!tasks) {
+        return -1;
+    }
+    int32_t threads = 0;
+    const struct dirent* task;
+    while ((task = readdir(tasks))) {
+        char path[300];
+        char name[32] = {0};
+        snprintf(path, sizeof(path), "/proc/self/task/%s/comm", task->d_name);
+        FILE* const comm = fopen(path, "r");
+        if (!comm) {
+            continue;
+        }
+        if (fgets(name, sizeof(name), comm) && strncmp(name, "fsrs-", 5) == 0
+            && name[5] >= '0' && name[5] <= '9') {
+            threads++;
+        }
+        fclose(comm);
+    }
+    closedir(tasks);
+    return threads;
+}
+
+int32_t main(void) {
+    // The pool can only be sized before its first use
+    const bool sized = fsrs_set_num_threads(NUM_THREADS);
+    const bool resized = fsrs_set_num_threads(NUM_THREADS + 1);
+    const int32_t threads = count_pool_threads();
+    printf("Pool sized: %s, resized later: %s, %d pool threads running\n",
+           sized ? "yes" : "no", resized ? "yes" : "no", threads);
+
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_MemoryState* const memory_states = malloc(NUM_CARDS * sizeof(fsrs_MemoryState));
+    uint32_t* const days_elapsed = malloc(NUM_CARDS * sizeof(uint32_t));
+    fsrs_NextStates* const next_states = malloc(NUM_CARDS * sizeof(fsrs_NextStates));
+    if (!fsrs || !memory_states || !days_elapsed || !next_states) {
+        fprintf(stderr, "Error: Failed to set up cards\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        // Every eighth card is new
+        memory_states[i] = (fsrs_MemoryState){
+            .stability = i % 8 == 0 ? 0.0f : 0.5f + (float)(i % 300),
+            .difficulty = i % 8 == 0 ? 0.0f : 1.0f + (float)(i % 10) * 0.9f,
+        };
+        days_elapsed[i] = (uint32_t)(i % 90);
+    }
+
+    // The pool's answers must match one card at a time on this thread
+    const size_t failed = fsrs_next_states_batch(fsrs, memory_states, days_elapsed, 0.9f, next_states, NUM_CARDS);
+    size_t mismatched = 0;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        fsrs_NextStates* const expected = fsrs_next_states(
+            fsrs, memory_states[i].stability > 0.0f ? &memory_states[i] : NULL, 0.9f, days_elapsed[i]);
+        if (!expected || memcmp(expected, &next_states[i], sizeof(fsrs_NextStates)) != 0) {
+            mismatched++;
+        }
+        fsrs_next_states_free(expected);
+    }
+    printf("Scheduled %d cards on the pool: %zu failed, %zu different from a single-card call\n",
+           NUM_CARDS, failed, mismatched);
+
+    free(memory_states);
+    free(days_elapsed);
+    free(next_states);
+    fsrs_free(fsrs);
+
+    if (!sized || resized || (threads >= 0 && threads != NUM_THREADS) || failed != 0 || mismatched != 0) {
+        fprintf(stderr, "Error: The shared pool did not run with the requested threads\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+static const char* const TRACE_PATH = "trace_example.json";
+
+// Reads the whole file into a NUL-terminated buffer, or returns NULL.
+static char* read_file(const char* const path) {
+    FILE* const file = fopen(path, "rb");
+    if (!file) {
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* const contents = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    if (contents) {
+        contents[fread(contents, 1, (size_t)size, file)] = '\0';
+    }
+    fclose(file);
+    return contents;
+}
+
+static size_t count(const char* haystack, const char* const needle) {
+    size_t found = 0;
+    while ((haystack = strstr(haystack, needle))) {
+        found++;
+        haystack += strlen(needle);
+    }
+    return found;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    if (!fsrs) {
+        fprintf(stderr, "Error: Failed to create FSRS instance\n");
+        return EXIT_FAILURE;
+    }
+    bool ok = !fsrs_trace_start("/nonexistent/trace.json") && !fsrs_trace_stop();
+
+    remove(TRACE_PATH);
+    ok &= fsrs_trace_start(TRACE_PATH);
+    // Only one trace can be active at a time
+    ok &= !fsrs_trace_start(TRACE_PATH);
+    fsrs_FSRSItem no_items[1] = {{0}};
+    fsrs_FsrsItems empty = {no_items, 0};
+    size_t parameters_len = 0;
+    fsrs_parameters_free(fsrs_compute_parameters(fsrs, &empty, &parameters_len), parameters_len);
+    ok &= fsrs_trace_stop();
+    // Calls after the trace stopped must not be recorded anywhere
+    fsrs_parameters_free(fsrs_compute_parameters(fsrs, &empty, &parameters_len), parameters_len);
+    fsrs_free(fsrs);
+
+    char* const trace = read_file(TRACE_PATH);
+    remove(TRACE_PATH);
+    if (!trace) {
+        fprintf(stderr, "Error: The trace file was not written\n");
+        return EXIT_FAILURE;
+    }
+    const size_t events = count(trace, "\"ph\":\"X\"");
+    const size_t length = strlen(trace);
+    const bool framed = strncmp(trace, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) == 0
+        && length >= 4 && strcmp(trace + length - 3, "]}\n") == 0;
+    printf("Trace of %zu bytes with %zu events, framed as JSON: %s\n", length, events, framed ? "yes" : "no");
+    ok &= framed && events == 3
+        && count(trace, "\"name\":\"compute_parameters\"") == 1
+        && count(trace, "\"name\":\"convert_train_set\"") == 1
+        && count(trace, "\"name\":\"train\"") == 1
+        && count(trace, "\"args\":{\"items\":0}") == 1;
+    free(trace);
+
+    if (!ok) {
+        fprintf(stderr, "Error: The trace does not match the calls made\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
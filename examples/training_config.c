@@ -0,0 +1,152 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fsrs.h"
+
+// Each card gives REVIEWS_PER_CARD - 1 items, just over the 10000 early stopping needs
+#define NUM_CARDS 2100
+#define SMALL_CARDS 500
+#define REVIEWS_PER_CARD 6
+#define MAX_STAGES 4
+#define FSRS6_PARAMETERS_LEN 21
+
+static const char* const TRACE_PATH = "training_config_example.json";
+
+// The spans one training run left in the trace.
+typedef struct {
+    uint64_t tid;
+    size_t stages;
+    uint64_t stage_items[MAX_STAGES];
+    uint64_t stage_tids[MAX_STAGES];
+} Run;
+
+// Reads the trace back, one event per line, and splits it into runs at each
+// compute_parameters span, which ends last. Returns the number of runs.
+static size_t read_runs(Run* const runs, const size_t max_runs) {
+    FILE* const trace = fopen(TRACE_PATH, "r");
+    if (!trace) {
+        return 0;
+    }
+    size_t count = 0;
+    Run current = {0};
+    char line[512];
+    while (count < max_runs && fgets(line, sizeof(line), trace)) {
+        char name[64];
+        unsigned long long tid;
+        if (sscanf(line, "{\"name\":\"%63[^\"]\",\"cat\":\"fsrs\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu", name, &tid) != 2) {
+            continue;
+        }
+        if (strcmp(name, "train_stage") == 0 && current.stages < MAX_STAGES) {
+            const char* const items = strstr(line, "\"items\":");
+            current.stage_items[current.stages] = items ? strtoull(items + 8, NULL, 10) : 0;
+            current.stage_tids[current.stages++] = tid;
+        } else if (strcmp(name, "compute_parameters") == 0) {
+            current.tid = tid;
+            runs[count++] = current;
+            current = (Run){0};
+        }
+    }
+    fclose(trace);
+    return count;
+}
+
+// Trains with `config` and checks that a full parameter set comes back.
+static bool train(const fsrs_FSRS* const fsrs, fsrs_FsrsItems* const train_set, const fsrs_TrainingConfig* const config) {
+    size_t len = 0;
+    float* const parameters = fsrs_compute_parameters_with_config(fsrs, train_set, config, &len);
+    const bool trained = parameters && len == FSRS6_PARAMETERS_LEN;
+    fsrs_parameters_free(parameters, len);
+    return trained;
+}
+
+int32_t main(void) {
+    const fsrs_FSRS* const fsrs = fsrs_new(NULL, 0);
+    fsrs_FSRSReview* const reviews = malloc(NUM_CARDS * REVIEWS_PER_CARD * sizeof(fsrs_FSRSReview));
+    size_t* const offsets = malloc((NUM_CARDS + 1) * sizeof(size_t));
+    if (!fsrs || !reviews || !offsets) {
+        fprintf(stderr, "Error: Failed to set up training\n");
+        return EXIT_FAILURE;
+    }
+    uint64_t random = 17;
+    for (size_t i = 0; i < NUM_CARDS; i++) {
+        offsets[i] = i * REVIEWS_PER_CARD;
+        uint32_t interval = 1;
+        for (size_t k = 0; k < REVIEWS_PER_CARD; k++) {
+            random = random * 6364136223846793005ULL + 1442695040888963407ULL;
+            const uint32_t rating = 1 + (uint32_t)(random >> 62);
+            reviews[i * REVIEWS_PER_CARD + k] = (fsrs_FSRSReview){.rating = rating, .delta_t = k == 0 ? 0 : interval};
+            interval = rating == 1 ? 1 : interval * 2;
+        }
+    }
+    offsets[NUM_CARDS] = NUM_CARDS * REVIEWS_PER_CARD;
+    const fsrs_FsrsReviewHistories histories = {reviews, offsets, NUM_CARDS};
+    const fsrs_FsrsReviewHistories small_histories = {reviews, offsets, SMALL_CARDS};
+    fsrs_FsrsItems* const train_set = fsrs_train_set_from_histories(&histories);
+    fsrs_FsrsItems* const small_set = fsrs_train_set_from_histories(&small_histories);
+    free(reviews);
+    free(offsets);
+    remove(TRACE_PATH);
+    if (!train_set || !small_set || !fsrs_trace_start(TRACE_PATH)) {
+        fprintf(stderr, "Error: Failed to build the train sets\n");
+        return EXIT_FAILURE;
+    }
+
+    // Early stopping on the calling thread and on a dedicated pool, then without it, on
+    // a set too small for it, and without the short-term parameters
+    fsrs_TrainingConfig early = fsrs_training_config_default();
+    early.early_stopping_tolerance = 0.05f;
+    fsrs_TrainingConfig early_pooled = early;
+    early_pooled.num_threads = 2;
+    const fsrs_TrainingConfig plain = fsrs_training_config_default();
+    fsrs_TrainingConfig long_term = early;
+    long_term.enable_short_term = false;
+    long_term.num_relearning_steps = 2;
+    bool ok = train(fsrs, train_set, &early) && train(fsrs, train_set, &early_pooled)
+        && train(fsrs, train_set, &plain) && train(fsrs, small_set, &early) && train(fsrs, small_set, &long_term);
+    ok &= fsrs_trace_stop();
+    printf("Trained %zu and %zu items five ways: %s\n", train_set->len, small_set->len, ok ? "ok" : "failed");
+
+    Run runs[5];
+    const size_t num_runs = read_runs(runs, 5);
+    remove(TRACE_PATH);
+    if (!ok || num_runs != 5) {
+        fprintf(stderr, "Error: Training with a config failed\n");
+        return EXIT_FAILURE;
+    }
+    const Run* const calling = &runs[0];
+    const Run* const pooled = &runs[1];
+    printf("Early stopping ran %zu stages on %llu and %llu items\n", calling->stages,
+           (unsigned long long)calling->stage_items[0], (unsigned long long)calling->stage_items[1]);
+
+    // The stages train on about an eighth and a quarter of the items left after a tenth
+    // is held out, the same items whatever the thread count
+    const double n = (double)train_set->len;
+    ok &= train_set->len >= 10000 && calling->stages >= 2 && pooled->stages == calling->stages
+        && (double)calling->stage_items[0] > 0.08 * n && (double)calling->stage_items[0] < 0.15 * n
+        && calling->stage_items[1] > calling->stage_items[0] * 17 / 10
+        && calling->stage_items[1] < calling->stage_items[0] * 23 / 10
+        && memcmp(calling->stage_items, pooled->stage_items, sizeof(calling->stage_items)) == 0;
+    // Without a thread count the stages run on the calling thread; with one, on the pool
+    bool on_pool = true;
+    for (size_t i = 0; i < calling->stages && i < MAX_STAGES; i++) {
+        ok &= calling->stage_tids[i] == calling->tid;
+        on_pool &= pooled->stage_tids[i] != pooled->tid;
+    }
+    printf("Stages on a dedicated pool with num_threads = 2: %s\n", on_pool ? "yes" : "no");
+    // No tolerance, or fewer than 10000 items, trains once on everything
+    const bool single = runs[2].stages == 0 && runs[3].stages == 0 && runs[4].stages == 0;
+    printf("Trained without stages when early stopping is off or the set is small: %s\n", single ? "yes" : "no");
+    ok &= on_pool && single;
+
+    fsrs_items_free(train_set);
+    fsrs_items_free(small_set);
+    fsrs_free(fsrs);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Training did not follow its config\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
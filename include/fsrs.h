@@ -5,9 +5,140 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+/**
+ * Number of bins in each histogram of `CollectionStats`.
+ *
+ * Retrievability bin `i` covers `[i, i + 1) / 20`, with 1 in the last bin. Stability
+ * bin 0 counts stabilities below 1 day and bin `i` those in `[2^(i-1), 2^i)` days; the
+ * last bin also holds everything larger. Difficulty bin `i` covers
+ * `1 + [i, i + 1) * 9 / 20`, with 10 in the last bin.
+ */
+#define fsrs_COLLECTION_STATS_BINS 20
+
+/**
+ * Number of days covered by the due forecast of `CollectionStats`.
+ */
+#define fsrs_COLLECTION_STATS_FORECAST_DAYS 30
+
+/**
+ * Number of latency histogram buckets in `CallStats`.
+ *
+ * Bucket 0 counts calls faster than 1µs, bucket `i` calls taking `[2^(i-1), 2^i)` µs;
+ * the last bucket also holds everything slower.
+ */
+#define fsrs_STATS_HISTOGRAM_BUCKETS 32
+
+/**
+ * A growable, column-oriented store of card states.
+ *
+ * Each field lives in its own array, so a due scan only reads due days. Cards are
+ * addressed by their index, which is assigned on insertion and never changes.
+ */
+typedef struct fsrs_CardStore fsrs_CardStore;
+
+/**
+ * Counts of cards due on each day, from `first_day` onwards.
+ *
+ * Days before `first_day` are not tracked. The histogram grows as later days are used,
+ * up to 131072 days (about 360 years) after `first_day`.
+ */
+typedef struct fsrs_DueHistogram fsrs_DueHistogram;
 
+/**
+ * Opaque handle for FSRS.
+ *
+ * A handle is immutable once `fsrs_new` has returned it, so any number of threads
+ * may pass the same `const fsrs_FSRS*` to the other functions concurrently. No lock
+ * is taken on that path; each call works on its own temporaries. Only `fsrs_free`
+ * must not race with other uses of the handle.
+ */
 typedef struct fsrs_FSRS fsrs_FSRS;
 
+/**
+ * A thread-safe cache of FSRS handles keyed by parameter vector.
+ *
+ * Handles are reference counted: every `fsrs_handle_cache_acquire` must be paired with
+ * one `fsrs_handle_cache_release`. A handle no caller holds any more stays cached while
+ * it is idle. When more than `capacity` handles are cached, misses evict idle handles
+ * in approximately least recently acquired order (the CLOCK algorithm); handles in use
+ * are never evicted.
+ */
+typedef struct fsrs_HandleCache fsrs_HandleCache;
+
+/**
+ * An append-only review journal backed by a compacted snapshot.
+ *
+ * Reviews are appended to the journal file as fixed-size, checksummed records with
+ * increasing sequence numbers. Compaction writes every review to the snapshot file and
+ * empties the journal, so opening a journal reads one snapshot plus a short tail.
+ */
+typedef struct fsrs_Journal fsrs_Journal;
+
+/**
+ * Counters for one instrumented function.
+ */
+typedef struct fsrs_CallStats {
+  uint64_t calls;
+  uint64_t total_ns;
+  uint64_t max_ns;
+  uint64_t histogram[fsrs_STATS_HISTOGRAM_BUCKETS];
+} fsrs_CallStats;
+
+typedef struct fsrs_MemoryState {
+  float stability;
+  float difficulty;
+} fsrs_MemoryState;
+
+/**
+ * The scheduling state of one card.
+ *
+ * A card that has never been reviewed has zero stability and difficulty.
+ */
+typedef struct fsrs_CardState {
+  struct fsrs_MemoryState memory;
+  int32_t last_review_day;
+  int32_t due_day;
+} fsrs_CardState;
+
+/**
+ * Read-only views of a CardStore's columns, each with `len` elements.
+ *
+ * The pointers are invalidated by any call that modifies the store.
+ */
+typedef struct fsrs_CardStoreColumns {
+  const int64_t *ids;
+  const float *stability;
+  const float *difficulty;
+  const int32_t *last_review_days;
+  const int32_t *due_days;
+  size_t len;
+} fsrs_CardStoreColumns;
+
+/**
+ * Aggregate statistics of a collection of cards on one day.
+ *
+ * Reviewed cards are those with a positive stability; means and histograms only cover
+ * them, while the forecast covers every card.
+ */
+typedef struct fsrs_CollectionStats {
+  uint64_t cards;
+  uint64_t reviewed_cards;
+  double mean_retrievability;
+  double mean_stability;
+  double mean_difficulty;
+  uint64_t retrievability_histogram[fsrs_COLLECTION_STATS_BINS];
+  uint64_t stability_histogram[fsrs_COLLECTION_STATS_BINS];
+  uint64_t difficulty_histogram[fsrs_COLLECTION_STATS_BINS];
+  /**
+   * Cards due before the given day.
+   */
+  uint64_t overdue_cards;
+  /**
+   * Element `i` counts the cards due `i` days after the given day.
+   */
+  uint64_t due_forecast[fsrs_COLLECTION_STATS_FORECAST_DAYS];
+} fsrs_CollectionStats;
+
 typedef struct fsrs_FSRSReview {
   uint32_t rating;
   uint32_t delta_t;
@@ -23,21 +154,145 @@ typedef struct fsrs_FsrsItems {
   size_t len;
 } fsrs_FsrsItems;
 
+/**
+ * Review histories of many cards in compressed sparse row layout.
+ *
+ * The reviews of card `i` are `reviews[offsets[i]..offsets[i + 1]]` in chronological
+ * order, so `offsets` has `num_cards + 1` elements.
+ */
+typedef struct fsrs_FsrsReviewHistories {
+  const struct fsrs_FSRSReview *reviews;
+  const size_t *offsets;
+  size_t num_cards;
+} fsrs_FsrsReviewHistories;
+
+/**
+ * Timestamped review logs of many cards, laid out like `FsrsReviewHistories`.
+ *
+ * Review `k` happened at Unix time `timestamps[k]` (seconds) with rating `ratings[k]`.
+ */
+typedef struct fsrs_FsrsReviewLogs {
+  const int64_t *timestamps;
+  const uint32_t *ratings;
+  const size_t *offsets;
+  size_t num_cards;
+} fsrs_FsrsReviewLogs;
+
 typedef struct fsrs_FsrsReviews {
   struct fsrs_FSRSReview *reviews;
   size_t len;
 } fsrs_FsrsReviews;
 
-typedef struct fsrs_MemoryState {
-  float stability;
-  float difficulty;
-} fsrs_MemoryState;
+/**
+ * Rules for `fsrs_review_histories_filter`.
+ *
+ * Start from `fsrs_history_filter_default` so that rules added later keep their
+ * default values.
+ */
+typedef struct fsrs_HistoryFilter {
+  /**
+   * Drop reviews rated outside 1-4, such as the rating 0 Anki logs for manual
+   * reschedules. Their `delta_t` is added to the next review's. Defaults to true.
+   */
+  bool drop_manual;
+  /**
+   * Drop a review with `delta_t` 0 and the same rating as the review kept before it,
+   * e.g. an answer recorded twice. Histories only have day resolution, so this also
+   * drops genuine same-day learning steps such as Again followed by Again; enable it
+   * only for sources known to log answers twice. Defaults to false.
+   */
+  bool drop_duplicates;
+  /**
+   * Drop every review of a card with a `delta_t` above this many days, which usually
+   * comes from a broken clock or import. 0 disables the rule. Defaults to 36500.
+   */
+  uint32_t max_delta_t;
+} fsrs_HistoryFilter;
+
+/**
+ * What `fsrs_review_histories_filter` dropped, per rule.
+ */
+typedef struct fsrs_HistoryFilterCounts {
+  /**
+   * Reviews dropped by `drop_manual`.
+   */
+  size_t manual_reviews;
+  /**
+   * Reviews dropped by `drop_duplicates`.
+   */
+  size_t duplicate_reviews;
+  /**
+   * Cards emptied by `max_delta_t`.
+   */
+  size_t extreme_delta_t_cards;
+  /**
+   * Reviews those cards had.
+   */
+  size_t extreme_delta_t_reviews;
+} fsrs_HistoryFilterCounts;
 
 typedef struct fsrs_ItemState {
   struct fsrs_MemoryState memory;
   float interval;
 } fsrs_ItemState;
 
+/**
+ * Every review held by a journal, grouped by card.
+ *
+ * Card `i` has id `card_ids[i]` and its reviews are laid out as described on
+ * `FsrsReviewLogs`, so `logs` can be passed to `fsrs_review_histories_from_logs`.
+ */
+typedef struct fsrs_JournalContents {
+  const int64_t *card_ids;
+  struct fsrs_FsrsReviewLogs logs;
+} fsrs_JournalContents;
+
+/**
+ * One review to record in a journal.
+ */
+typedef struct fsrs_JournalReview {
+  int64_t card_id;
+  int64_t timestamp;
+  uint32_t rating;
+} fsrs_JournalReview;
+
+/**
+ * A card's memory state after its first `review_count` reviews.
+ *
+ * A card that has not been reviewed yet has a zeroed checkpoint, except that
+ * `last_review_day` should be set to the day of its first review. Later days are
+ * derived from the `delta_t` of each review.
+ */
+typedef struct fsrs_MemoryCheckpoint {
+  struct fsrs_MemoryState memory;
+  int32_t last_review_day;
+  uint32_t review_count;
+} fsrs_MemoryCheckpoint;
+
+/**
+ * Heap memory allocated by the library, as counted by `fsrs_memory_usage`.
+ */
+typedef struct fsrs_MemoryUsage {
+  /**
+   * Bytes currently allocated.
+   */
+  size_t current_bytes;
+  /**
+   * Most bytes allocated at once since tracking was enabled or the peak was reset.
+   */
+  size_t peak_bytes;
+  /**
+   * Allocations, including reallocations, since tracking was enabled.
+   */
+  uint64_t allocations;
+  /**
+   * Peak resident set size of the whole process, as reported by the operating system;
+   * 0 where it is not available. Unlike the other fields, it does not need tracking
+   * and cannot be reset.
+   */
+  size_t peak_rss_bytes;
+} fsrs_MemoryUsage;
+
 typedef struct fsrs_NextStates {
   struct fsrs_ItemState again;
   struct fsrs_ItemState hard;
@@ -46,144 +301,1338 @@ typedef struct fsrs_NextStates {
 } fsrs_NextStates;
 
 /**
- * Computes the parameters for a given train set.
+ * A `CardState` packed into 8 bytes.
+ *
+ * Bits 0-15 hold stability on a log scale covering 2^-10 to 2^22 days, with a relative
+ * error below 0.02%. Bits 16-23 hold difficulty in [1, 10] with an absolute error below
+ * 0.018. Bits 24-47 hold the last review day (0 to 16777215) and bits 48-63 the due
+ * day as an offset of up to 65535 days from it. Values outside these ranges are clamped.
+ */
+typedef uint64_t fsrs_PackedCardState;
+
+/**
+ * A card's recomputed scheduling state, as passed to a `RescheduleCallback`.
+ */
+typedef struct fsrs_RescheduledCard {
+  int64_t card_id;
+  struct fsrs_MemoryState memory;
+  int32_t due_day;
+} fsrs_RescheduledCard;
+
+/**
+ * Receives one chunk of rescheduled cards. `cards` is only valid during the call.
+ */
+typedef void (*fsrs_RescheduleCallback)(void *user_data,
+                                        const struct fsrs_RescheduledCard *cards,
+                                        size_t len);
+
+/**
+ * The next cards to reschedule, as filled in by a `RescheduleSource`.
+ *
+ * Card `i` has the reviews `histories` gives it, the id `card_ids[i]` and its last review
+ * on `last_review_days[i]`; both arrays have `histories.num_cards` elements.
+ */
+typedef struct fsrs_RescheduleChunk {
+  struct fsrs_FsrsReviewHistories histories;
+  const int64_t *card_ids;
+  const int32_t *last_review_days;
+} fsrs_RescheduleChunk;
+
+/**
+ * Supplies the next chunk of cards to `fsrs_reschedule_stream`.
+ *
+ * Returns false once every card has been supplied. The chunk's arrays must stay valid
+ * until the source is called again or `fsrs_reschedule_stream` returns.
+ */
+typedef bool (*fsrs_RescheduleSource)(void *user_data, struct fsrs_RescheduleChunk *chunk);
+
+/**
+ * One review of the card at `card_index`, `elapsed_days` after its previous review.
+ */
+typedef struct fsrs_ReviewEvent {
+  size_t card_index;
+  uint32_t rating;
+  uint32_t elapsed_days;
+} fsrs_ReviewEvent;
+
+/**
+ * A request for the next states of one card, as placed in a schedule ring.
+ */
+typedef struct fsrs_ScheduleRequest {
+  uint64_t request_id;
+  struct fsrs_MemoryState memory;
+  float desired_retention;
+  uint32_t days_elapsed;
+} fsrs_ScheduleRequest;
+
+/**
+ * The answer to a `ScheduleRequest`. `status` is 0 on success; otherwise `next_states`
+ * is undefined.
+ */
+typedef struct fsrs_ScheduleResponse {
+  uint64_t request_id;
+  uint32_t status;
+  struct fsrs_NextStates next_states;
+} fsrs_ScheduleResponse;
+
+/**
+ * Settings for the review workload simulator.
+ *
+ * Start from `fsrs_simulation_config_default` so that fields added later keep their
+ * default values.
+ */
+typedef struct fsrs_SimulationConfig {
+  /**
+   * Number of cards in the simulated collection.
+   */
+  size_t deck_size;
+  /**
+   * Number of days to simulate.
+   */
+  size_t learn_span;
+  /**
+   * Daily study time budget in seconds.
+   */
+  float max_cost_perday;
+  /**
+   * Longest interval in days.
+   */
+  float max_ivl;
+  /**
+   * New cards introduced per day.
+   */
+  size_t learn_limit;
+  /**
+   * Reviews per day.
+   */
+  size_t review_limit;
+} fsrs_SimulationConfig;
+
+/**
+ * A snapshot of the library's performance counters.
+ *
+ * `new_handle` counts `fsrs_new`, `fsrs_new_from_snapshot` and `fsrs_snapshot_load`.
+ * `epochs` records one sample per training epoch of `fsrs_compute_parameters`.
+ */
+typedef struct fsrs_Stats {
+  struct fsrs_CallStats new_handle;
+  struct fsrs_CallStats next_states;
+  struct fsrs_CallStats item_new;
+  struct fsrs_CallStats compute_parameters;
+  struct fsrs_CallStats epochs;
+} fsrs_Stats;
+
+/**
+ * Options for `fsrs_compute_parameters_with_config`.
+ *
+ * Start from `fsrs_training_config_default` so that fields added later keep their
+ * default values.
+ *
+ * The fsrs crate fixes the optimizer's batch size, epoch count and learning rate, so
+ * training time is traded for accuracy at the level of the train set instead: with
+ * `early_stopping_tolerance` set, training runs on growing subsets of the items and
+ * stops once a larger subset no longer improves the loss.
+ */
+typedef struct fsrs_TrainingConfig {
+  /**
+   * Number of threads the training backend may use. Training runs on a dedicated pool
+   * of exactly this many workers, so concurrent jobs do not share or oversubscribe
+   * threads. 0 uses the shared pool (see `fsrs_set_num_threads`).
+   */
+  size_t num_threads;
+  /**
+   * Whether to fit the short-term (same-day review) parameters. Defaults to true.
+   */
+  bool enable_short_term;
+  /**
+   * Number of relearning steps the collection uses, which the short-term parameters
+   * are fitted against. Negative leaves it to the trainer. Defaults to -1.
+   */
+  int32_t num_relearning_steps;
+  /**
+   * Stops training early once the loss plateaus. Training then runs on 1/8 and then
+   * 1/4 of the items, scoring each result by log loss on a fixed held-out tenth. If
+   * the second improved on the first by less than this fraction, the better of the
+   * two is kept, for about a third of the items a single run trains on; otherwise
+   * training runs on every item as usual, about 1.35 times a single run in all. 0
+   * disables it, as does a train set of fewer than 10 000 items. Defaults to 0.
+   */
+  float early_stopping_tolerance;
+} fsrs_TrainingConfig;
+
+/**
+ * Caller-provided arrays receiving a per-day workload forecast.
+ *
+ * Each non-NULL array must hold `len` elements; day `d` of the simulation is written to
+ * index `d` for `d < min(len, learn_span)`. Values are averaged over all runs.
+ */
+typedef struct fsrs_WorkloadForecast {
+  /**
+   * Reviews of previously learned cards.
+   */
+  float *reviews;
+  /**
+   * Newly introduced cards.
+   */
+  float *learned;
+  /**
+   * Expected number of memorized cards at the end of the day.
+   */
+  float *memorized;
+  /**
+   * Study time in seconds.
+   */
+  float *cost;
+  size_t len;
+} fsrs_WorkloadForecast;
+
+/**
+ * Applies a stream of review events to card states in place.
+ *
+ * `states[i]` holds card `i`'s memory state and interval; a card with zero stability
+ * is treated as new. Each event moves its card to the state for the rating given, and
+ * the interval is recomputed for `desired_retention`. Unlike `fsrs_next_states`, only
+ * the chosen outcome is computed. Events for the same card are applied in stream order;
+ * different cards are processed in parallel on the shared pool.
+ *
+ * Returns the number of events skipped because the card index or rating was invalid
+ * or the model failed; later events for that card still apply.
  *
  * # Safety
  *
  * The `fsrs` pointer must be a valid pointer to an FSRS instance.
- * The `train_set` pointer must be a valid pointer to an array of FSRSItem.
+ * The `states` pointer must be a valid pointer to an array of ItemState with `num_cards` elements.
+ * The `events` pointer must be a valid pointer to an array of ReviewEvent with `num_events` elements.
  */
-float *fsrs_compute_parameters(const struct fsrs_FSRS *fsrs, struct fsrs_FsrsItems *train_set);
+size_t fsrs_apply_reviews(const struct fsrs_FSRS *fsrs,
+                          struct fsrs_ItemState *states,
+                          size_t num_cards,
+                          const struct fsrs_ReviewEvent *events,
+                          size_t num_events,
+                          float desired_retention);
 
 /**
- * Frees the memory allocated for an FSRS instance.
+ * Assigns fuzzed, load-balanced due days to a batch of cards.
+ *
+ * Card `i` was last reviewed on `last_review_days[i]` and should be shown again after
+ * `intervals[i]` days, e.g. an interval from `fsrs_next_states`. Its interval is widened
+ * to Anki's fuzz range (about ±5% for long intervals; intervals below 2.5 days are only
+ * rounded), and the card is placed on the day in that window with the fewest cards
+ * in `histogram`, ties broken pseudo-randomly from `seed`. The histogram is updated as
+ * cards are placed, so later cards in the batch see earlier ones. Placing a card takes
+ * time logarithmic in the histogram's span, however wide its window.
+ *
+ * Intervals are capped at 36500 days. A card whose interval is NaN
+ * or infinite is not assigned, and its element of `due_days` is left unchanged.
+ * Returns the number of cards assigned.
  *
  * # Safety
  *
- * The `fsrs` pointer must be a valid pointer to an FSRS instance created by `fsrs_new`.
+ * The `histogram` pointer must be a valid pointer to a DueHistogram instance.
+ * The `intervals`, `last_review_days` and `due_days` pointers must be valid pointers to arrays with `len` elements.
  */
-void fsrs_free(const struct fsrs_FSRS *fsrs);
+size_t fsrs_assign_due_days(struct fsrs_DueHistogram *histogram,
+                            const float *intervals,
+                            const int32_t *last_review_days,
+                            int32_t *due_days,
+                            size_t len,
+                            uint64_t seed);
 
 /**
- * Frees the memory allocated for an FSRSItem instance.
+ * Packs card states into their compact form.
+ *
+ * Returns the number of states that had a field clamped; see `fsrs_PackedCardState`.
  *
  * # Safety
  *
- * The `item` pointer must be a valid pointer to an FSRSItem instance created by `fsrs_item_new`.
+ * The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
+ * The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
  */
-void fsrs_item_free(struct fsrs_FSRSItem *item);
+size_t fsrs_card_states_pack(const struct fsrs_CardState *states,
+                             fsrs_PackedCardState *packed,
+                             size_t len);
 
 /**
- * Creates a new FSRSItem instance.
+ * Unpacks compact card states.
  *
  * # Safety
  *
- * The `reviews` pointer must be a valid pointer to an array of FSRSReview.
+ * The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+ * The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
  */
-struct fsrs_FSRSItem *fsrs_item_new(struct fsrs_FsrsReviews *reviews);
+void fsrs_card_states_unpack(const fsrs_PackedCardState *packed,
+                             struct fsrs_CardState *states,
+                             size_t len);
 
 /**
- * Frees the memory allocated for a MemoryState instance.
+ * Returns views of the store's columns.
  *
  * # Safety
  *
- * The `memory_state` pointer must be a valid pointer to a MemoryState instance created by `fsrs_memory_state_new`.
+ * The `store` pointer must be a valid pointer to a CardStore instance.
  */
-void fsrs_memory_state_free(struct fsrs_MemoryState *memory_state);
+struct fsrs_CardStoreColumns fsrs_card_store_columns(const struct fsrs_CardStore *store);
 
 /**
- * Creates a new MemoryState instance.
+ * Finds the cards due on or before `today`.
+ *
+ * Writes the indices of the first `capacity` due cards, in ascending order, to
+ * `indices` and returns the total number of due cards, so a call with a capacity of
+ * zero only counts them. The scan compares due days in blocks of 64 without branching
+ * and only visits set bits of each block's mask.
+ *
+ * # Safety
+ *
+ * The `store` pointer must be a valid pointer to a CardStore instance.
+ * The `indices` pointer must be NULL or a valid pointer to an array of size_t with `capacity` elements.
  */
-struct fsrs_MemoryState *fsrs_memory_state_new(float stability, float difficulty);
+size_t fsrs_card_store_due(const struct fsrs_CardStore *store,
+                           int32_t today,
+                           size_t *indices,
+                           size_t capacity);
 
 /**
- * Creates a new FSRS instance.
+ * Frees the memory allocated for a CardStore instance.
  *
  * # Safety
  *
- * The `parameters` pointer must be a valid pointer to an array of f32 with `len` elements.
+ * The `store` pointer must be a valid pointer to a CardStore instance created by `fsrs_card_store_new`.
  */
-const struct fsrs_FSRS *fsrs_new(const float *parameters, size_t len);
+void fsrs_card_store_free(struct fsrs_CardStore *store);
 
 /**
- * Computes the next states for a card.
+ * Reads the state of the card at `index`. Returns false if the index is out of range.
+ *
+ * # Safety
+ *
+ * The `store` pointer must be a valid pointer to a CardStore instance.
+ * The `state` pointer must be a valid pointer to a CardState instance.
+ */
+bool fsrs_card_store_get(const struct fsrs_CardStore *store,
+                         size_t index,
+                         struct fsrs_CardState *state);
+
+/**
+ * Returns the number of cards in the store.
+ *
+ * # Safety
+ *
+ * The `store` pointer must be a valid pointer to a CardStore instance.
+ */
+size_t fsrs_card_store_len(const struct fsrs_CardStore *store);
+
+/**
+ * Creates an empty card store with room for `capacity` cards.
+ */
+struct fsrs_CardStore *fsrs_card_store_new(size_t capacity);
+
+/**
+ * Appends cards to the store and returns the index of the first one.
+ *
+ * If `len` is nonzero and either array is NULL, nothing is appended and 0 is returned.
+ *
+ * # Safety
+ *
+ * The `store` pointer must be a valid pointer to a CardStore instance.
+ * The `card_ids` pointer must be a valid pointer to an array of i64 with `len` elements.
+ * The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
+ */
+size_t fsrs_card_store_push(struct fsrs_CardStore *store,
+                            const int64_t *card_ids,
+                            const struct fsrs_CardState *states,
+                            size_t len);
+
+/**
+ * Applies a batch of reviews to the store in place.
+ *
+ * Card `indices[i]` is reviewed on `today` with `ratings[i]` (1 to 4) and becomes due
+ * once `desired_retention` is reached, at least one day later. If an index appears more
+ * than once, its reviews are applied in batch order, each from the state the previous
+ * one left; different cards are processed in parallel on the shared pool. Returns the
+ * number of reviews skipped because the index or rating was invalid or the model
+ * failed; later reviews of that card still apply.
  *
  * # Safety
  *
  * The `fsrs` pointer must be a valid pointer to an FSRS instance.
- * The `memory_state` pointer must be a valid pointer to a MemoryState instance.
+ * The `store` pointer must be a valid pointer to a CardStore instance.
+ * The `indices` pointer must be a valid pointer to an array of size_t with `len` elements.
+ * The `ratings` pointer must be a valid pointer to an array of u32 with `len` elements.
  */
-struct fsrs_NextStates *fsrs_next_states(const struct fsrs_FSRS *fsrs,
-                                         struct fsrs_MemoryState *memory_state,
-                                         float desired_retention,
-                                         uint32_t days_elapsed);
+size_t fsrs_card_store_review(const struct fsrs_FSRS *fsrs,
+                              struct fsrs_CardStore *store,
+                              const size_t *indices,
+                              const uint32_t *ratings,
+                              size_t len,
+                              int32_t today,
+                              float desired_retention);
 
 /**
- * Get the `again` state from NextStates.
+ * Advances memory-state checkpoints over reviews added since they were taken.
+ *
+ * `histories` holds each card's full history; only the reviews after the first
+ * `checkpoints[i].review_count` are replayed, starting from the checkpoint's memory
+ * state, so the result equals a full replay without its cost. Cards are processed in
+ * parallel on the shared pool.
+ *
+ * Returns the number of checkpoints left unchanged because they claim more reviews than
+ * the history holds or the model failed.
  *
  * # Safety
  *
- * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The `checkpoints` pointer must be a valid pointer to an array of MemoryCheckpoint with `histories->num_cards` elements.
  */
-struct fsrs_ItemState fsrs_next_states_again(const struct fsrs_NextStates *next_states);
+size_t fsrs_checkpoints_advance(const struct fsrs_FSRS *fsrs,
+                                const struct fsrs_FsrsReviewHistories *histories,
+                                struct fsrs_MemoryCheckpoint *checkpoints);
 
 /**
- * Get the `easy` state from NextStates.
+ * Spot-checks checkpoints against a full replay of each card's history.
+ *
+ * About `sample_size` cards, chosen pseudo-randomly from `seed`, are replayed from
+ * their first review, and their memory state must match the checkpoint exactly; a
+ * `sample_size` of at least the number of cards checks all of them. Days are not
+ * checked, as histories carry no absolute dates.
+ *
+ * Returns the number of sampled checkpoints that do not match.
  *
  * # Safety
  *
- * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The `checkpoints` pointer must be a valid pointer to an array of MemoryCheckpoint with `histories->num_cards` elements.
  */
-struct fsrs_ItemState fsrs_next_states_easy(const struct fsrs_NextStates *next_states);
+size_t fsrs_checkpoints_validate(const struct fsrs_FSRS *fsrs,
+                                 const struct fsrs_FsrsReviewHistories *histories,
+                                 const struct fsrs_MemoryCheckpoint *checkpoints,
+                                 size_t sample_size,
+                                 uint64_t seed);
 
 /**
- * Frees the memory allocated for a NextStates instance.
+ * Computes aggregate statistics of `len` cards on day `today`.
+ *
+ * Retrievability is evaluated on the forgetting curve of the handle's parameters, as
+ * of `today`. Cards are processed in parallel on the shared pool in a single pass, each
+ * task counting into its own fixed-size bins, which are summed at the end.
  *
  * # Safety
  *
- * The `next_states` pointer must be a valid pointer to a NextStates instance created by `fsrs_next_states`.
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `cards` pointer must be a valid pointer to an array of CardState with `len` elements.
+ * The `stats` pointer must be a valid pointer to a CollectionStats instance.
  */
-void fsrs_next_states_free(struct fsrs_NextStates *next_states);
+void fsrs_collection_stats(const struct fsrs_FSRS *fsrs,
+                           const struct fsrs_CardState *cards,
+                           size_t len,
+                           int32_t today,
+                           struct fsrs_CollectionStats *stats);
 
 /**
- * Get the `good` state from NextStates.
+ * Computes the parameters for a given train set.
+ *
+ * Writes the number of parameters to `len`, e.g. 21 for FSRS-6; pass both to `fsrs_new`
+ * to use them. Returns NULL, with `len` set to 0, if training fails.
  *
  * # Safety
  *
- * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `train_set` pointer must be a valid pointer to an array of FSRSItem.
+ * The `len` pointer must be a valid pointer to a size_t.
+ * The returned pointer must be freed with `fsrs_parameters_free`.
  */
-struct fsrs_ItemState fsrs_next_states_good(const struct fsrs_NextStates *next_states);
+float *fsrs_compute_parameters(const struct fsrs_FSRS *fsrs,
+                               struct fsrs_FsrsItems *train_set,
+                               size_t *len);
 
 /**
- * Get the `hard` state from NextStates.
+ * Estimates the peak heap memory, in bytes, of training on `num_items` items with
+ * `num_reviews` reviews between them.
+ *
+ * The estimate adds up the copies of the train set and the batch tensors training
+ * keeps alive at once, plus a fixed allowance for the model and thread pools, so it
+ * grows linearly in both counts. It is meant as an upper bound of `peak_bytes` from
+ * `fsrs_memory_usage` for the same training run, but its constants are counted from
+ * the structures involved rather than fitted to measured runs. examples/memory.c
+ * checks it on a few small train sets and prints how close it is; before admitting
+ * jobs to machines by it, measure train sets of the sizes they will see the same way,
+ * with a release build of the library with the `memory-tracking` feature. Memory the
+ * allocator itself holds on to is not included, so compare with `peak_rss_bytes` as
+ * well.
+ */
+size_t fsrs_compute_parameters_memory_estimate(size_t num_items, size_t num_reviews);
+
+/**
+ * Computes the parameters for a given train set with explicit training options.
+ *
+ * Behaves like `fsrs_compute_parameters`, including how the parameter count is
+ * reported through `len`.
  *
  * # Safety
  *
- * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `train_set` pointer must be a valid pointer to an array of FSRSItem.
+ * The `config` pointer must be a valid pointer to a TrainingConfig instance.
+ * The `len` pointer must be a valid pointer to a size_t.
+ * The returned pointer must be freed with `fsrs_parameters_free`.
  */
-struct fsrs_ItemState fsrs_next_states_hard(const struct fsrs_NextStates *next_states);
+float *fsrs_compute_parameters_with_config(const struct fsrs_FSRS *fsrs,
+                                           struct fsrs_FsrsItems *train_set,
+                                           const struct fsrs_TrainingConfig *config,
+                                           size_t *len);
 
 /**
- * Frees the memory allocated for the parameters.
+ * Records cards that are already due on `due_days`, e.g. the rest of the collection.
  *
  * # Safety
  *
- * The `params` pointer must be a valid pointer to the parameters created by `fsrs_compute_parameters`.
+ * The `histogram` pointer must be a valid pointer to a DueHistogram instance.
+ * The `due_days` pointer must be a valid pointer to an array of i32 with `len` elements.
  */
-void fsrs_parameters_free(float *params);
+void fsrs_due_histogram_add(struct fsrs_DueHistogram *histogram,
+                            const int32_t *due_days,
+                            size_t len);
 
 /**
- * Frees the memory allocated for an FSRSReview instance.
+ * Returns the number of cards recorded as due on `day`.
  *
  * # Safety
  *
- * The `review` pointer must be a valid pointer to an FSRSReview instance created by `fsrs_review_new`.
+ * The `histogram` pointer must be a valid pointer to a DueHistogram instance.
  */
-void fsrs_review_free(struct fsrs_FSRSReview *review);
+uint32_t fsrs_due_histogram_count(const struct fsrs_DueHistogram *histogram, int32_t day);
 
 /**
- * Creates a new FSRSReview instance.
+ * Frees the memory allocated for a DueHistogram instance.
+ *
+ * # Safety
+ *
+ * The `histogram` pointer must be a valid pointer to a DueHistogram instance created by `fsrs_due_histogram_new`.
  */
-struct fsrs_FSRSReview *fsrs_review_new(uint32_t rating, uint32_t delta_t);
+void fsrs_due_histogram_free(struct fsrs_DueHistogram *histogram);
+
+/**
+ * Creates an empty due histogram starting at `first_day`.
+ */
+struct fsrs_DueHistogram *fsrs_due_histogram_new(int32_t first_day);
+
+/**
+ * Frees the memory allocated for an FSRS instance.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance created by `fsrs_new`.
+ */
+void fsrs_free(const struct fsrs_FSRS *fsrs);
+
+/**
+ * Returns the FSRS instance for the given parameters, creating it on first use.
+ *
+ * The cache may be used from several threads at once. NULL or empty parameters select
+ * the default parameters and share their handle. Returns NULL if the parameters are
+ * invalid.
+ *
+ * # Safety
+ *
+ * The `cache` pointer must be a valid pointer to a HandleCache instance.
+ * The `parameters` pointer must be NULL or a valid pointer to an array of f32 with `len` elements.
+ * The returned handle must be freed with `fsrs_handle_cache_release`, not `fsrs_free`.
+ */
+const struct fsrs_FSRS *fsrs_handle_cache_acquire(const struct fsrs_HandleCache *cache,
+                                                  const float *parameters,
+                                                  size_t len);
+
+/**
+ * Frees the memory allocated for a handle cache.
+ *
+ * Handles acquired from the cache stay valid until they are released.
+ *
+ * # Safety
+ *
+ * The `cache` pointer must be a valid pointer to a HandleCache instance created by `fsrs_handle_cache_new`.
+ */
+void fsrs_handle_cache_free(struct fsrs_HandleCache *cache);
+
+/**
+ * Creates a new handle cache.
+ *
+ * `capacity` is the number of handles kept alive. Handles in use are never evicted, so
+ * the cache grows past `capacity` while more than that are held.
+ */
+struct fsrs_HandleCache *fsrs_handle_cache_new(size_t capacity);
+
+/**
+ * Releases an FSRS instance acquired from a handle cache.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer returned by `fsrs_handle_cache_acquire`,
+ * and must not be used after this call.
+ */
+void fsrs_handle_cache_release(const struct fsrs_FSRS *fsrs);
+
+/**
+ * Returns the default history filter.
+ */
+struct fsrs_HistoryFilter fsrs_history_filter_default(void);
+
+/**
+ * Frees the memory allocated for an FSRSItem instance.
+ *
+ * # Safety
+ *
+ * The `item` pointer must be a valid pointer to an FSRSItem instance created by `fsrs_item_new`.
+ */
+void fsrs_item_free(struct fsrs_FSRSItem *item);
+
+/**
+ * Creates a new FSRSItem instance.
+ *
+ * # Safety
+ *
+ * The `reviews` pointer must be a valid pointer to an array of FSRSReview.
+ */
+struct fsrs_FSRSItem *fsrs_item_new(struct fsrs_FsrsReviews *reviews);
+
+/**
+ * Frees a training set created by `fsrs_train_set_from_histories` or
+ * `fsrs_train_set_sample_from_histories`.
+ *
+ * # Safety
+ *
+ * The `items` pointer must be a valid pointer to a FsrsItems instance created by `fsrs_train_set_from_histories` or `fsrs_train_set_sample_from_histories`.
+ */
+void fsrs_items_free(struct fsrs_FsrsItems *items);
+
+/**
+ * Appends reviews to the journal with a single write.
+ *
+ * Only the new records are written; the data reaches the operating system before the
+ * call returns but is not synced to disk. Returns false, recording none of the reviews,
+ * if the write fails.
+ *
+ * # Safety
+ *
+ * The `journal` pointer must be a valid pointer to a Journal instance.
+ * The `reviews` pointer must be a valid pointer to an array of JournalReview with `len` elements.
+ */
+bool fsrs_journal_append(struct fsrs_Journal *journal,
+                         const struct fsrs_JournalReview *reviews,
+                         size_t len);
+
+/**
+ * Writes every review to a new snapshot and empties the journal file.
+ *
+ * The snapshot is written to a temporary file and synced before it replaces the old
+ * one, and the directory is synced after the rename, so a crash never leaves a partial
+ * snapshot behind or loses the new one. Returns false if writing
+ * fails; the journal then keeps its records.
+ *
+ * # Safety
+ *
+ * The `journal` pointer must be a valid pointer to a Journal instance.
+ */
+bool fsrs_journal_compact(struct fsrs_Journal *journal);
+
+/**
+ * Returns every review in the journal, grouped by card in the order cards first appeared.
+ *
+ * The arrays are owned by the journal and stay valid until the next call that appends
+ * to, compacts or frees it.
+ *
+ * # Safety
+ *
+ * The `journal` pointer must be a valid pointer to a Journal instance.
+ */
+struct fsrs_JournalContents fsrs_journal_contents(struct fsrs_Journal *journal);
+
+/**
+ * Closes a journal and frees its memory.
+ *
+ * # Safety
+ *
+ * The `journal` pointer must be a valid pointer to a Journal instance created by `fsrs_journal_open`.
+ */
+void fsrs_journal_free(struct fsrs_Journal *journal);
+
+/**
+ * Opens a review journal, creating its file if needed.
+ *
+ * Loads the snapshot at `snapshot_path`, if there is one, and the reviews appended to
+ * the journal at `journal_path` since it was written. A torn record at the end of the
+ * journal, left by a crash during an append, is discarded, and a journal whose header
+ * was only partly written is treated as empty and written again. Returns NULL if either
+ * file cannot be read or is not in the expected format.
+ *
+ * # Safety
+ *
+ * The `journal_path` and `snapshot_path` pointers must be valid pointers to null-terminated UTF-8 strings.
+ */
+struct fsrs_Journal *fsrs_journal_open(const char *journal_path, const char *snapshot_path);
+
+/**
+ * Returns the number of reviews in the journal file that are not yet in the snapshot.
+ *
+ * # Safety
+ *
+ * The `journal` pointer must be a valid pointer to a Journal instance.
+ */
+size_t fsrs_journal_pending(const struct fsrs_Journal *journal);
+
+/**
+ * Starts a new peak measurement from the memory currently allocated.
+ */
+void fsrs_memory_reset_peak(void);
+
+/**
+ * Frees the memory allocated for a MemoryState instance.
+ *
+ * # Safety
+ *
+ * The `memory_state` pointer must be a valid pointer to a MemoryState instance created by `fsrs_memory_state_new`.
+ */
+void fsrs_memory_state_free(struct fsrs_MemoryState *memory_state);
+
+/**
+ * Creates a new MemoryState instance.
+ */
+struct fsrs_MemoryState *fsrs_memory_state_new(float stability, float difficulty);
+
+/**
+ * Converts the SM-2 state of many cards into FSRS memory states.
+ *
+ * For card `i`, `ease_factors[i]` is the SM-2 ease factor (2.5 for 250%),
+ * `intervals[i]` the current interval in days and `sm2_retentions[i]` the retention
+ * the card was scheduled for. Cards are converted in parallel on the shared pool.
+ *
+ * Returns the number of cards that could not be converted; their memory state is set
+ * to zero stability and difficulty. If any array, including `memory_states`, is NULL,
+ * no card is converted and `len` is returned.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `ease_factors`, `intervals` and `sm2_retentions` pointers must be valid pointers to arrays of f32 with `len` elements.
+ * The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+ */
+size_t fsrs_memory_states_from_sm2(const struct fsrs_FSRS *fsrs,
+                                   const float *ease_factors,
+                                   const float *intervals,
+                                   const float *sm2_retentions,
+                                   struct fsrs_MemoryState *memory_states,
+                                   size_t len);
+
+/**
+ * Enables or disables counting of the library's heap allocations.
+ *
+ * Counting needs the library to be built with the `memory-tracking` Cargo feature,
+ * which makes it allocate through a counting wrapper around the system allocator;
+ * without it, this returns false and the counts stay at zero. Tracking is disabled by
+ * default; while disabled, each allocation only pays for one relaxed atomic load.
+ * Enabling resets all counts. Only memory allocated after enabling is counted, so
+ * enable tracking before the work to be measured.
+ */
+bool fsrs_memory_tracking_enable(bool enabled);
+
+/**
+ * Copies the current allocation counts into `usage`.
+ *
+ * Counts cover the whole process's use of the library rather than one handle or job,
+ * since training and batch calls spread their allocations over the shared worker
+ * threads. To measure one job, run it alone, call `fsrs_memory_reset_peak` before it
+ * starts and read `peak_bytes` when it is done.
+ *
+ * # Safety
+ *
+ * The `usage` pointer must be a valid pointer to a MemoryUsage instance.
+ */
+void fsrs_memory_usage(struct fsrs_MemoryUsage *usage);
+
+/**
+ * Creates a new FSRS instance.
+ *
+ * The returned handle may be shared between threads; see `fsrs_FSRS`.
+ *
+ * # Safety
+ *
+ * The `parameters` pointer must be a valid pointer to an array of f32 with `len` elements.
+ */
+const struct fsrs_FSRS *fsrs_new(const float *parameters, size_t len);
+
+/**
+ * Creates an FSRS instance from a snapshot, e.g. one mapped into memory with `mmap`.
+ *
+ * Returns NULL if the snapshot is truncated, corrupt, from another format version or
+ * holds invalid parameters.
+ *
+ * # Safety
+ *
+ * The `buffer` pointer must be a valid pointer to `len` readable bytes.
+ */
+const struct fsrs_FSRS *fsrs_new_from_snapshot(const uint8_t *buffer, size_t len);
+
+/**
+ * Computes the next states for a card.
+ *
+ * Safe to call concurrently from several threads on the same `fsrs` handle.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `memory_state` pointer must be a valid pointer to a MemoryState instance.
+ */
+struct fsrs_NextStates *fsrs_next_states(const struct fsrs_FSRS *fsrs,
+                                         struct fsrs_MemoryState *memory_state,
+                                         float desired_retention,
+                                         uint32_t days_elapsed);
+
+/**
+ * Get the `again` state from NextStates.
+ *
+ * # Safety
+ *
+ * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ */
+struct fsrs_ItemState fsrs_next_states_again(const struct fsrs_NextStates *next_states);
+
+/**
+ * Computes the next states of many cards at once.
+ *
+ * Card `i` has memory state `memory_states[i]`, or is new if its stability is zero,
+ * and was last reviewed `days_elapsed[i]` days ago. Cards are processed in parallel on
+ * the shared pool. Returns the number of cards the model failed on; their entry in
+ * `next_states` is left unchanged.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+ * The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+ * The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+ */
+size_t fsrs_next_states_batch(const struct fsrs_FSRS *fsrs,
+                              const struct fsrs_MemoryState *memory_states,
+                              const uint32_t *days_elapsed,
+                              float desired_retention,
+                              struct fsrs_NextStates *next_states,
+                              size_t len);
+
+/**
+ * Computes the next states of many cards scheduled with different parameter sets.
+ *
+ * Like `fsrs_next_states_batch`, but card `i` is scheduled with
+ * `handles[parameter_indices[i]]`, e.g. the handle of its deck or user. Cards are
+ * grouped by parameter set, so cards that share one are processed contiguously, and
+ * the groups are processed in parallel on the shared pool. Returns the number of cards
+ * the model failed on or whose parameter index is out of range or names a null handle;
+ * their entry in `next_states` is left unchanged.
+ *
+ * # Safety
+ *
+ * The `handles` pointer must be a valid pointer to an array of `num_handles` pointers, each null or a valid pointer to an FSRS instance.
+ * The `parameter_indices` pointer must be a valid pointer to an array of u32 with `len` elements.
+ * The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+ * The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+ * The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+ */
+size_t fsrs_next_states_batch_multi(const struct fsrs_FSRS * const *handles,
+                                    size_t num_handles,
+                                    const uint32_t *parameter_indices,
+                                    const struct fsrs_MemoryState *memory_states,
+                                    const uint32_t *days_elapsed,
+                                    float desired_retention,
+                                    struct fsrs_NextStates *next_states,
+                                    size_t len);
+
+/**
+ * Get the `easy` state from NextStates.
+ *
+ * # Safety
+ *
+ * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ */
+struct fsrs_ItemState fsrs_next_states_easy(const struct fsrs_NextStates *next_states);
+
+/**
+ * Frees the memory allocated for a NextStates instance.
+ *
+ * # Safety
+ *
+ * The `next_states` pointer must be a valid pointer to a NextStates instance created by `fsrs_next_states`.
+ */
+void fsrs_next_states_free(struct fsrs_NextStates *next_states);
+
+/**
+ * Get the `good` state from NextStates.
+ *
+ * # Safety
+ *
+ * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ */
+struct fsrs_ItemState fsrs_next_states_good(const struct fsrs_NextStates *next_states);
+
+/**
+ * Get the `hard` state from NextStates.
+ *
+ * # Safety
+ *
+ * The `next_states` pointer must be a valid pointer to a NextStates instance.
+ */
+struct fsrs_ItemState fsrs_next_states_hard(const struct fsrs_NextStates *next_states);
+
+/**
+ * Computes the next states of many packed cards reviewed on `today`.
+ *
+ * Cards are processed in parallel on the shared pool. Returns the number of cards the
+ * model failed on; their entry in `next_states` is left unchanged.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+ * The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+ */
+size_t fsrs_next_states_packed(const struct fsrs_FSRS *fsrs,
+                               const fsrs_PackedCardState *packed,
+                               int32_t today,
+                               float desired_retention,
+                               struct fsrs_NextStates *next_states,
+                               size_t len);
+
+/**
+ * Finds the desired retention that minimizes study time per memorized card.
+ *
+ * Every retention from `min_retention` to `max_retention` in steps of 0.01 is simulated
+ * `num_runs` times, with all simulations running in parallel on the shared pool, and the
+ * one with the lowest average total cost per card memorized at the end is returned.
+ * Returns NaN if the range is empty or not finite, a simulation failed, or more than
+ * 65536 simulations would run.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `config` pointer must be a valid pointer to a SimulationConfig instance.
+ */
+float fsrs_optimal_retention(const struct fsrs_FSRS *fsrs,
+                             const struct fsrs_SimulationConfig *config,
+                             float min_retention,
+                             float max_retention,
+                             uint64_t seed,
+                             size_t num_runs);
+
+/**
+ * Frees the memory allocated for the parameters.
+ *
+ * # Safety
+ *
+ * The `params` pointer must be a valid pointer to the parameters created by `fsrs_compute_parameters`,
+ * and `len` the count it reported.
+ */
+void fsrs_parameters_free(float *params, size_t len);
+
+/**
+ * Recomputes the memory state and due day of every card after a parameter change.
+ *
+ * Each card's history is replayed from scratch, and the card is then scheduled
+ * `round(interval)` days (at least one) after `last_review_days[i]`, where the interval
+ * reaches `desired_retention`. Work proceeds in chunks: while the shared pool replays
+ * one chunk in parallel, the previous one is handed to `callback` on the calling
+ * thread, so memory use stays bounded whatever the collection size. Cards are reported
+ * in input order. To supply the histories chunk by chunk instead of all at once, use
+ * `fsrs_reschedule_stream`.
+ *
+ * Returns the number of cards skipped because they have no reviews or their history
+ * could not be replayed. If `card_ids`, `last_review_days` or an array of `histories`
+ * is NULL, no card is rescheduled and `num_cards` is returned.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The `card_ids` and `last_review_days` pointers must be valid pointers to arrays with `num_cards` elements.
+ * The `callback` must be safe to call with `user_data`.
+ */
+size_t fsrs_reschedule(const struct fsrs_FSRS *fsrs,
+                       const struct fsrs_FsrsReviewHistories *histories,
+                       const int64_t *card_ids,
+                       const int32_t *last_review_days,
+                       float desired_retention,
+                       fsrs_RescheduleCallback callback,
+                       void *user_data);
+
+/**
+ * Like `fsrs_reschedule`, but takes the cards chunk by chunk from `source`.
+ *
+ * The caller never needs all histories in memory at once: `source` is called on the
+ * calling thread for the next chunk only after the previous one has been replayed, so
+ * it may reuse its buffers, e.g. to read the next cards from a database. While a chunk
+ * is replayed, the previous one is handed to `callback`. Cards are reported in the
+ * order they were supplied.
+ *
+ * Returns the number of cards skipped because they have no reviews or their history
+ * could not be replayed, including every card of a chunk that has a NULL array.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `source` must be safe to call with `user_data`, and fill in a valid RescheduleChunk whenever it returns true.
+ * The `callback` must be safe to call with `user_data`.
+ */
+size_t fsrs_reschedule_stream(const struct fsrs_FSRS *fsrs,
+                              fsrs_RescheduleSource source,
+                              float desired_retention,
+                              fsrs_RescheduleCallback callback,
+                              void *user_data);
+
+/**
+ * Computes the probability of recall of many cards.
+ *
+ * Card `i` has memory state `memory_states[i]` and was last reviewed `days_elapsed[i]`
+ * days ago. The forgetting curve's decay is taken from the handle's parameters. A new
+ * card, with zero stability, has a retrievability of zero.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+ * The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+ * The `retrievabilities` pointer must be a valid pointer to an array of f32 with `len` elements.
+ */
+void fsrs_retrievability_batch(const struct fsrs_FSRS *fsrs,
+                               const struct fsrs_MemoryState *memory_states,
+                               const uint32_t *days_elapsed,
+                               float *retrievabilities,
+                               size_t len);
+
+/**
+ * Frees the memory allocated for an FSRSReview instance.
+ *
+ * # Safety
+ *
+ * The `review` pointer must be a valid pointer to an FSRSReview instance created by `fsrs_review_new`.
+ */
+void fsrs_review_free(struct fsrs_FSRSReview *review);
+
+/**
+ * Removes manual reschedules, duplicate answers and implausible intervals from review
+ * histories before training, according to `filter`.
+ *
+ * The histories that remain are written to `reviews` and `offsets` in the same layout,
+ * keeping every card at its index, so a dropped card becomes an empty history. Cards
+ * are filtered in parallel on the shared pool in one pass over the input, and the
+ * output is then compacted. Returns how much each rule dropped;
+ * `offsets[num_cards]` is the number of reviews kept.
+ *
+ * # Safety
+ *
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The `filter` pointer must be a valid pointer to a HistoryFilter instance.
+ * The `reviews` pointer must be a valid pointer to an array of FSRSReview with `histories->offsets[num_cards]` elements that does not overlap the input.
+ * The `offsets` pointer must be a valid pointer to an array of size_t with `histories->num_cards + 1` elements.
+ */
+struct fsrs_HistoryFilterCounts fsrs_review_histories_filter(const struct fsrs_FsrsReviewHistories *histories,
+                                                             const struct fsrs_HistoryFilter *filter,
+                                                             struct fsrs_FSRSReview *reviews,
+                                                             size_t *offsets);
+
+/**
+ * Fills `reviews` with the rating and `delta_t` of every review in `logs`.
+ *
+ * Days are counted in local time, given as `utc_offset_seconds` east of UTC, and start
+ * at `day_rollover_hour` (e.g. 4 to count a review at 2am towards the previous day).
+ * `delta_t` is the number of day boundaries since the card's previous review: 0 for a
+ * card's first review, for same-day reviews and for out-of-order timestamps. No libc
+ * time functions are called, and the per-review loop is branch-free.
+ *
+ * Returns false, leaving `reviews` untouched, if `day_rollover_hour` is 24 or more.
+ *
+ * # Safety
+ *
+ * The `logs` pointer must be a valid pointer to a FsrsReviewLogs instance whose arrays hold `offsets[num_cards]` reviews.
+ * The `reviews` pointer must be a valid pointer to an array of FSRSReview with `offsets[num_cards]` elements.
+ */
+bool fsrs_review_histories_from_logs(const struct fsrs_FsrsReviewLogs *logs,
+                                     int32_t utc_offset_seconds,
+                                     uint32_t day_rollover_hour,
+                                     struct fsrs_FSRSReview *reviews);
+
+/**
+ * Creates a new FSRSReview instance.
+ */
+struct fsrs_FSRSReview *fsrs_review_new(uint32_t rating, uint32_t delta_t);
+
+/**
+ * Applies one review per card to packed states in place.
+ *
+ * Card `i` is reviewed on `today` with `ratings[i]` (1 to 4) and becomes due once
+ * `desired_retention` is reached, at least one day later. Cards are processed in
+ * parallel on the shared pool. Returns the number of cards left unchanged because their
+ * rating was invalid or the model failed.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+ * The `ratings` pointer must be a valid pointer to an array of u32 with `len` elements.
+ */
+size_t fsrs_review_packed(const struct fsrs_FSRS *fsrs,
+                          fsrs_PackedCardState *packed,
+                          const uint32_t *ratings,
+                          int32_t today,
+                          float desired_retention,
+                          size_t len);
+
+/**
+ * Lays out an empty schedule ring in `memory`.
+ *
+ * A schedule ring lets one client thread and one server thread exchange scheduling
+ * requests through memory they share, typically a `shm_open` region mapped by two
+ * processes. Both sides only read and write the shared slots and atomic indices, so
+ * submitting and polling make no system calls. `memory` must be 64-byte aligned, and
+ * `memory_len`, the length of the mapping, must be at least
+ * `fsrs_schedule_ring_size(capacity)`; other processes may use the ring once this
+ * returns. Returns false if `capacity` is not a power of two or `memory` is misaligned
+ * or too short. The other functions take each process's own mapping length, check the
+ * ring's header against it before each use and do nothing, returning 0, if it has been
+ * corrupted.
+ *
+ * # Safety
+ *
+ * The `memory` pointer must be a valid pointer to `memory_len` writable bytes that no other thread
+ * uses during the call.
+ */
+bool fsrs_schedule_ring_init(void *memory, size_t memory_len, size_t capacity);
+
+/**
+ * Takes finished responses from the ring; client side.
+ *
+ * Copies up to `capacity` responses, in request order, to `responses` and returns how
+ * many were copied. Only one thread may poll a ring.
+ *
+ * # Safety
+ *
+ * The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+ * The `responses` pointer must be a valid pointer to an array of ScheduleResponse with `capacity` elements.
+ */
+size_t fsrs_schedule_ring_poll(void *memory,
+                               size_t memory_len,
+                               struct fsrs_ScheduleResponse *responses,
+                               size_t capacity);
+
+/**
+ * Answers pending requests in the ring; server side.
+ *
+ * Takes up to `max_batch` requests, or as many as there is room for responses, computes
+ * their next states as one batch, in parallel on the shared pool when it is large, and
+ * publishes the responses. Returns the number of requests answered, 0 if none were
+ * pending. Only one thread may serve a ring.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+ */
+size_t fsrs_schedule_ring_serve(const struct fsrs_FSRS *fsrs,
+                                void *memory,
+                                size_t memory_len,
+                                size_t max_batch);
+
+/**
+ * Returns the number of bytes a schedule ring with `capacity` slots per direction needs,
+ * or 0 if `capacity` is not a power of two.
+ */
+size_t fsrs_schedule_ring_size(size_t capacity);
+
+/**
+ * Places requests in the ring; client side.
+ *
+ * Returns how many of `requests`, from the start, were placed; fewer than `len` when
+ * the ring is full. Only one thread may submit to a ring.
+ *
+ * # Safety
+ *
+ * The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+ * The `requests` pointer must be a valid pointer to an array of ScheduleRequest with `len` elements.
+ */
+size_t fsrs_schedule_ring_submit(void *memory,
+                                 size_t memory_len,
+                                 const struct fsrs_ScheduleRequest *requests,
+                                 size_t len);
+
+/**
+ * Sets the number of threads in the shared pool used by the batch functions and by
+ * training without an explicit thread count.
+ *
+ * Must be called before any other function that uses the pool. Returns false if the
+ * pool has already been started.
+ */
+bool fsrs_set_num_threads(size_t num_threads);
+
+/**
+ * Simulates future reviews at `desired_retention` and writes a daily forecast.
+ *
+ * `num_runs` simulations with seeds `seed, seed + 1, ...` run in parallel on the shared
+ * pool and are averaged, so the result is the same for the same inputs on any machine.
+ * Returns false if the simulation failed or `num_runs` exceeds 65536, leaving `forecast`
+ * untouched.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `config` pointer must be a valid pointer to a SimulationConfig instance.
+ * The `forecast` pointer must be a valid pointer to a WorkloadForecast instance.
+ */
+bool fsrs_simulate(const struct fsrs_FSRS *fsrs,
+                   const struct fsrs_SimulationConfig *config,
+                   float desired_retention,
+                   uint64_t seed,
+                   size_t num_runs,
+                   const struct fsrs_WorkloadForecast *forecast);
+
+/**
+ * Returns the default simulation settings.
+ */
+struct fsrs_SimulationConfig fsrs_simulation_config_default(void);
+
+/**
+ * Creates an FSRS instance from a snapshot file, read with a single read.
+ *
+ * Returns NULL if the file cannot be read or does not hold a valid snapshot.
+ *
+ * # Safety
+ *
+ * The `path` pointer must be a valid pointer to a null-terminated UTF-8 string.
+ */
+const struct fsrs_FSRS *fsrs_snapshot_load(const char *path);
+
+/**
+ * Saves a snapshot of the handle to the file at `path`, replacing it.
+ *
+ * The snapshot is written to a temporary file and synced before it replaces the old
+ * one, and the directory is synced after the rename, so a crash leaves either the old
+ * snapshot or the new one. Returns false if the file cannot be written.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `path` pointer must be a valid pointer to a null-terminated UTF-8 string.
+ */
+bool fsrs_snapshot_save(const struct fsrs_FSRS *fsrs, const char *path);
+
+/**
+ * Returns the size in bytes of the handle's snapshot.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ */
+size_t fsrs_snapshot_size(const struct fsrs_FSRS *fsrs);
+
+/**
+ * Writes a versioned binary snapshot of the handle to `buffer`.
+ *
+ * The snapshot stores the exact bit pattern of every parameter, which fully determines
+ * the model, so a handle loaded from it on any host schedules identically. Returns the
+ * number of bytes written, or 0 if `capacity` is smaller than `fsrs_snapshot_size`.
+ *
+ * # Safety
+ *
+ * The `fsrs` pointer must be a valid pointer to an FSRS instance.
+ * The `buffer` pointer must be a valid pointer to `capacity` writable bytes.
+ */
+size_t fsrs_snapshot_write(const struct fsrs_FSRS *fsrs, uint8_t *buffer, size_t capacity);
+
+/**
+ * Enables or disables the performance counters.
+ *
+ * Counters are disabled by default; while disabled, instrumented calls only pay for one
+ * relaxed atomic load.
+ */
+void fsrs_stats_enable(bool enabled);
+
+/**
+ * Resets all counters to zero.
+ */
+void fsrs_stats_reset(void);
+
+/**
+ * Copies the current counters into `stats`.
+ *
+ * Counters are read individually, so a snapshot taken while other threads are making
+ * calls may be off by the calls in flight.
+ *
+ * # Safety
+ *
+ * The `stats` pointer must be a valid pointer to a Stats instance.
+ */
+void fsrs_stats_snapshot(struct fsrs_Stats *stats);
+
+/**
+ * Starts writing a Chrome trace-event JSON file to `path`.
+ *
+ * While tracing is active, `fsrs_compute_parameters` records spans for train set
+ * conversion, training and each epoch. The file can be opened in Perfetto or
+ * `chrome://tracing` after `fsrs_trace_stop`. Returns false if the file cannot be
+ * created or a trace is already active.
+ *
+ * # Safety
+ *
+ * The `path` pointer must be a valid pointer to a NUL-terminated string.
+ */
+bool fsrs_trace_start(const char *path);
+
+/**
+ * Stops tracing and finishes the trace file.
+ *
+ * Returns false if no trace was active or the file could not be written completely.
+ */
+bool fsrs_trace_stop(void);
+
+/**
+ * Builds a training set from many review histories.
+ *
+ * Every prefix of a card's history with at least two reviews and at least one positive
+ * `delta_t` becomes one FSRSItem, so a card with `n` reviews yields up to `n - 1` items.
+ * Cards are processed in parallel on the shared pool.
+ *
+ * # Safety
+ *
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The returned pointer must be freed with `fsrs_items_free`.
+ */
+struct fsrs_FsrsItems *fsrs_train_set_from_histories(const struct fsrs_FsrsReviewHistories *histories);
+
+/**
+ * Builds a training set of about `max_items` items sampled from many review histories.
+ *
+ * The full set is the one `fsrs_train_set_from_histories` would build. The sample keeps
+ * the full set's mix of history lengths and ratings of the predicted review: items are
+ * grouped by both, and each group contributes in proportion to its size. Within a
+ * group, items ending in one of their card's last `recent_reviews` reviews are kept
+ * before older ones, which are sampled pseudo-randomly from `seed`. The histories are
+ * read twice, once to count and once to sample, and only the sampled items are
+ * allocated. The sample size is the returned set's `len`, within a fraction of a
+ * percent of `max_items` for large sets; if the full set has no more than `max_items`
+ * items, all of them are kept.
+ *
+ * If `eligible_items` is not null, it receives the size of the full set.
+ *
+ * # Safety
+ *
+ * The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+ * The `eligible_items` pointer must be null or a valid pointer to a size_t.
+ * The returned pointer must be freed with `fsrs_items_free`.
+ */
+struct fsrs_FsrsItems *fsrs_train_set_sample_from_histories(const struct fsrs_FsrsReviewHistories *histories,
+                                                            size_t max_items,
+                                                            uint32_t recent_reviews,
+                                                            uint64_t seed,
+                                                            size_t *eligible_items);
+
+/**
+ * Returns the default training configuration.
+ */
+struct fsrs_TrainingConfig fsrs_training_config_default(void);
 
 #endif  /* _FSRS_H */
@@ -0,0 +1,37 @@
+#!/bin/bash
+# Prints the per-call cost of the single-card scheduling path when the benchmark
+# links the library dynamically, statically, and statically with cross-language LTO,
+# which allows the linker to inline across the C/Rust boundary. No gain from any of
+# them is assumed: run it on the target toolchain and compare the numbers it prints.
+#
+# The script is optional and not part of run.sh or CI. The LTO build needs clang and
+# lld from the same LLVM major version as rustc (`rustc -vV` shows it); without them,
+# only the dynamic and static builds are compared.
+set -euxo pipefail
+BENCH=bench/call_overhead.c
+CFLAGS="-O2 -Iinclude/ -Wall -Wextra -Wpedantic"
+LIBS="-lm -pthread -ldl"
+
+cargo build --release
+cc $CFLAGS -o call_overhead_dynamic $BENCH -L./target/release -lfsrs_rs_c $LIBS
+cc $CFLAGS -o call_overhead_static $BENCH ./target/release/libfsrs_rs_c.a $LIBS
+
+LTO=0
+if command -v clang >/dev/null && command -v ld.lld >/dev/null; then
+    LTO=1
+    RUSTFLAGS="-Clinker-plugin-lto" cargo rustc --release --lib --crate-type staticlib --target-dir target/lto
+    clang $CFLAGS -flto=thin -fuse-ld=lld -o call_overhead_lto $BENCH ./target/lto/release/libfsrs_rs_c.a $LIBS
+fi
+
+echo "dynamic (cdylib):"
+LD_LIBRARY_PATH=./target/release ./call_overhead_dynamic "$@"
+echo "static (staticlib):"
+./call_overhead_static "$@"
+rm call_overhead_dynamic call_overhead_static
+if [ "$LTO" = 1 ]; then
+    echo "static + cross-language LTO:"
+    ./call_overhead_lto "$@"
+    rm call_overhead_lto
+else
+    echo "static + cross-language LTO: skipped, clang or lld not found"
+fi
@@ -1,9 +1,9 @@
 #!/bin/bash
 set -euxo pipefail
-cargo build
+cargo build --features memory-tracking
 
 for f in ./examples/*.c; do
-    cc -o ${f%.c} $f -Iinclude/ -L./target/debug -lfsrs_rs_c -lm -Wall -Wextra -Wpedantic
+    cc -o ${f%.c} $f -Iinclude/ -L./target/debug -lfsrs_rs_c -lm -pthread -Wall -Wextra -Wpedantic
     LD_LIBRARY_PATH=./target/debug ./${f%.c}
     rm ${f%.c}
 done
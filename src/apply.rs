@@ -0,0 +1,105 @@
+use rayon::prelude::*;
+
+use crate::{FSRS, ItemState, slice, slice_mut};
+
+/// Cards per parallel task; a card usually has only a few events.
+const MIN_CARDS_PER_TASK: usize = 256;
+
+/// One review of the card at `card_index`, `elapsed_days` after its previous review.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct ReviewEvent {
+    pub card_index: usize,
+    pub rating: u32,
+    pub elapsed_days: u32,
+}
+
+/// Returns the state after `event`, computing only the chosen rating's transition.
+fn apply_review(
+    fsrs: &FSRS,
+    state: &ItemState,
+    event: &ReviewEvent,
+    desired_retention: f32,
+) -> Option<ItemState> {
+    if !(1..=4).contains(&event.rating) {
+        return None;
+    }
+    let starting_state = (state.memory.stability > 0.0).then(|| state.memory.into());
+    let item = fsrs::FSRSItem {
+        reviews: vec![fsrs::FSRSReview {
+            rating: event.rating,
+            delta_t: event.elapsed_days,
+        }],
+    };
+    let memory = fsrs.model.memory_state(item, starting_state).ok()?;
+    Some(ItemState {
+        interval: fsrs
+            .model
+            .next_interval(Some(memory.stability), desired_retention, 0),
+        memory: memory.into(),
+    })
+}
+
+/// Applies a stream of review events to card states in place.
+///
+/// `states[i]` holds card `i`'s memory state and interval; a card with zero stability
+/// is treated as new. Each event moves its card to the state for the rating given, and
+/// the interval is recomputed for `desired_retention`. Unlike `fsrs_next_states`, only
+/// the chosen outcome is computed. Events for the same card are applied in stream order;
+/// different cards are processed in parallel on the shared pool.
+///
+/// Returns the number of events skipped because the card index or rating was invalid
+/// or the model failed; later events for that card still apply.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `states` pointer must be a valid pointer to an array of ItemState with `num_cards` elements.
+/// The `events` pointer must be a valid pointer to an array of ReviewEvent with `num_events` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_apply_reviews(
+    fsrs: *const FSRS,
+    states: *mut ItemState,
+    num_cards: usize,
+    events: *const ReviewEvent,
+    num_events: usize,
+    desired_retention: f32,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let states = unsafe { slice_mut(states, num_cards) };
+    let events = unsafe { slice(events, num_events) };
+
+    let mut order: Vec<&ReviewEvent> = events
+        .iter()
+        .filter(|event| event.card_index < num_cards)
+        .collect();
+    let mut skipped = events.len() - order.len();
+    // A stable sort keeps each card's events in stream order.
+    order.sort_by_key(|event| event.card_index);
+
+    let card_states = &*states;
+    let updates: Vec<(usize, ItemState, usize)> = order
+        .chunk_by(|a, b| a.card_index == b.card_index)
+        .collect::<Vec<_>>()
+        .into_par_iter()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|card_events| {
+            let card_index = card_events[0].card_index;
+            let mut state = card_states[card_index].clone();
+            let mut skipped = 0;
+            for event in card_events {
+                match apply_review(fsrs, &state, event, desired_retention) {
+                    Some(next) => state = next,
+                    None => skipped += 1,
+                }
+            }
+            (card_index, state, skipped)
+        })
+        .collect();
+
+    for (card_index, state, card_skipped) in updates {
+        states[card_index] = state;
+        skipped += card_skipped;
+    }
+    skipped
+}
@@ -0,0 +1,150 @@
+use rayon::prelude::*;
+
+use crate::{FSRS, MemoryState, NextStates, slice, slice_mut};
+
+/// Cards per parallel task; a single card is far cheaper than a task switch.
+const MIN_CARDS_PER_TASK: usize = 1024;
+
+/// Computes the next states of many cards at once.
+///
+/// Card `i` has memory state `memory_states[i]`, or is new if its stability is zero,
+/// and was last reviewed `days_elapsed[i]` days ago. Cards are processed in parallel on
+/// the shared pool. Returns the number of cards the model failed on; their entry in
+/// `next_states` is left unchanged.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+/// The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+/// The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_next_states_batch(
+    fsrs: *const FSRS,
+    memory_states: *const MemoryState,
+    days_elapsed: *const u32,
+    desired_retention: f32,
+    next_states: *mut NextStates,
+    len: usize,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let memory_states = unsafe { slice(memory_states, len) };
+    let days_elapsed = unsafe { slice(days_elapsed, len) };
+    let next_states = unsafe { slice_mut(next_states, len) };
+    next_states
+        .par_iter_mut()
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|(i, next)| {
+            let memory = memory_states[i];
+            let memory = (memory.stability > 0.0).then(|| memory.into());
+            match fsrs
+                .model
+                .next_states(memory, desired_retention, days_elapsed[i])
+            {
+                Ok(states) => {
+                    *next = states.into();
+                    0
+                }
+                Err(_) => 1,
+            }
+        })
+        .sum()
+}
+
+/// Computes the next states of many cards scheduled with different parameter sets.
+///
+/// Like `fsrs_next_states_batch`, but card `i` is scheduled with
+/// `handles[parameter_indices[i]]`, e.g. the handle of its deck or user. Cards are
+/// grouped by parameter set, so cards that share one are processed contiguously, and
+/// the groups are processed in parallel on the shared pool. Returns the number of cards
+/// the model failed on or whose parameter index is out of range or names a null handle;
+/// their entry in `next_states` is left unchanged.
+///
+/// # Safety
+///
+/// The `handles` pointer must be a valid pointer to an array of `num_handles` pointers, each null or a valid pointer to an FSRS instance.
+/// The `parameter_indices` pointer must be a valid pointer to an array of u32 with `len` elements.
+/// The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+/// The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+/// The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_next_states_batch_multi(
+    handles: *const *const FSRS,
+    num_handles: usize,
+    parameter_indices: *const u32,
+    memory_states: *const MemoryState,
+    days_elapsed: *const u32,
+    desired_retention: f32,
+    next_states: *mut NextStates,
+    len: usize,
+) -> usize {
+    let handles: Vec<Option<&FSRS>> = unsafe { slice(handles, num_handles) }
+        .iter()
+        .map(|&handle| unsafe { handle.as_ref() })
+        .collect();
+    let parameter_indices = unsafe { slice(parameter_indices, len) };
+    let memory_states = unsafe { slice(memory_states, len) };
+    let days_elapsed = unsafe { slice(days_elapsed, len) };
+    let next_states = unsafe { slice_mut(next_states, len) };
+
+    // Cards in order of their parameter set, and in their original order within one.
+    let mut order: Vec<usize> = (0..len).collect();
+    order.sort_by_key(|&i| parameter_indices[i]);
+    let results: Vec<Option<fsrs::NextStates>> = order
+        .par_iter()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|&i| {
+            let fsrs = (*handles.get(parameter_indices[i] as usize)?)?;
+            let memory = memory_states[i];
+            let memory = (memory.stability > 0.0).then(|| memory.into());
+            fsrs.model
+                .next_states(memory, desired_retention, days_elapsed[i])
+                .ok()
+        })
+        .collect();
+
+    let mut failures = 0;
+    for (&i, result) in order.iter().zip(results) {
+        match result {
+            Some(states) => next_states[i] = states.into(),
+            None => failures += 1,
+        }
+    }
+    failures
+}
+
+/// Computes the probability of recall of many cards.
+///
+/// Card `i` has memory state `memory_states[i]` and was last reviewed `days_elapsed[i]`
+/// days ago. The forgetting curve's decay is taken from the handle's parameters. A new
+/// card, with zero stability, has a retrievability of zero.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+/// The `days_elapsed` pointer must be a valid pointer to an array of u32 with `len` elements.
+/// The `retrievabilities` pointer must be a valid pointer to an array of f32 with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_retrievability_batch(
+    fsrs: *const FSRS,
+    memory_states: *const MemoryState,
+    days_elapsed: *const u32,
+    retrievabilities: *mut f32,
+    len: usize,
+) {
+    let fsrs = unsafe { &*fsrs };
+    let memory_states = unsafe { slice(memory_states, len) };
+    let days_elapsed = unsafe { slice(days_elapsed, len) };
+    let retrievabilities = unsafe { slice_mut(retrievabilities, len) };
+    let curve = fsrs.forgetting_curve();
+    retrievabilities
+        .par_iter_mut()
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .for_each(|(i, retrievability)| {
+            *retrievability =
+                curve.retrievability(memory_states[i].stability, days_elapsed[i] as f32);
+        });
+}
@@ -0,0 +1,152 @@
+//! Throughput and latency benchmark for `fsrs-daemon`.
+//!
+//! Usage: `fsrs-bench [SOCKET_PATH] [CONNECTIONS] [REQUESTS] [PIPELINE_DEPTH]`
+//!
+//! Each connection sends `REQUESTS` requests, cycling through next-states,
+//! retrievability and apply-review, and keeps up to `PIPELINE_DEPTH` of them in flight.
+//! Latency is measured from the write that sent a request to the read of its response.
+
+#[path = "../fsrs-daemon/protocol.rs"]
+mod protocol;
+
+use std::env;
+use std::io::{self, BufReader, Write};
+use std::os::unix::net::UnixStream;
+use std::thread;
+use std::time::{Duration, Instant};
+
+use protocol::*;
+
+const DEFAULT_SOCKET_PATH: &str = "/tmp/fsrs.sock";
+
+struct Report {
+    latencies: Vec<Duration>,
+    errors: usize,
+}
+
+fn request(request_id: u32, parameters_id: u32) -> Vec<u8> {
+    let stability = 1.0 + (request_id % 100) as f32;
+    let difficulty = 1.0 + (request_id % 9) as f32;
+    let days_elapsed = request_id % 30;
+    let payload = Payload::default().u32(request_id);
+    let payload = match request_id % 3 {
+        0 => payload.u8(OP_NEXT_STATES).u32(parameters_id).f32(0.9),
+        1 => payload.u8(OP_RETRIEVABILITY).u32(parameters_id),
+        _ => payload
+            .u8(OP_APPLY_REVIEW)
+            .u32(parameters_id)
+            .f32(0.9)
+            .u32(1 + request_id % 4),
+    };
+    payload.u32(days_elapsed).f32(stability).f32(difficulty).0
+}
+
+/// Returns the request id and status of a response.
+fn response_header(payload: &[u8]) -> io::Result<(u32, u8)> {
+    let mut fields = Fields(payload);
+    fields
+        .u32()
+        .zip(fields.u8())
+        .ok_or_else(|| io::Error::new(io::ErrorKind::InvalidData, "short response"))
+}
+
+fn run_connection(socket_path: &str, requests: usize, depth: usize) -> io::Result<Report> {
+    let mut stream = UnixStream::connect(socket_path)?;
+    let mut reader = BufReader::new(stream.try_clone()?);
+    let mut payload = Vec::new();
+
+    // Load the default parameters as request 0.
+    let load = Payload::default().u32(0).u8(OP_LOAD_PARAMETERS).u32(0);
+    write_frame(&mut stream, &load.0)?;
+    read_frame(&mut reader, &mut payload)?;
+    let mut fields = Fields(&payload);
+    let parameters_id = match (fields.u32(), fields.u8(), fields.u32()) {
+        (Some(0), Some(STATUS_OK), Some(id)) => id,
+        _ => return Err(io::Error::other("loading parameters failed")),
+    };
+
+    let mut sent_at = vec![None; requests + 1];
+    let mut report = Report {
+        latencies: Vec::with_capacity(requests),
+        errors: 0,
+    };
+    let mut next = 1;
+    let mut out = Vec::new();
+    while report.latencies.len() < requests {
+        out.clear();
+        let first = next;
+        while next <= requests && next - 1 - report.latencies.len() < depth {
+            push_frame(&mut out, &request(next as u32, parameters_id));
+            next += 1;
+        }
+        if !out.is_empty() {
+            let now = Instant::now();
+            sent_at[first..next].fill(Some(now));
+            stream.write_all(&out)?;
+        }
+        if !read_frame(&mut reader, &mut payload)? {
+            return Err(io::ErrorKind::UnexpectedEof.into());
+        }
+        let (request_id, status) = response_header(&payload)?;
+        let sent = sent_at
+            .get_mut(request_id as usize)
+            .and_then(Option::take)
+            .ok_or_else(|| io::Error::other("unexpected response id"))?;
+        report.latencies.push(sent.elapsed());
+        report.errors += (status != STATUS_OK) as usize;
+    }
+    Ok(report)
+}
+
+fn percentile(sorted: &[Duration], fraction: f64) -> Duration {
+    let index = ((sorted.len() as f64 * fraction) as usize).min(sorted.len() - 1);
+    sorted[index]
+}
+
+fn main() -> io::Result<()> {
+    let args: Vec<String> = env::args().collect();
+    let socket_path = args.get(1).map_or(DEFAULT_SOCKET_PATH, String::as_str);
+    let number = |index: usize, default: usize| {
+        args.get(index)
+            .and_then(|arg| arg.parse().ok())
+            .unwrap_or(default)
+    };
+    let connections = number(2, 4).max(1);
+    let requests = number(3, 100_000).max(1);
+    let depth = number(4, 32).max(1);
+
+    let start = Instant::now();
+    let reports: Vec<io::Result<Report>> = thread::scope(|scope| {
+        let handles: Vec<_> = (0..connections)
+            .map(|_| scope.spawn(|| run_connection(socket_path, requests, depth)))
+            .collect();
+        handles
+            .into_iter()
+            .map(|handle| handle.join().unwrap())
+            .collect()
+    });
+    let elapsed = start.elapsed();
+
+    let mut latencies = Vec::with_capacity(connections * requests);
+    let mut errors = 0;
+    for report in reports {
+        let report = report?;
+        latencies.extend(report.latencies);
+        errors += report.errors;
+    }
+    latencies.sort_unstable();
+    println!(
+        "{} requests over {connections} connections (pipeline depth {depth}) in {:.3} s: {:.0} requests/s, {errors} errors",
+        latencies.len(),
+        elapsed.as_secs_f64(),
+        latencies.len() as f64 / elapsed.as_secs_f64(),
+    );
+    println!(
+        "latency p50 {:?}, p90 {:?}, p99 {:?}, max {:?}",
+        percentile(&latencies, 0.5),
+        percentile(&latencies, 0.9),
+        percentile(&latencies, 0.99),
+        latencies[latencies.len() - 1],
+    );
+    Ok(())
+}
@@ -0,0 +1,477 @@
+//! A local scheduling daemon.
+//!
+//! Usage: `fsrs-daemon [SOCKET_PATH]` (default `/tmp/fsrs.sock`).
+//!
+//! The daemon keeps one FSRS handle per parameter set its clients have loaded and not
+//! yet released, and serves
+//! scheduling requests over a Unix domain socket, using the protocol described in
+//! `protocol.rs`. Requests from all connections go into one queue; a worker takes
+//! whatever has accumulated and runs it as one batched call per parameter set and
+//! operation, so concurrent clients share model calls.
+
+mod protocol;
+
+use std::collections::HashMap;
+use std::env;
+use std::fs;
+use std::io::{self, BufReader, BufWriter, Write};
+use std::mem;
+use std::os::unix::net::{UnixListener, UnixStream};
+use std::sync::mpsc::{self, Receiver, Sender};
+use std::sync::{Condvar, Mutex};
+use std::thread;
+use std::time::Duration;
+
+use fsrs_rs_c::{
+    FSRS, HandleCache, ItemState, MemoryState, NextStates, ReviewEvent, fsrs_apply_reviews,
+    fsrs_handle_cache_acquire, fsrs_handle_cache_new, fsrs_handle_cache_release,
+    fsrs_next_states_batch, fsrs_retrievability_batch,
+};
+use protocol::*;
+
+const DEFAULT_SOCKET_PATH: &str = "/tmp/fsrs.sock";
+/// Handles kept by the cache, so parameters loaded again soon after their last
+/// release are not rebuilt.
+const HANDLE_CACHE_CAPACITY: usize = 64;
+/// Pause after a failed accept, so running out of file descriptors does not spin.
+const ACCEPT_RETRY_DELAY: Duration = Duration::from_millis(50);
+
+/// A registered parameter set.
+struct Entry {
+    fsrs: &'static FSRS,
+    /// Loads not yet released, over all connections.
+    loads: usize,
+    /// Queued jobs using the handle.
+    jobs: usize,
+}
+
+#[derive(Default)]
+struct Handles {
+    next_id: u32,
+    entries: HashMap<u32, Entry>,
+    /// The id of each registered handle, by address.
+    ids: HashMap<usize, u32>,
+}
+
+/// The parameter sets clients have loaded, by the id sent back to them.
+///
+/// A handle stays registered while a load of it is unreleased or a queued job uses it,
+/// and then goes back to the cache.
+struct Registry {
+    cache: &'static HandleCache,
+    handles: Mutex<Handles>,
+}
+
+impl Registry {
+    fn load(&self, parameters: &[f32]) -> Option<u32> {
+        let fsrs =
+            unsafe { fsrs_handle_cache_acquire(self.cache, parameters.as_ptr(), parameters.len()) };
+        let fsrs: &'static FSRS = unsafe { fsrs.as_ref()? };
+        let mut handles = self.handles.lock().unwrap();
+        let handles = &mut *handles;
+        if let Some(&id) = handles.ids.get(&(fsrs as *const FSRS as usize)) {
+            // Already registered; drop the extra reference.
+            unsafe { fsrs_handle_cache_release(fsrs) };
+            handles.entries.get_mut(&id)?.loads += 1;
+            return Some(id);
+        }
+        let mut id = handles.next_id;
+        while handles.entries.contains_key(&id) {
+            id = id.wrapping_add(1);
+        }
+        handles.next_id = id.wrapping_add(1);
+        handles.ids.insert(fsrs as *const FSRS as usize, id);
+        handles.entries.insert(
+            id,
+            Entry {
+                fsrs,
+                loads: 1,
+                jobs: 0,
+            },
+        );
+        Some(id)
+    }
+
+    /// Returns the handle for a new job, or `None` if `id` is not loaded.
+    fn start_job(&self, id: u32) -> Option<&'static FSRS> {
+        let mut handles = self.handles.lock().unwrap();
+        let entry = handles.entries.get_mut(&id)?;
+        entry.jobs += 1;
+        Some(entry.fsrs)
+    }
+
+    fn finish_jobs(&self, id: u32, jobs: usize) {
+        let mut handles = self.handles.lock().unwrap();
+        if let Some(entry) = handles.entries.get_mut(&id) {
+            entry.jobs -= jobs;
+            Self::remove_unused(&mut handles, id);
+        }
+    }
+
+    /// Releases one load of `id`; false if it is not loaded.
+    fn release(&self, id: u32) -> bool {
+        let mut handles = self.handles.lock().unwrap();
+        let Some(entry) = handles.entries.get_mut(&id) else {
+            return false;
+        };
+        entry.loads -= 1;
+        Self::remove_unused(&mut handles, id);
+        true
+    }
+
+    fn remove_unused(handles: &mut Handles, id: u32) {
+        if let Some(entry) = handles.entries.get(&id)
+            && entry.loads == 0
+            && entry.jobs == 0
+        {
+            let fsrs = entry.fsrs;
+            handles.entries.remove(&id);
+            handles.ids.remove(&(fsrs as *const FSRS as usize));
+            unsafe { fsrs_handle_cache_release(fsrs) };
+        }
+    }
+}
+
+/// One queued scheduling request.
+struct Job {
+    request_id: u32,
+    parameters_id: u32,
+    fsrs: &'static FSRS,
+    opcode: u8,
+    desired_retention: f32,
+    rating: u32,
+    days_elapsed: u32,
+    memory: MemoryState,
+    reply: Sender<Vec<u8>>,
+}
+
+impl Job {
+    /// Requests that can share one batched call.
+    fn batch_key(&self) -> (usize, u8, u32) {
+        (
+            self.fsrs as *const FSRS as usize,
+            self.opcode,
+            self.desired_retention.to_bits(),
+        )
+    }
+
+    fn respond(&self, result: Option<&[f32]>) {
+        let payload = Payload::default().u32(self.request_id);
+        let payload = match result {
+            Some(values) => values
+                .iter()
+                .fold(payload.u8(STATUS_OK), |payload, &value| payload.f32(value)),
+            None => payload.u8(STATUS_ERROR),
+        };
+        let mut frame = Vec::with_capacity(payload.0.len() + 4);
+        push_frame(&mut frame, &payload.0);
+        // The connection may be gone; its reply is simply dropped.
+        let _ = self.reply.send(frame);
+    }
+}
+
+struct Queue {
+    jobs: Mutex<Vec<Job>>,
+    ready: Condvar,
+}
+
+impl Queue {
+    fn push(&self, job: Job) {
+        self.jobs.lock().unwrap().push(job);
+        self.ready.notify_one();
+    }
+
+    /// Waits for work and takes everything queued so far.
+    fn take(&self) -> Vec<Job> {
+        let mut jobs = self.jobs.lock().unwrap();
+        while jobs.is_empty() {
+            jobs = self.ready.wait(jobs).unwrap();
+        }
+        mem::take(&mut *jobs)
+    }
+}
+
+fn unknown_state() -> ItemState {
+    ItemState {
+        memory: MemoryState {
+            stability: 0.0,
+            difficulty: 0.0,
+        },
+        interval: f32::NAN,
+    }
+}
+
+/// Runs jobs that share a handle, operation and desired retention as one library call.
+fn run_batch(jobs: &[Job]) {
+    let fsrs = jobs[0].fsrs;
+    let desired_retention = jobs[0].desired_retention;
+    let memory_states: Vec<MemoryState> = jobs.iter().map(|job| job.memory).collect();
+    let days_elapsed: Vec<u32> = jobs.iter().map(|job| job.days_elapsed).collect();
+    match jobs[0].opcode {
+        OP_NEXT_STATES => {
+            let mut next_states: Vec<NextStates> = (0..jobs.len())
+                .map(|_| NextStates {
+                    again: unknown_state(),
+                    hard: unknown_state(),
+                    good: unknown_state(),
+                    easy: unknown_state(),
+                })
+                .collect();
+            unsafe {
+                fsrs_next_states_batch(
+                    fsrs,
+                    memory_states.as_ptr(),
+                    days_elapsed.as_ptr(),
+                    desired_retention,
+                    next_states.as_mut_ptr(),
+                    jobs.len(),
+                )
+            };
+            for (job, next) in jobs.iter().zip(&next_states) {
+                let states = [&next.again, &next.hard, &next.good, &next.easy];
+                let values = states.map(|state| {
+                    [
+                        state.memory.stability,
+                        state.memory.difficulty,
+                        state.interval,
+                    ]
+                });
+                let failed = next.again.interval.is_nan();
+                job.respond((!failed).then_some(values.as_flattened()));
+            }
+        }
+        OP_RETRIEVABILITY => {
+            let mut retrievabilities = vec![0.0; jobs.len()];
+            unsafe {
+                fsrs_retrievability_batch(
+                    fsrs,
+                    memory_states.as_ptr(),
+                    days_elapsed.as_ptr(),
+                    retrievabilities.as_mut_ptr(),
+                    jobs.len(),
+                )
+            };
+            for (job, retrievability) in jobs.iter().zip(retrievabilities) {
+                job.respond(Some(&[retrievability]));
+            }
+        }
+        OP_APPLY_REVIEW => {
+            let mut states: Vec<ItemState> = memory_states
+                .iter()
+                .map(|&memory| ItemState {
+                    memory,
+                    interval: f32::NAN,
+                })
+                .collect();
+            let events: Vec<ReviewEvent> = jobs
+                .iter()
+                .enumerate()
+                .map(|(card_index, job)| ReviewEvent {
+                    card_index,
+                    rating: job.rating,
+                    elapsed_days: job.days_elapsed,
+                })
+                .collect();
+            unsafe {
+                fsrs_apply_reviews(
+                    fsrs,
+                    states.as_mut_ptr(),
+                    states.len(),
+                    events.as_ptr(),
+                    events.len(),
+                    desired_retention,
+                )
+            };
+            // A skipped review leaves the interval unset.
+            for (job, state) in jobs.iter().zip(&states) {
+                let values = [
+                    state.memory.stability,
+                    state.memory.difficulty,
+                    state.interval,
+                ];
+                job.respond((!state.interval.is_nan()).then_some(&values));
+            }
+        }
+        _ => unreachable!("only scheduling requests are queued"),
+    }
+}
+
+fn run_worker(queue: &Queue, registry: &Registry) {
+    loop {
+        let mut jobs = queue.take();
+        jobs.sort_by_key(Job::batch_key);
+        for batch in jobs.chunk_by(|a, b| a.batch_key() == b.batch_key()) {
+            run_batch(batch);
+            // Every job in a batch shares a handle, and so its parameters id.
+            registry.finish_jobs(batch[0].parameters_id, batch.len());
+        }
+    }
+}
+
+/// Writes replies as they arrive, flushing whenever no more are waiting.
+fn write_replies(stream: UnixStream, replies: Receiver<Vec<u8>>) -> io::Result<()> {
+    let mut writer = BufWriter::new(stream);
+    while let Ok(frame) = replies.recv() {
+        writer.write_all(&frame)?;
+        while let Ok(frame) = replies.try_recv() {
+            writer.write_all(&frame)?;
+        }
+        writer.flush()?;
+    }
+    Ok(())
+}
+
+/// Parses a scheduling request into a job; `None` if it is malformed.
+fn parse_job(
+    request_id: u32,
+    opcode: u8,
+    fields: &mut Fields,
+    registry: &Registry,
+    reply: &Sender<Vec<u8>>,
+) -> Option<Job> {
+    let parameters_id = fields.u32()?;
+    let (desired_retention, rating) = match opcode {
+        OP_NEXT_STATES => (fields.f32()?, 0),
+        OP_RETRIEVABILITY => (0.0, 0),
+        OP_APPLY_REVIEW => (fields.f32()?, fields.u32()?),
+        _ => return None,
+    };
+    let days_elapsed = fields.u32()?;
+    let memory = MemoryState {
+        stability: fields.f32()?,
+        difficulty: fields.f32()?,
+    };
+    Some(Job {
+        request_id,
+        parameters_id,
+        fsrs: registry.start_job(parameters_id)?,
+        opcode,
+        desired_retention,
+        rating,
+        days_elapsed,
+        memory,
+        reply: reply.clone(),
+    })
+}
+
+/// Handles a request that is answered at once rather than queued; `None` if `opcode`
+/// is a scheduling request. Tracks the parameter sets the connection has loaded.
+fn handle_parameters(
+    opcode: u8,
+    fields: &mut Fields,
+    registry: &Registry,
+    loaded: &mut Vec<u32>,
+) -> Option<Option<Payload>> {
+    let result = match opcode {
+        OP_LOAD_PARAMETERS => fields
+            .u32()
+            .and_then(|count| (0..count).map(|_| fields.f32()).collect::<Option<Vec<_>>>())
+            .and_then(|parameters| registry.load(&parameters))
+            .map(|id| {
+                loaded.push(id);
+                Payload::default().u32(id)
+            }),
+        OP_RELEASE_PARAMETERS => fields.u32().and_then(|id| {
+            // A connection may only release what it loaded.
+            let index = loaded.iter().position(|&loaded| loaded == id)?;
+            loaded.swap_remove(index);
+            registry.release(id).then(Payload::default)
+        }),
+        _ => return None,
+    };
+    Some(result)
+}
+
+fn serve(stream: UnixStream, registry: &Registry, queue: &Queue) -> io::Result<()> {
+    let mut loaded = Vec::new();
+    let result = serve_requests(stream, registry, queue, &mut loaded);
+    // Whatever the connection did not release itself goes when it closes.
+    for id in loaded {
+        registry.release(id);
+    }
+    result
+}
+
+fn serve_requests(
+    stream: UnixStream,
+    registry: &Registry,
+    queue: &Queue,
+    loaded: &mut Vec<u32>,
+) -> io::Result<()> {
+    let (reply, replies) = mpsc::channel();
+    let writer_stream = stream.try_clone()?;
+    let writer = thread::spawn(move || write_replies(writer_stream, replies));
+    let mut reader = BufReader::new(stream);
+    let mut payload = Vec::new();
+    while read_frame(&mut reader, &mut payload)? {
+        let mut fields = Fields(&payload);
+        let (Some(request_id), Some(opcode)) = (fields.u32(), fields.u8()) else {
+            break;
+        };
+        if let Some(result) = handle_parameters(opcode, &mut fields, registry, loaded) {
+            let response = Payload::default().u32(request_id);
+            let response = match result {
+                Some(result) => {
+                    let mut response = response.u8(STATUS_OK);
+                    response.0.extend_from_slice(&result.0);
+                    response
+                }
+                None => response.u8(STATUS_ERROR),
+            };
+            let mut frame = Vec::new();
+            push_frame(&mut frame, &response.0);
+            let _ = reply.send(frame);
+            continue;
+        }
+        match parse_job(request_id, opcode, &mut fields, registry, &reply) {
+            Some(job) => queue.push(job),
+            None => {
+                let mut frame = Vec::new();
+                push_frame(
+                    &mut frame,
+                    &Payload::default().u32(request_id).u8(STATUS_ERROR).0,
+                );
+                let _ = reply.send(frame);
+            }
+        }
+    }
+    // The writer finishes once every queued job for this connection has replied.
+    drop(reply);
+    writer.join().unwrap()
+}
+
+fn main() -> io::Result<()> {
+    let socket_path = env::args()
+        .nth(1)
+        .unwrap_or_else(|| DEFAULT_SOCKET_PATH.to_string());
+    let _ = fs::remove_file(&socket_path);
+    let listener = UnixListener::bind(&socket_path)?;
+    eprintln!("fsrs-daemon listening on {socket_path}");
+
+    let registry: &'static Registry = Box::leak(Box::new(Registry {
+        cache: unsafe { &*fsrs_handle_cache_new(HANDLE_CACHE_CAPACITY) },
+        handles: Mutex::new(Handles::default()),
+    }));
+    let queue: &'static Queue = Box::leak(Box::new(Queue {
+        jobs: Mutex::new(Vec::new()),
+        ready: Condvar::new(),
+    }));
+    thread::spawn(move || run_worker(queue, registry));
+
+    for stream in listener.incoming() {
+        let stream = match stream {
+            Ok(stream) => stream,
+            Err(error) => {
+                eprintln!("fsrs-daemon: accept failed: {error}");
+                thread::sleep(ACCEPT_RETRY_DELAY);
+                continue;
+            }
+        };
+        thread::spawn(move || {
+            if let Err(error) = serve(stream, registry, queue) {
+                eprintln!("fsrs-daemon: connection closed: {error}");
+            }
+        });
+    }
+    Ok(())
+}
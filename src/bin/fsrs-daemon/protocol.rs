@@ -0,0 +1,104 @@
+//! Wire format shared by `fsrs-daemon` and `fsrs-bench`.
+//!
+//! Every message is a frame: a little-endian u32 payload length, then the payload. A
+//! request payload starts with a u32 request id and a u8 opcode; the response echoes the
+//! request id, followed by a u8 status and, on success, the result. Responses on one
+//! connection may arrive out of order. Memory states are sent as stability then
+//! difficulty; zero stability marks a new card. All numbers are little-endian.
+
+// The daemon and the benchmark client each use only part of this module.
+#![allow(dead_code)]
+
+use std::io::{self, Read, Write};
+
+/// `u32 count, f32 parameters[count]` → `u32 parameters id`. A count of zero selects the
+/// default parameters. Loading the same parameters again returns the same id.
+pub const OP_LOAD_PARAMETERS: u8 = 1;
+/// `u32 parameters id, f32 desired retention, u32 days elapsed, f32 stability, f32 difficulty`
+/// → `(f32 stability, f32 difficulty, f32 interval)` for again, hard, good and easy.
+pub const OP_NEXT_STATES: u8 = 2;
+/// `u32 parameters id, u32 days elapsed, f32 stability, f32 difficulty` → `f32 retrievability`.
+pub const OP_RETRIEVABILITY: u8 = 3;
+/// `u32 parameters id, f32 desired retention, u32 rating, u32 days elapsed, f32 stability,
+/// f32 difficulty` → `f32 stability, f32 difficulty, f32 interval`.
+pub const OP_APPLY_REVIEW: u8 = 4;
+/// `u32 parameters id` → nothing. Undoes one load of the id on this connection; once no
+/// connection holds it, the id is no longer valid. Closing a connection releases
+/// everything it loaded.
+pub const OP_RELEASE_PARAMETERS: u8 = 5;
+
+pub const STATUS_OK: u8 = 0;
+pub const STATUS_ERROR: u8 = 1;
+
+/// Largest accepted payload, enough for the longest parameter vector.
+pub const MAX_FRAME_LEN: usize = 4096;
+
+/// Reads one frame into `payload`. Returns false on a clean end of stream.
+pub fn read_frame(reader: &mut impl Read, payload: &mut Vec<u8>) -> io::Result<bool> {
+    let mut len = [0; 4];
+    match reader.read_exact(&mut len) {
+        Ok(()) => {}
+        Err(error) if error.kind() == io::ErrorKind::UnexpectedEof => return Ok(false),
+        Err(error) => return Err(error),
+    }
+    let len = u32::from_le_bytes(len) as usize;
+    if len > MAX_FRAME_LEN {
+        return Err(io::Error::new(io::ErrorKind::InvalidData, "frame too long"));
+    }
+    payload.resize(len, 0);
+    reader.read_exact(payload)?;
+    Ok(true)
+}
+
+/// Appends a frame holding `payload` to `out`.
+pub fn push_frame(out: &mut Vec<u8>, payload: &[u8]) {
+    out.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+    out.extend_from_slice(payload);
+}
+
+pub fn write_frame(writer: &mut impl Write, payload: &[u8]) -> io::Result<()> {
+    writer.write_all(&(payload.len() as u32).to_le_bytes())?;
+    writer.write_all(payload)
+}
+
+/// Builds a payload from 4-byte fields.
+#[derive(Default)]
+pub struct Payload(pub Vec<u8>);
+
+impl Payload {
+    pub fn u8(mut self, value: u8) -> Self {
+        self.0.push(value);
+        self
+    }
+
+    pub fn u32(mut self, value: u32) -> Self {
+        self.0.extend_from_slice(&value.to_le_bytes());
+        self
+    }
+
+    pub fn f32(mut self, value: f32) -> Self {
+        self.0.extend_from_slice(&value.to_le_bytes());
+        self
+    }
+}
+
+/// Reads fields from a payload; every getter returns `None` once the payload runs out.
+pub struct Fields<'a>(pub &'a [u8]);
+
+impl Fields<'_> {
+    pub fn u8(&mut self) -> Option<u8> {
+        let (&value, rest) = self.0.split_first()?;
+        self.0 = rest;
+        Some(value)
+    }
+
+    pub fn u32(&mut self) -> Option<u32> {
+        let (value, rest) = self.0.split_first_chunk::<4>()?;
+        self.0 = rest;
+        Some(u32::from_le_bytes(*value))
+    }
+
+    pub fn f32(&mut self) -> Option<f32> {
+        self.u32().map(f32::from_bits)
+    }
+}
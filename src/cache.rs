@@ -0,0 +1,178 @@
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, RwLock};
+
+use crate::FSRS;
+
+/// The most entries one miss looks at while making room, so that a cache full of handles
+/// in use costs a bounded amount per miss instead of a full scan.
+const MAX_EVICTION_STEPS: usize = 32;
+
+/// A thread-safe cache of FSRS handles keyed by parameter vector.
+///
+/// Handles are reference counted: every `fsrs_handle_cache_acquire` must be paired with
+/// one `fsrs_handle_cache_release`. A handle no caller holds any more stays cached while
+/// it is idle. When more than `capacity` handles are cached, misses evict idle handles
+/// in approximately least recently acquired order (the CLOCK algorithm); handles in use
+/// are never evicted.
+pub struct HandleCache {
+    capacity: usize,
+    handles: RwLock<Handles>,
+}
+
+struct Handles {
+    entries: HashMap<Vec<u32>, Entry>,
+    /// The keys of `entries` in the order the clock hand visits them.
+    ring: Vec<Vec<u32>>,
+    hand: usize,
+}
+
+struct Entry {
+    handle: Arc<FSRS>,
+    /// Set on every hit and cleared as the clock hand passes, so an entry is only evicted
+    /// if it went unused for a whole turn of the hand.
+    referenced: AtomicBool,
+}
+
+impl Entry {
+    fn is_idle(&self) -> bool {
+        Arc::strong_count(&self.handle) == 1
+    }
+}
+
+impl Handles {
+    /// Evicts idle entries until no more than `capacity` remain, looking at a bounded
+    /// number of entries.
+    fn evict(&mut self, capacity: usize) {
+        for _ in 0..MAX_EVICTION_STEPS {
+            if self.entries.len() <= capacity {
+                return;
+            }
+            if self.hand >= self.ring.len() {
+                self.hand = 0;
+            }
+            let entry = &self.entries[&self.ring[self.hand]];
+            // Handles become idle when released, which the cache does not see, so
+            // idleness is checked as the hand passes.
+            if entry.referenced.swap(false, Ordering::Relaxed) || !entry.is_idle() {
+                self.hand += 1;
+            } else {
+                let key = self.ring.swap_remove(self.hand);
+                self.entries.remove(&key);
+            }
+        }
+    }
+}
+
+impl HandleCache {
+    fn acquire(&self, parameters: &[f32]) -> Option<Arc<FSRS>> {
+        // Empty parameters select the defaults, so they share the defaults' entry.
+        let parameters = if parameters.is_empty() {
+            &fsrs::DEFAULT_PARAMETERS[..]
+        } else {
+            parameters
+        };
+        // Keyed on the exact bit patterns so that a hit always yields the same model.
+        let key: Vec<u32> = parameters.iter().map(|p| p.to_bits()).collect();
+        if let Some(entry) = self.handles.read().unwrap().entries.get(&key) {
+            entry.referenced.store(true, Ordering::Relaxed);
+            return Some(entry.handle.clone());
+        }
+
+        // Build outside the lock so misses for other parameters are not serialized.
+        let handle = Arc::new(FSRS::new(Some(parameters)).ok()?);
+
+        let mut handles = self.handles.write().unwrap();
+        let handle = match handles.entries.get(&key) {
+            // Another thread built the same handle first.
+            Some(entry) => {
+                entry.referenced.store(true, Ordering::Relaxed);
+                entry.handle.clone()
+            }
+            None => {
+                handles.ring.push(key.clone());
+                handles.entries.insert(
+                    key,
+                    Entry {
+                        handle: handle.clone(),
+                        referenced: AtomicBool::new(false),
+                    },
+                );
+                handle
+            }
+        };
+        handles.evict(self.capacity);
+        Some(handle)
+    }
+}
+
+/// Creates a new handle cache.
+///
+/// `capacity` is the number of handles kept alive. Handles in use are never evicted, so
+/// the cache grows past `capacity` while more than that are held.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_handle_cache_new(capacity: usize) -> *mut HandleCache {
+    Box::into_raw(Box::new(HandleCache {
+        capacity,
+        handles: RwLock::new(Handles {
+            entries: HashMap::new(),
+            ring: Vec::new(),
+            hand: 0,
+        }),
+    }))
+}
+
+/// Frees the memory allocated for a handle cache.
+///
+/// Handles acquired from the cache stay valid until they are released.
+///
+/// # Safety
+///
+/// The `cache` pointer must be a valid pointer to a HandleCache instance created by `fsrs_handle_cache_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_handle_cache_free(cache: *mut HandleCache) {
+    if !cache.is_null() {
+        unsafe { drop(Box::from_raw(cache)) };
+    }
+}
+
+/// Returns the FSRS instance for the given parameters, creating it on first use.
+///
+/// The cache may be used from several threads at once. NULL or empty parameters select
+/// the default parameters and share their handle. Returns NULL if the parameters are
+/// invalid.
+///
+/// # Safety
+///
+/// The `cache` pointer must be a valid pointer to a HandleCache instance.
+/// The `parameters` pointer must be NULL or a valid pointer to an array of f32 with `len` elements.
+/// The returned handle must be freed with `fsrs_handle_cache_release`, not `fsrs_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_handle_cache_acquire(
+    cache: *const HandleCache,
+    parameters: *const f32,
+    len: usize,
+) -> *const FSRS {
+    let cache = unsafe { &*cache };
+    let parameters = if parameters.is_null() {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(parameters, len) }
+    };
+    cache
+        .acquire(parameters)
+        .map_or(std::ptr::null(), Arc::into_raw)
+}
+
+/// Releases an FSRS instance acquired from a handle cache.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer returned by `fsrs_handle_cache_acquire`,
+/// and must not be used after this call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_handle_cache_release(fsrs: *const FSRS) {
+    if !fsrs.is_null() {
+        unsafe { drop(Arc::from_raw(fsrs)) };
+    }
+}
@@ -0,0 +1,280 @@
+use rayon::prelude::*;
+
+use crate::packed::CardState;
+use crate::{FSRS, MemoryState, slice, slice_mut};
+
+/// Cards compared per step of the due scan; one bit of a mask word each.
+const SCAN_CHUNK: usize = 64;
+/// Cards per parallel task when applying reviews.
+const MIN_CARDS_PER_TASK: usize = 1024;
+
+/// A growable, column-oriented store of card states.
+///
+/// Each field lives in its own array, so a due scan only reads due days. Cards are
+/// addressed by their index, which is assigned on insertion and never changes.
+pub struct CardStore {
+    ids: Vec<i64>,
+    stability: Vec<f32>,
+    difficulty: Vec<f32>,
+    last_review_days: Vec<i32>,
+    due_days: Vec<i32>,
+}
+
+/// Read-only views of a CardStore's columns, each with `len` elements.
+///
+/// The pointers are invalidated by any call that modifies the store.
+#[repr(C)]
+pub struct CardStoreColumns {
+    pub ids: *const i64,
+    pub stability: *const f32,
+    pub difficulty: *const f32,
+    pub last_review_days: *const i32,
+    pub due_days: *const i32,
+    pub len: usize,
+}
+
+impl CardStore {
+    fn state(&self, index: usize) -> CardState {
+        CardState {
+            memory: MemoryState {
+                stability: self.stability[index],
+                difficulty: self.difficulty[index],
+            },
+            last_review_day: self.last_review_days[index],
+            due_day: self.due_days[index],
+        }
+    }
+
+    fn set_state(&mut self, index: usize, state: CardState) {
+        self.stability[index] = state.memory.stability;
+        self.difficulty[index] = state.memory.difficulty;
+        self.last_review_days[index] = state.last_review_day;
+        self.due_days[index] = state.due_day;
+    }
+}
+
+/// Returns a mask with bit `j` set if `due_days[j] <= today`.
+///
+/// Written without branches so the comparison vectorizes.
+fn due_mask(due_days: &[i32], today: i32) -> u64 {
+    due_days.iter().enumerate().fold(0, |mask, (j, &due_day)| {
+        mask | ((due_day <= today) as u64) << j
+    })
+}
+
+/// Creates an empty card store with room for `capacity` cards.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_card_store_new(capacity: usize) -> *mut CardStore {
+    Box::into_raw(Box::new(CardStore {
+        ids: Vec::with_capacity(capacity),
+        stability: Vec::with_capacity(capacity),
+        difficulty: Vec::with_capacity(capacity),
+        last_review_days: Vec::with_capacity(capacity),
+        due_days: Vec::with_capacity(capacity),
+    }))
+}
+
+/// Frees the memory allocated for a CardStore instance.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance created by `fsrs_card_store_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_free(store: *mut CardStore) {
+    if !store.is_null() {
+        unsafe { drop(Box::from_raw(store)) };
+    }
+}
+
+/// Returns the number of cards in the store.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_len(store: *const CardStore) -> usize {
+    unsafe { &*store }.ids.len()
+}
+
+/// Appends cards to the store and returns the index of the first one.
+///
+/// If `len` is nonzero and either array is NULL, nothing is appended and 0 is returned.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+/// The `card_ids` pointer must be a valid pointer to an array of i64 with `len` elements.
+/// The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_push(
+    store: *mut CardStore,
+    card_ids: *const i64,
+    states: *const CardState,
+    len: usize,
+) -> usize {
+    let store = unsafe { &mut *store };
+    if len > 0 && (card_ids.is_null() || states.is_null()) {
+        return 0;
+    }
+    let card_ids = unsafe { slice(card_ids, len) };
+    let states = unsafe { slice(states, len) };
+    let first = store.ids.len();
+    store.ids.extend_from_slice(card_ids);
+    store
+        .stability
+        .extend(states.iter().map(|state| state.memory.stability));
+    store
+        .difficulty
+        .extend(states.iter().map(|state| state.memory.difficulty));
+    store
+        .last_review_days
+        .extend(states.iter().map(|state| state.last_review_day));
+    store
+        .due_days
+        .extend(states.iter().map(|state| state.due_day));
+    first
+}
+
+/// Reads the state of the card at `index`. Returns false if the index is out of range.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+/// The `state` pointer must be a valid pointer to a CardState instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_get(
+    store: *const CardStore,
+    index: usize,
+    state: *mut CardState,
+) -> bool {
+    let store = unsafe { &*store };
+    if index >= store.ids.len() {
+        return false;
+    }
+    unsafe { *state = store.state(index) };
+    true
+}
+
+/// Returns views of the store's columns.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_columns(store: *const CardStore) -> CardStoreColumns {
+    let store = unsafe { &*store };
+    CardStoreColumns {
+        ids: store.ids.as_ptr(),
+        stability: store.stability.as_ptr(),
+        difficulty: store.difficulty.as_ptr(),
+        last_review_days: store.last_review_days.as_ptr(),
+        due_days: store.due_days.as_ptr(),
+        len: store.ids.len(),
+    }
+}
+
+/// Finds the cards due on or before `today`.
+///
+/// Writes the indices of the first `capacity` due cards, in ascending order, to
+/// `indices` and returns the total number of due cards, so a call with a capacity of
+/// zero only counts them. The scan compares due days in blocks of 64 without branching
+/// and only visits set bits of each block's mask.
+///
+/// # Safety
+///
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+/// The `indices` pointer must be NULL or a valid pointer to an array of size_t with `capacity` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_due(
+    store: *const CardStore,
+    today: i32,
+    indices: *mut usize,
+    capacity: usize,
+) -> usize {
+    let store = unsafe { &*store };
+    let indices = unsafe { slice_mut(indices, capacity) };
+    let mut count = 0;
+    for (chunk, due_days) in store.due_days.chunks(SCAN_CHUNK).enumerate() {
+        let mut mask = due_mask(due_days, today);
+        if count >= indices.len() {
+            count += mask.count_ones() as usize;
+            continue;
+        }
+        while mask != 0 {
+            if let Some(index) = indices.get_mut(count) {
+                *index = chunk * SCAN_CHUNK + mask.trailing_zeros() as usize;
+            }
+            count += 1;
+            mask &= mask - 1;
+        }
+    }
+    count
+}
+
+/// Applies a batch of reviews to the store in place.
+///
+/// Card `indices[i]` is reviewed on `today` with `ratings[i]` (1 to 4) and becomes due
+/// once `desired_retention` is reached, at least one day later. If an index appears more
+/// than once, its reviews are applied in batch order, each from the state the previous
+/// one left; different cards are processed in parallel on the shared pool. Returns the
+/// number of reviews skipped because the index or rating was invalid or the model
+/// failed; later reviews of that card still apply.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `store` pointer must be a valid pointer to a CardStore instance.
+/// The `indices` pointer must be a valid pointer to an array of size_t with `len` elements.
+/// The `ratings` pointer must be a valid pointer to an array of u32 with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_store_review(
+    fsrs: *const FSRS,
+    store: *mut CardStore,
+    indices: *const usize,
+    ratings: *const u32,
+    len: usize,
+    today: i32,
+    desired_retention: f32,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let store = unsafe { &mut *store };
+    let indices = unsafe { slice(indices, len) };
+    let ratings = unsafe { slice(ratings, len) };
+    let num_cards = store.ids.len();
+
+    let mut order: Vec<(usize, u32)> = indices
+        .iter()
+        .copied()
+        .zip(ratings.iter().copied())
+        .filter(|&(index, _)| index < num_cards)
+        .collect();
+    let mut skipped = indices.len() - order.len();
+    // A stable sort keeps each card's reviews in batch order.
+    order.sort_by_key(|&(index, _)| index);
+
+    let cards = &*store;
+    let updates: Vec<(usize, CardState, usize)> = order
+        .chunk_by(|a, b| a.0 == b.0)
+        .collect::<Vec<_>>()
+        .into_par_iter()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|reviews| {
+            let index = reviews[0].0;
+            let mut state = cards.state(index);
+            let mut skipped = 0;
+            for &(_, rating) in reviews {
+                match state.review(fsrs, rating, today, desired_retention) {
+                    Some(next) => state = next,
+                    None => skipped += 1,
+                }
+            }
+            (index, state, skipped)
+        })
+        .collect();
+
+    for (index, state, card_skipped) in updates {
+        store.set_state(index, state);
+        skipped += card_skipped;
+    }
+    skipped
+}
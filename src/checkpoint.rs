@@ -0,0 +1,145 @@
+use rayon::prelude::*;
+
+use crate::due::mix;
+use crate::history::{FsrsReviewHistories, Histories};
+use crate::{FSRS, FSRSReview, MemoryState, slice, slice_mut};
+
+/// Cards per parallel task when advancing or checking checkpoints.
+const MIN_CARDS_PER_TASK: usize = 256;
+
+/// A card's memory state after its first `review_count` reviews.
+///
+/// A card that has not been reviewed yet has a zeroed checkpoint, except that
+/// `last_review_day` should be set to the day of its first review. Later days are
+/// derived from the `delta_t` of each review.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct MemoryCheckpoint {
+    pub memory: MemoryState,
+    pub last_review_day: i32,
+    pub review_count: u32,
+}
+
+fn to_item(reviews: &[FSRSReview]) -> fsrs::FSRSItem {
+    fsrs::FSRSItem {
+        reviews: reviews.iter().map(|review| (*review).into()).collect(),
+    }
+}
+
+/// Returns `checkpoint` moved past the reviews of `history` it has not seen yet.
+fn advance(
+    fsrs: &FSRS,
+    history: &[FSRSReview],
+    checkpoint: &MemoryCheckpoint,
+) -> Option<MemoryCheckpoint> {
+    let new_reviews = history.get(checkpoint.review_count as usize..)?;
+    if new_reviews.is_empty() {
+        return Some(*checkpoint);
+    }
+    let starting_state = (checkpoint.review_count > 0).then(|| checkpoint.memory.into());
+    let memory = fsrs
+        .model
+        .memory_state(to_item(new_reviews), starting_state)
+        .ok()?;
+    let days: i64 = new_reviews.iter().map(|review| review.delta_t as i64).sum();
+    Some(MemoryCheckpoint {
+        memory: memory.into(),
+        last_review_day: (checkpoint.last_review_day as i64 + days)
+            .clamp(i32::MIN as i64, i32::MAX as i64) as i32,
+        review_count: u32::try_from(history.len()).ok()?,
+    })
+}
+
+/// Whether `checkpoint` is bit-for-bit what a full replay of its reviews yields.
+fn matches_replay(fsrs: &FSRS, history: &[FSRSReview], checkpoint: &MemoryCheckpoint) -> bool {
+    let Some(reviews) = history.get(..checkpoint.review_count as usize) else {
+        return false;
+    };
+    if reviews.is_empty() {
+        return checkpoint.memory.stability == 0.0 && checkpoint.memory.difficulty == 0.0;
+    }
+    fsrs.model
+        .memory_state(to_item(reviews), None)
+        .is_ok_and(|memory| {
+            memory.stability.to_bits() == checkpoint.memory.stability.to_bits()
+                && memory.difficulty.to_bits() == checkpoint.memory.difficulty.to_bits()
+        })
+}
+
+/// Advances memory-state checkpoints over reviews added since they were taken.
+///
+/// `histories` holds each card's full history; only the reviews after the first
+/// `checkpoints[i].review_count` are replayed, starting from the checkpoint's memory
+/// state, so the result equals a full replay without its cost. Cards are processed in
+/// parallel on the shared pool.
+///
+/// Returns the number of checkpoints left unchanged because they claim more reviews than
+/// the history holds or the model failed.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The `checkpoints` pointer must be a valid pointer to an array of MemoryCheckpoint with `histories->num_cards` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_checkpoints_advance(
+    fsrs: *const FSRS,
+    histories: *const FsrsReviewHistories,
+    checkpoints: *mut MemoryCheckpoint,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let histories = unsafe { Histories::new(&*histories) };
+    let checkpoints = unsafe { slice_mut(checkpoints, histories.num_cards()) };
+    checkpoints
+        .par_iter_mut()
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(
+            |(i, checkpoint)| match advance(fsrs, histories.card(i), checkpoint) {
+                Some(advanced) => {
+                    *checkpoint = advanced;
+                    0
+                }
+                None => 1,
+            },
+        )
+        .sum()
+}
+
+/// Spot-checks checkpoints against a full replay of each card's history.
+///
+/// About `sample_size` cards, chosen pseudo-randomly from `seed`, are replayed from
+/// their first review, and their memory state must match the checkpoint exactly; a
+/// `sample_size` of at least the number of cards checks all of them. Days are not
+/// checked, as histories carry no absolute dates.
+///
+/// Returns the number of sampled checkpoints that do not match.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The `checkpoints` pointer must be a valid pointer to an array of MemoryCheckpoint with `histories->num_cards` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_checkpoints_validate(
+    fsrs: *const FSRS,
+    histories: *const FsrsReviewHistories,
+    checkpoints: *const MemoryCheckpoint,
+    sample_size: usize,
+    seed: u64,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let histories = unsafe { Histories::new(&*histories) };
+    let num_cards = histories.num_cards();
+    let checkpoints = unsafe { slice(checkpoints, num_cards) };
+    checkpoints
+        .par_iter()
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .filter(|(i, _)| {
+            sample_size >= num_cards
+                || mix(seed ^ mix(*i as u64)) % (num_cards as u64) < sample_size as u64
+        })
+        .filter(|(i, checkpoint)| !matches_replay(fsrs, histories.card(*i), checkpoint))
+        .count()
+}
@@ -0,0 +1,177 @@
+use rayon::prelude::*;
+
+use crate::packed::CardState;
+use crate::{FSRS, ForgettingCurve, slice};
+
+/// Number of bins in each histogram of `CollectionStats`.
+///
+/// Retrievability bin `i` covers `[i, i + 1) / 20`, with 1 in the last bin. Stability
+/// bin 0 counts stabilities below 1 day and bin `i` those in `[2^(i-1), 2^i)` days; the
+/// last bin also holds everything larger. Difficulty bin `i` covers
+/// `1 + [i, i + 1) * 9 / 20`, with 10 in the last bin.
+pub const COLLECTION_STATS_BINS: usize = 20;
+/// Number of days covered by the due forecast of `CollectionStats`.
+pub const COLLECTION_STATS_FORECAST_DAYS: usize = 30;
+
+/// Cards per parallel task; each task counts into its own set of counters.
+const CARDS_PER_TASK: usize = 16 * 1024;
+
+/// Aggregate statistics of a collection of cards on one day.
+///
+/// Reviewed cards are those with a positive stability; means and histograms only cover
+/// them, while the forecast covers every card.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct CollectionStats {
+    pub cards: u64,
+    pub reviewed_cards: u64,
+    pub mean_retrievability: f64,
+    pub mean_stability: f64,
+    pub mean_difficulty: f64,
+    pub retrievability_histogram: [u64; COLLECTION_STATS_BINS],
+    pub stability_histogram: [u64; COLLECTION_STATS_BINS],
+    pub difficulty_histogram: [u64; COLLECTION_STATS_BINS],
+    /// Cards due before the given day.
+    pub overdue_cards: u64,
+    /// Element `i` counts the cards due `i` days after the given day.
+    pub due_forecast: [u64; COLLECTION_STATS_FORECAST_DAYS],
+}
+
+/// Running totals of one parallel task.
+#[derive(Clone, Copy)]
+struct Totals {
+    stats: CollectionStats,
+    retrievability: f64,
+    stability: f64,
+    difficulty: f64,
+}
+
+impl Totals {
+    fn new() -> Self {
+        Totals {
+            stats: CollectionStats {
+                cards: 0,
+                reviewed_cards: 0,
+                mean_retrievability: 0.0,
+                mean_stability: 0.0,
+                mean_difficulty: 0.0,
+                retrievability_histogram: [0; COLLECTION_STATS_BINS],
+                stability_histogram: [0; COLLECTION_STATS_BINS],
+                difficulty_histogram: [0; COLLECTION_STATS_BINS],
+                overdue_cards: 0,
+                due_forecast: [0; COLLECTION_STATS_FORECAST_DAYS],
+            },
+            retrievability: 0.0,
+            stability: 0.0,
+            difficulty: 0.0,
+        }
+    }
+
+    fn add_card(&mut self, card: &CardState, curve: &ForgettingCurve, today: i32) {
+        let stats = &mut self.stats;
+        stats.cards += 1;
+        let days_until_due = card.due_day as i64 - today as i64;
+        if days_until_due < 0 {
+            stats.overdue_cards += 1;
+        } else if let Some(due) = stats.due_forecast.get_mut(days_until_due as usize) {
+            *due += 1;
+        }
+
+        let stability = card.memory.stability;
+        if stability <= 0.0 {
+            return;
+        }
+        let difficulty = card.memory.difficulty;
+        let days_elapsed = (today as i64 - card.last_review_day as i64).max(0) as f32;
+        let retrievability = curve.retrievability(stability, days_elapsed);
+        let bins = COLLECTION_STATS_BINS as f32;
+        stats.reviewed_cards += 1;
+        stats.retrievability_histogram[bin(retrievability * bins)] += 1;
+        stats.stability_histogram[stability_bin(stability)] += 1;
+        stats.difficulty_histogram[bin((difficulty - 1.0) * bins / 9.0)] += 1;
+        self.retrievability += retrievability as f64;
+        self.stability += stability as f64;
+        self.difficulty += difficulty as f64;
+    }
+
+    fn add(mut self, other: Self) -> Self {
+        let (a, b) = (&mut self.stats, &other.stats);
+        a.cards += b.cards;
+        a.reviewed_cards += b.reviewed_cards;
+        a.overdue_cards += b.overdue_cards;
+        let counters = [
+            (
+                &mut a.retrievability_histogram[..],
+                &b.retrievability_histogram[..],
+            ),
+            (&mut a.stability_histogram[..], &b.stability_histogram[..]),
+            (&mut a.difficulty_histogram[..], &b.difficulty_histogram[..]),
+            (&mut a.due_forecast[..], &b.due_forecast[..]),
+        ];
+        for (a, b) in counters {
+            for (a, b) in a.iter_mut().zip(b) {
+                *a += b;
+            }
+        }
+        self.retrievability += other.retrievability;
+        self.stability += other.stability;
+        self.difficulty += other.difficulty;
+        self
+    }
+}
+
+/// The histogram bin of `position`, clamped to the first and last bins.
+fn bin(position: f32) -> usize {
+    // `as` saturates, so negative values and NaN land in bin 0.
+    (position as usize).min(COLLECTION_STATS_BINS - 1)
+}
+
+/// The stability histogram bin of `stability`, `floor(log2(stability)) + 1` clamped to
+/// the bins, read from the exponent bits of the positive float.
+fn stability_bin(stability: f32) -> usize {
+    let exponent = ((stability.to_bits() >> 23) & 0xff) as i32 - 126;
+    exponent.clamp(0, COLLECTION_STATS_BINS as i32 - 1) as usize
+}
+
+/// Computes aggregate statistics of `len` cards on day `today`.
+///
+/// Retrievability is evaluated on the forgetting curve of the handle's parameters, as
+/// of `today`. Cards are processed in parallel on the shared pool in a single pass, each
+/// task counting into its own fixed-size bins, which are summed at the end.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `cards` pointer must be a valid pointer to an array of CardState with `len` elements.
+/// The `stats` pointer must be a valid pointer to a CollectionStats instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_collection_stats(
+    fsrs: *const FSRS,
+    cards: *const CardState,
+    len: usize,
+    today: i32,
+    stats: *mut CollectionStats,
+) {
+    let fsrs = unsafe { &*fsrs };
+    let cards = unsafe { slice(cards, len) };
+    let curve = fsrs.forgetting_curve();
+    let totals = cards
+        .par_chunks(CARDS_PER_TASK)
+        .map(|chunk| {
+            let mut totals = Totals::new();
+            for card in chunk {
+                totals.add_card(card, &curve, today);
+            }
+            totals
+        })
+        .reduce(Totals::new, Totals::add);
+
+    let mut result = totals.stats;
+    if result.reviewed_cards > 0 {
+        let reviewed = result.reviewed_cards as f64;
+        result.mean_retrievability = totals.retrievability / reviewed;
+        result.mean_stability = totals.stability / reviewed;
+        result.mean_difficulty = totals.difficulty / reviewed;
+    }
+    unsafe { *stats = result };
+}
@@ -0,0 +1,253 @@
+use crate::{slice, slice_mut};
+
+/// Interval ranges and the share of each that may be added as fuzz, as in Anki.
+const FUZZ_RANGES: [(f32, f32, f32); 3] = [
+    (2.5, 7.0, 0.15),
+    (7.0, 20.0, 0.1),
+    (20.0, f32::INFINITY, 0.05),
+];
+/// Longest interval, in days, a card can be given; longer intervals are shortened to it.
+const MAX_INTERVAL: f32 = 36_500.0;
+/// Days a histogram tracks from its first day; cards due later are not counted.
+const MAX_HISTOGRAM_DAYS: usize = 1 << 17;
+
+/// Counts of cards due on each day, from `first_day` onwards.
+///
+/// Days before `first_day` are not tracked. The histogram grows as later days are used,
+/// up to 131072 days (about 360 years) after `first_day`.
+pub struct DueHistogram {
+    first_day: i32,
+    /// Segment tree over the tracked days: the count for day `first_day + i` is the leaf
+    /// at `mins[leaves + i]`, and every inner node holds the least count below it. Index
+    /// 0 is unused.
+    mins: Vec<u32>,
+}
+
+impl DueHistogram {
+    fn leaves(&self) -> usize {
+        self.mins.len() / 2
+    }
+
+    fn index(&self, day: i32) -> Option<usize> {
+        usize::try_from(day.checked_sub(self.first_day)?)
+            .ok()
+            .filter(|&i| i < MAX_HISTOGRAM_DAYS)
+    }
+
+    fn count(&self, day: i32) -> u32 {
+        self.index(day)
+            .filter(|&i| i < self.leaves())
+            .map_or(0, |i| self.mins[self.leaves() + i])
+    }
+
+    fn add(&mut self, day: i32) {
+        let Some(i) = self.index(day) else {
+            return;
+        };
+        if i >= self.leaves() {
+            self.grow((i + 1).next_power_of_two());
+        }
+        let mut node = self.leaves() + i;
+        self.mins[node] += 1;
+        while node > 1 {
+            node /= 2;
+            self.mins[node] = self.mins[2 * node].min(self.mins[2 * node + 1]);
+        }
+    }
+
+    fn grow(&mut self, leaves: usize) {
+        let mut mins = vec![0; 2 * leaves];
+        mins[leaves..leaves + self.leaves()].copy_from_slice(&self.mins[self.leaves()..]);
+        for node in (1..leaves).rev() {
+            mins[node] = mins[2 * node].min(mins[2 * node + 1]);
+        }
+        self.mins = mins;
+    }
+
+    /// Returns the least count among leaves `start..=end` and the leftmost node holding it
+    /// that covers only leaves in that range.
+    fn min_node(
+        &self,
+        node: usize,
+        first: usize,
+        last: usize,
+        start: usize,
+        end: usize,
+    ) -> (u32, usize) {
+        if start <= first && last <= end {
+            return (self.mins[node], node);
+        }
+        let middle = first + (last - first) / 2;
+        if end <= middle {
+            return self.min_node(2 * node, first, middle, start, end);
+        }
+        if start > middle {
+            return self.min_node(2 * node + 1, middle + 1, last, start, end);
+        }
+        let left = self.min_node(2 * node, first, middle, start, end);
+        let right = self.min_node(2 * node + 1, middle + 1, last, start, end);
+        if right.0 < left.0 { right } else { left }
+    }
+
+    /// Returns the count of the least loaded day in `start..=end` and that day, the
+    /// earliest one on ties. Untracked days count as empty.
+    ///
+    /// Which day is least loaded depends on every count in the window, so there is no
+    /// closed form; the tree answers in time logarithmic in the tracked span instead of
+    /// linear in the window, which is up to about 3650 days wide.
+    fn least_loaded(&self, start: i32, end: i32) -> (u32, i32) {
+        let tracked_end = i64::from(self.first_day) + self.leaves() as i64;
+        if start < self.first_day || i64::from(start) >= tracked_end {
+            return (0, start);
+        }
+        let first = (start - self.first_day) as usize;
+        let last = ((i64::from(end).min(tracked_end - 1)) - i64::from(self.first_day)) as usize;
+        let (count, mut node) = self.min_node(1, 0, self.leaves() - 1, first, last);
+        if count > 0 && i64::from(end) >= tracked_end {
+            // The first day past the tracked ones is empty
+            return (0, tracked_end as i32);
+        }
+        while node < self.leaves() {
+            node *= 2;
+            if self.mins[node] != count {
+                node += 1;
+            }
+        }
+        (count, self.first_day + (node - self.leaves()) as i32)
+    }
+}
+
+/// Returns the inclusive range of intervals a card with `interval` may be given, or
+/// None if `interval` is NaN or infinite.
+fn fuzz_range(interval: f32) -> Option<(i32, i32)> {
+    if !interval.is_finite() {
+        return None;
+    }
+    let interval = interval.min(MAX_INTERVAL);
+    if interval < 2.5 {
+        let interval = interval.round().max(1.0) as i32;
+        return Some((interval, interval));
+    }
+    let delta: f32 = FUZZ_RANGES
+        .iter()
+        .map(|&(start, end, factor)| factor * (interval.min(end) - start).max(0.0))
+        .sum::<f32>()
+        + 1.0;
+    let max = (interval + delta).round() as i32;
+    let min = ((interval - delta).round() as i32).max(2).min(max);
+    Some((min, max))
+}
+
+/// SplitMix64, used to break ties between equally loaded days reproducibly.
+pub(crate) fn mix(mut x: u64) -> u64 {
+    x = x.wrapping_add(0x9e37_79b9_7f4a_7c15);
+    x = (x ^ (x >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+    x = (x ^ (x >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+    x ^ (x >> 31)
+}
+
+/// Creates an empty due histogram starting at `first_day`.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_due_histogram_new(first_day: i32) -> *mut DueHistogram {
+    Box::into_raw(Box::new(DueHistogram {
+        first_day,
+        mins: Vec::new(),
+    }))
+}
+
+/// Frees the memory allocated for a DueHistogram instance.
+///
+/// # Safety
+///
+/// The `histogram` pointer must be a valid pointer to a DueHistogram instance created by `fsrs_due_histogram_new`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_due_histogram_free(histogram: *mut DueHistogram) {
+    if !histogram.is_null() {
+        unsafe { drop(Box::from_raw(histogram)) };
+    }
+}
+
+/// Records cards that are already due on `due_days`, e.g. the rest of the collection.
+///
+/// # Safety
+///
+/// The `histogram` pointer must be a valid pointer to a DueHistogram instance.
+/// The `due_days` pointer must be a valid pointer to an array of i32 with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_due_histogram_add(
+    histogram: *mut DueHistogram,
+    due_days: *const i32,
+    len: usize,
+) {
+    let histogram = unsafe { &mut *histogram };
+    for &day in unsafe { slice(due_days, len) } {
+        histogram.add(day);
+    }
+}
+
+/// Returns the number of cards recorded as due on `day`.
+///
+/// # Safety
+///
+/// The `histogram` pointer must be a valid pointer to a DueHistogram instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_due_histogram_count(histogram: *const DueHistogram, day: i32) -> u32 {
+    unsafe { &*histogram }.count(day)
+}
+
+/// Assigns fuzzed, load-balanced due days to a batch of cards.
+///
+/// Card `i` was last reviewed on `last_review_days[i]` and should be shown again after
+/// `intervals[i]` days, e.g. an interval from `fsrs_next_states`. Its interval is widened
+/// to Anki's fuzz range (about ±5% for long intervals; intervals below 2.5 days are only
+/// rounded), and the card is placed on the day in that window with the fewest cards
+/// in `histogram`, ties broken pseudo-randomly from `seed`. The histogram is updated as
+/// cards are placed, so later cards in the batch see earlier ones. Placing a card takes
+/// time logarithmic in the histogram's span, however wide its window.
+///
+/// Intervals are capped at 36500 days. A card whose interval is NaN
+/// or infinite is not assigned, and its element of `due_days` is left unchanged.
+/// Returns the number of cards assigned.
+///
+/// # Safety
+///
+/// The `histogram` pointer must be a valid pointer to a DueHistogram instance.
+/// The `intervals`, `last_review_days` and `due_days` pointers must be valid pointers to arrays with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_assign_due_days(
+    histogram: *mut DueHistogram,
+    intervals: *const f32,
+    last_review_days: *const i32,
+    due_days: *mut i32,
+    len: usize,
+    seed: u64,
+) -> usize {
+    let histogram = unsafe { &mut *histogram };
+    let intervals = unsafe { slice(intervals, len) };
+    let last_review_days = unsafe { slice(last_review_days, len) };
+    let due_days = unsafe { slice_mut(due_days, len) };
+
+    let mut assigned = 0;
+    for (i, due_day) in due_days.iter_mut().enumerate() {
+        let Some((min, max)) = fuzz_range(intervals[i]) else {
+            continue;
+        };
+        let first = last_review_days[i].saturating_add(min);
+        let last = last_review_days[i].saturating_add(max);
+        let width = (max - min) as u64 + 1;
+        // Search the window from a random start, wrapping around, so ties do not all go
+        // to its first day.
+        let start = first.saturating_add((mix(seed ^ mix(i as u64)) % width) as i32);
+        let mut best = histogram.least_loaded(start, last);
+        if start > first {
+            let wrapped = histogram.least_loaded(first, start - 1);
+            if wrapped.0 < best.0 {
+                best = wrapped;
+            }
+        }
+        *due_day = best.1;
+        histogram.add(best.1);
+        assigned += 1;
+    }
+    assigned
+}
@@ -0,0 +1,177 @@
+use rayon::prelude::*;
+
+use crate::history::{FsrsReviewHistories, Histories};
+use crate::{FSRSReview, slice_mut};
+
+/// Cards per parallel task when filtering histories.
+const MIN_CARDS_PER_TASK: usize = 1024;
+
+/// Rules for `fsrs_review_histories_filter`.
+///
+/// Start from `fsrs_history_filter_default` so that rules added later keep their
+/// default values.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct HistoryFilter {
+    /// Drop reviews rated outside 1-4, such as the rating 0 Anki logs for manual
+    /// reschedules. Their `delta_t` is added to the next review's. Defaults to true.
+    pub drop_manual: bool,
+    /// Drop a review with `delta_t` 0 and the same rating as the review kept before it,
+    /// e.g. an answer recorded twice. Histories only have day resolution, so this also
+    /// drops genuine same-day learning steps such as Again followed by Again; enable it
+    /// only for sources known to log answers twice. Defaults to false.
+    pub drop_duplicates: bool,
+    /// Drop every review of a card with a `delta_t` above this many days, which usually
+    /// comes from a broken clock or import. 0 disables the rule. Defaults to 36500.
+    pub max_delta_t: u32,
+}
+
+impl Default for HistoryFilter {
+    fn default() -> Self {
+        HistoryFilter {
+            drop_manual: true,
+            drop_duplicates: false,
+            max_delta_t: 36_500,
+        }
+    }
+}
+
+/// What `fsrs_review_histories_filter` dropped, per rule.
+#[repr(C)]
+#[derive(Clone, Copy, Default)]
+pub struct HistoryFilterCounts {
+    /// Reviews dropped by `drop_manual`.
+    pub manual_reviews: usize,
+    /// Reviews dropped by `drop_duplicates`.
+    pub duplicate_reviews: usize,
+    /// Cards emptied by `max_delta_t`.
+    pub extreme_delta_t_cards: usize,
+    /// Reviews those cards had.
+    pub extreme_delta_t_reviews: usize,
+}
+
+impl HistoryFilterCounts {
+    fn add(mut self, other: Self) -> Self {
+        self.manual_reviews += other.manual_reviews;
+        self.duplicate_reviews += other.duplicate_reviews;
+        self.extreme_delta_t_cards += other.extreme_delta_t_cards;
+        self.extreme_delta_t_reviews += other.extreme_delta_t_reviews;
+        self
+    }
+}
+
+/// Writes the reviews of one card that pass `filter` to the start of `out` and returns
+/// how many there are.
+fn filter_card(
+    filter: &HistoryFilter,
+    reviews: &[FSRSReview],
+    out: &mut [FSRSReview],
+    counts: &mut HistoryFilterCounts,
+) -> usize {
+    let mut kept = 0;
+    let mut carried = 0u32;
+    let mut manual = 0;
+    let mut duplicates = 0;
+    for review in reviews {
+        if filter.drop_manual && !(1..=4).contains(&review.rating) {
+            manual += 1;
+            carried = carried.saturating_add(review.delta_t);
+            continue;
+        }
+        let delta_t = review.delta_t.saturating_add(carried);
+        if filter.drop_duplicates
+            && kept > 0
+            && delta_t == 0
+            && out[kept - 1].rating == review.rating
+        {
+            duplicates += 1;
+            continue;
+        }
+        if filter.max_delta_t > 0 && kept > 0 && delta_t > filter.max_delta_t {
+            counts.extreme_delta_t_cards += 1;
+            counts.extreme_delta_t_reviews += reviews.len();
+            return 0;
+        }
+        out[kept] = FSRSReview {
+            rating: review.rating,
+            delta_t,
+        };
+        kept += 1;
+        carried = 0;
+    }
+    // Time carried over from dropped reviews does not belong before a card's first review.
+    if let Some(first) = out[..kept].first_mut() {
+        first.delta_t = 0;
+    }
+    counts.manual_reviews += manual;
+    counts.duplicate_reviews += duplicates;
+    kept
+}
+
+/// Returns the default history filter.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_history_filter_default() -> HistoryFilter {
+    HistoryFilter::default()
+}
+
+/// Removes manual reschedules, duplicate answers and implausible intervals from review
+/// histories before training, according to `filter`.
+///
+/// The histories that remain are written to `reviews` and `offsets` in the same layout,
+/// keeping every card at its index, so a dropped card becomes an empty history. Cards
+/// are filtered in parallel on the shared pool in one pass over the input, and the
+/// output is then compacted. Returns how much each rule dropped;
+/// `offsets[num_cards]` is the number of reviews kept.
+///
+/// # Safety
+///
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The `filter` pointer must be a valid pointer to a HistoryFilter instance.
+/// The `reviews` pointer must be a valid pointer to an array of FSRSReview with `histories->offsets[num_cards]` elements that does not overlap the input.
+/// The `offsets` pointer must be a valid pointer to an array of size_t with `histories->num_cards + 1` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_review_histories_filter(
+    histories: *const FsrsReviewHistories,
+    filter: *const HistoryFilter,
+    reviews: *mut FSRSReview,
+    offsets: *mut usize,
+) -> HistoryFilterCounts {
+    let num_cards = unsafe { (*histories).num_cards };
+    let histories = unsafe { Histories::new(&*histories) };
+    let filter = unsafe { &*filter };
+    let offsets = unsafe { slice_mut(offsets, num_cards + 1) };
+    let len = (0..num_cards).map(|i| histories.card(i).len()).sum();
+    let out = unsafe { slice_mut(reviews, len) };
+
+    // Each card is first filtered into the part of `out` its input occupies.
+    let mut chunks = Vec::with_capacity(num_cards);
+    let mut rest = &mut *out;
+    for i in 0..num_cards {
+        let (chunk, tail) = rest.split_at_mut(histories.card(i).len());
+        chunks.push(chunk);
+        rest = tail;
+    }
+    let mut kept = vec![0; num_cards];
+    let counts = chunks
+        .into_par_iter()
+        .zip(kept.par_iter_mut())
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|(i, (chunk, kept))| {
+            let mut counts = HistoryFilterCounts::default();
+            *kept = filter_card(filter, histories.card(i), chunk, &mut counts);
+            counts
+        })
+        .reduce(HistoryFilterCounts::default, HistoryFilterCounts::add);
+
+    let mut read = 0;
+    let mut write = 0;
+    for (i, kept) in kept.into_iter().enumerate() {
+        out.copy_within(read..read + kept, write);
+        offsets[i] = write;
+        read += histories.card(i).len();
+        write += kept;
+    }
+    offsets[num_cards] = write;
+    counts
+}
@@ -0,0 +1,217 @@
+use rayon::prelude::*;
+
+use crate::{FSRSItem, FSRSReview, FsrsItems, slice, slice_mut};
+
+const SECONDS_PER_DAY: i64 = 86_400;
+
+/// Reviews per parallel task when converting flat review arrays.
+const MIN_REVIEWS_PER_TASK: usize = 4096;
+
+/// Review histories of many cards in compressed sparse row layout.
+///
+/// The reviews of card `i` are `reviews[offsets[i]..offsets[i + 1]]` in chronological
+/// order, so `offsets` has `num_cards + 1` elements.
+#[repr(C)]
+pub struct FsrsReviewHistories {
+    pub reviews: *const FSRSReview,
+    pub offsets: *const usize,
+    pub num_cards: usize,
+}
+
+/// Timestamped review logs of many cards, laid out like `FsrsReviewHistories`.
+///
+/// Review `k` happened at Unix time `timestamps[k]` (seconds) with rating `ratings[k]`.
+#[repr(C)]
+pub struct FsrsReviewLogs {
+    pub timestamps: *const i64,
+    pub ratings: *const u32,
+    pub offsets: *const usize,
+    pub num_cards: usize,
+}
+
+/// A borrowed view of `FsrsReviewHistories` that can be shared between threads.
+#[derive(Clone, Copy)]
+pub(crate) struct Histories<'a> {
+    reviews: &'a [FSRSReview],
+    offsets: &'a [usize],
+}
+
+impl<'a> Histories<'a> {
+    /// # Safety
+    ///
+    /// The arrays of `raw` must be valid for the layout described on `FsrsReviewHistories`
+    /// and outlive `'a`.
+    pub(crate) unsafe fn new(raw: &FsrsReviewHistories) -> Self {
+        let offsets = unsafe { slice(raw.offsets, raw.num_cards + 1) };
+        let len = offsets.last().copied().unwrap_or(0);
+        Self {
+            reviews: unsafe { slice(raw.reviews, len) },
+            offsets,
+        }
+    }
+
+    pub(crate) fn num_cards(&self) -> usize {
+        self.offsets.len().saturating_sub(1)
+    }
+
+    /// Returns false if `raw` described `num_cards` cards but a NULL array left them out.
+    pub(crate) fn is_complete(&self, num_cards: usize) -> bool {
+        self.num_cards() == num_cards
+            && self.reviews.len() == self.offsets.last().copied().unwrap_or(0)
+    }
+
+    /// The cards `start..end`, keeping their indices into the full review array.
+    pub(crate) fn range(&self, start: usize, end: usize) -> Self {
+        Self {
+            reviews: self.reviews,
+            offsets: &self.offsets[start..=end],
+        }
+    }
+
+    /// The reviews of card `i`.
+    pub(crate) fn card(&self, i: usize) -> &'a [FSRSReview] {
+        &self.reviews[self.offsets[i]..self.offsets[i + 1]]
+    }
+}
+
+/// Returns the day number of `timestamp`, where `shift` moves day boundaries from
+/// midnight UTC to the caller's local day start.
+fn day_of(timestamp: i64, shift: i64) -> i64 {
+    (timestamp + shift).div_euclid(SECONDS_PER_DAY)
+}
+
+/// Fills `reviews` with the rating and `delta_t` of every review in `logs`.
+///
+/// Days are counted in local time, given as `utc_offset_seconds` east of UTC, and start
+/// at `day_rollover_hour` (e.g. 4 to count a review at 2am towards the previous day).
+/// `delta_t` is the number of day boundaries since the card's previous review: 0 for a
+/// card's first review, for same-day reviews and for out-of-order timestamps. No libc
+/// time functions are called, and the per-review loop is branch-free.
+///
+/// Returns false, leaving `reviews` untouched, if `day_rollover_hour` is 24 or more.
+///
+/// # Safety
+///
+/// The `logs` pointer must be a valid pointer to a FsrsReviewLogs instance whose arrays hold `offsets[num_cards]` reviews.
+/// The `reviews` pointer must be a valid pointer to an array of FSRSReview with `offsets[num_cards]` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_review_histories_from_logs(
+    logs: *const FsrsReviewLogs,
+    utc_offset_seconds: i32,
+    day_rollover_hour: u32,
+    reviews: *mut FSRSReview,
+) -> bool {
+    if day_rollover_hour >= 24 {
+        return false;
+    }
+    let logs = unsafe { &*logs };
+    let offsets = unsafe { slice(logs.offsets, logs.num_cards + 1) };
+    let len = offsets[logs.num_cards];
+    let timestamps = unsafe { slice(logs.timestamps, len) };
+    let ratings = unsafe { slice(logs.ratings, len) };
+    let reviews = unsafe { slice_mut(reviews, len) };
+    let shift = utc_offset_seconds as i64 - day_rollover_hour as i64 * 3600;
+
+    reviews
+        .par_iter_mut()
+        .enumerate()
+        .with_min_len(MIN_REVIEWS_PER_TASK)
+        .for_each(|(k, review)| {
+            let previous = timestamps[k.saturating_sub(1)];
+            let delta = day_of(timestamps[k], shift) - day_of(previous, shift);
+            *review = FSRSReview {
+                rating: ratings[k],
+                delta_t: delta.clamp(0, u32::MAX as i64) as u32,
+            };
+        });
+    // The loop above measured each card's first review against the previous card.
+    for window in offsets.windows(2) {
+        if window[0] < window[1] {
+            reviews[window[0]].delta_t = 0;
+        }
+    }
+    true
+}
+
+/// Builds a training set from many review histories.
+///
+/// Every prefix of a card's history with at least two reviews and at least one positive
+/// `delta_t` becomes one FSRSItem, so a card with `n` reviews yields up to `n - 1` items.
+/// Cards are processed in parallel on the shared pool.
+///
+/// # Safety
+///
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The returned pointer must be freed with `fsrs_items_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_train_set_from_histories(
+    histories: *const FsrsReviewHistories,
+) -> *mut FsrsItems {
+    let histories = unsafe { Histories::new(&*histories) };
+    let items: Vec<Vec<Box<[FSRSReview]>>> = (0..histories.num_cards())
+        .into_par_iter()
+        .map(|i| {
+            let reviews = histories.card(i);
+            (shortest_item(reviews)..=reviews.len())
+                .map(|len| reviews[..len].into())
+                .collect()
+        })
+        .collect();
+    items_into_raw(items)
+}
+
+/// The length of the shortest prefix of `reviews` that is a training item: it has at
+/// least two reviews and a positive `delta_t` after the first. Longer prefixes are items
+/// too, so the card yields the items `shortest_item(reviews)..=reviews.len()`.
+pub(crate) fn shortest_item(reviews: &[FSRSReview]) -> usize {
+    let first_positive = reviews
+        .iter()
+        .skip(1)
+        .position(|review| review.delta_t > 0)
+        .map_or(reviews.len(), |j| j + 1);
+    first_positive.max(1) + 1
+}
+
+/// Hands per-card lists of items to C as one `FsrsItems`, to be freed with `fsrs_items_free`.
+pub(crate) fn items_into_raw(items: Vec<Vec<Box<[FSRSReview]>>>) -> *mut FsrsItems {
+    let items: Box<[FSRSItem]> = items
+        .into_iter()
+        .flatten()
+        .map(|reviews| {
+            let len = reviews.len();
+            FSRSItem {
+                reviews: Box::into_raw(reviews) as *mut FSRSReview,
+                len,
+            }
+        })
+        .collect();
+    let len = items.len();
+    Box::into_raw(Box::new(FsrsItems {
+        items: Box::into_raw(items) as *mut FSRSItem,
+        len,
+    }))
+}
+
+/// Frees a training set created by `fsrs_train_set_from_histories` or
+/// `fsrs_train_set_sample_from_histories`.
+///
+/// # Safety
+///
+/// The `items` pointer must be a valid pointer to a FsrsItems instance created by `fsrs_train_set_from_histories` or `fsrs_train_set_sample_from_histories`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_items_free(items: *mut FsrsItems) {
+    if items.is_null() {
+        return;
+    }
+    let items = unsafe { Box::from_raw(items) };
+    let items =
+        unsafe { Box::from_raw(std::ptr::slice_from_raw_parts_mut(items.items, items.len)) };
+    for item in items.iter() {
+        unsafe {
+            drop(Box::from_raw(std::ptr::slice_from_raw_parts_mut(
+                item.reviews,
+                item.len,
+            )))
+        };
+    }
+}
@@ -0,0 +1,480 @@
+use std::collections::HashMap;
+use std::ffi::{CStr, c_char};
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, Read, Seek, SeekFrom, Write};
+use std::path::{Path, PathBuf};
+
+use crate::history::FsrsReviewLogs;
+use crate::slice;
+
+const JOURNAL_MAGIC: &[u8; 8] = b"FSRSJRNL";
+const SNAPSHOT_MAGIC: &[u8; 8] = b"FSRSSNAP";
+const JOURNAL_VERSION: u32 = 1;
+/// Version 1 snapshots stored ratings as single bytes; version 2 stores them as u32, like
+/// the journal does.
+const SNAPSHOT_VERSION: u32 = 2;
+/// Magic followed by the format version.
+const HEADER_LEN: usize = 12;
+/// Sequence number, card id, timestamp, rating and checksum of one journal record.
+const RECORD_LEN: usize = 32;
+
+/// One review to record in a journal.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct JournalReview {
+    pub card_id: i64,
+    pub timestamp: i64,
+    pub rating: u32,
+}
+
+/// Every review held by a journal, grouped by card.
+///
+/// Card `i` has id `card_ids[i]` and its reviews are laid out as described on
+/// `FsrsReviewLogs`, so `logs` can be passed to `fsrs_review_histories_from_logs`.
+#[repr(C)]
+pub struct JournalContents {
+    pub card_ids: *const i64,
+    pub logs: FsrsReviewLogs,
+}
+
+struct Event {
+    card: usize,
+    timestamp: i64,
+    rating: u32,
+}
+
+/// The reviews of all cards in compressed sparse row layout.
+struct Grouped {
+    timestamps: Vec<i64>,
+    ratings: Vec<u32>,
+    offsets: Vec<usize>,
+}
+
+/// An append-only review journal backed by a compacted snapshot.
+///
+/// Reviews are appended to the journal file as fixed-size, checksummed records with
+/// increasing sequence numbers. Compaction writes every review to the snapshot file and
+/// empties the journal, so opening a journal reads one snapshot plus a short tail.
+pub struct Journal {
+    file: File,
+    file_len: u64,
+    snapshot_path: PathBuf,
+    snapshot_seq: u64,
+    next_seq: u64,
+    pending: usize,
+    card_ids: Vec<i64>,
+    cards: HashMap<i64, usize>,
+    events: Vec<Event>,
+    grouped: Option<Grouped>,
+}
+
+fn fnv1a32(bytes: &[u8]) -> u32 {
+    bytes.iter().fold(0x811c_9dc5, |hash, &byte| {
+        (hash ^ byte as u32).wrapping_mul(0x0100_0193)
+    })
+}
+
+pub(crate) fn fnv1a64(bytes: &[u8]) -> u64 {
+    bytes.iter().fold(0xcbf2_9ce4_8422_2325, |hash, &byte| {
+        (hash ^ byte as u64).wrapping_mul(0x0000_0100_0000_01b3)
+    })
+}
+
+fn invalid_data(message: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message)
+}
+
+fn header(magic: &[u8; 8], version: u32) -> [u8; HEADER_LEN] {
+    let mut header = [0; HEADER_LEN];
+    header[..8].copy_from_slice(magic);
+    header[8..].copy_from_slice(&version.to_le_bytes());
+    header
+}
+
+/// Replaces the file at `path` with `bytes` atomically.
+///
+/// The bytes go to a temporary file next to it, which is synced and renamed over
+/// `path`; the directory is then synced so the rename itself survives a crash.
+pub(crate) fn replace_file(path: &Path, bytes: &[u8]) -> io::Result<()> {
+    let mut temporary = path.as_os_str().to_owned();
+    temporary.push(".tmp");
+    let mut file = File::create(&temporary)?;
+    file.write_all(bytes)?;
+    file.sync_all()?;
+    fs::rename(&temporary, path)?;
+    let directory = path
+        .parent()
+        .filter(|parent| !parent.as_os_str().is_empty())
+        .unwrap_or(Path::new("."));
+    File::open(directory)?.sync_all()
+}
+
+/// Splits the next `N` bytes off `bytes`.
+fn take<const N: usize>(bytes: &mut &[u8]) -> io::Result<[u8; N]> {
+    let (head, rest) = bytes
+        .split_first_chunk::<N>()
+        .ok_or_else(|| invalid_data("truncated snapshot"))?;
+    *bytes = rest;
+    Ok(*head)
+}
+
+fn take_u64(bytes: &mut &[u8]) -> io::Result<u64> {
+    take(bytes).map(u64::from_le_bytes)
+}
+
+fn encode_record(seq: u64, review: &JournalReview, out: &mut Vec<u8>) {
+    let start = out.len();
+    out.extend_from_slice(&seq.to_le_bytes());
+    out.extend_from_slice(&review.card_id.to_le_bytes());
+    out.extend_from_slice(&review.timestamp.to_le_bytes());
+    out.extend_from_slice(&review.rating.to_le_bytes());
+    let checksum = fnv1a32(&out[start..]);
+    out.extend_from_slice(&checksum.to_le_bytes());
+}
+
+/// Returns the sequence number and review of a record, or `None` if it is torn.
+fn decode_record(record: &[u8]) -> Option<(u64, JournalReview)> {
+    let field = |at: usize| -> [u8; 8] { record[at..at + 8].try_into().unwrap() };
+    let rating = u32::from_le_bytes(record[24..28].try_into().unwrap());
+    let checksum = u32::from_le_bytes(record[28..32].try_into().unwrap());
+    (fnv1a32(&record[..28]) == checksum).then(|| {
+        (
+            u64::from_le_bytes(field(0)),
+            JournalReview {
+                card_id: i64::from_le_bytes(field(8)),
+                timestamp: i64::from_le_bytes(field(16)),
+                rating,
+            },
+        )
+    })
+}
+
+impl Journal {
+    fn open(journal_path: &Path, snapshot_path: PathBuf) -> io::Result<Self> {
+        let mut file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(false)
+            .open(journal_path)?;
+        let mut journal = Journal {
+            file: file.try_clone()?,
+            file_len: HEADER_LEN as u64,
+            snapshot_path,
+            snapshot_seq: 0,
+            next_seq: 1,
+            pending: 0,
+            card_ids: Vec::new(),
+            cards: HashMap::new(),
+            events: Vec::new(),
+            grouped: None,
+        };
+        match fs::read(&journal.snapshot_path) {
+            Ok(bytes) => journal.load_snapshot(&bytes)?,
+            Err(error) if error.kind() == io::ErrorKind::NotFound => {}
+            Err(error) => return Err(error),
+        }
+
+        let mut bytes = Vec::new();
+        file.read_to_end(&mut bytes)?;
+        if bytes.len() < HEADER_LEN && header(JOURNAL_MAGIC, JOURNAL_VERSION).starts_with(&bytes) {
+            // A new file, or one whose header write was cut short: nothing was recorded.
+            file.set_len(0)?;
+            file.seek(SeekFrom::Start(0))?;
+            file.write_all(&header(JOURNAL_MAGIC, JOURNAL_VERSION))?;
+            bytes.clear();
+        } else if bytes.len() < HEADER_LEN
+            || bytes[..HEADER_LEN] != header(JOURNAL_MAGIC, JOURNAL_VERSION)
+        {
+            return Err(invalid_data("not a journal file"));
+        }
+
+        // Stop at the first torn or out-of-order record; it and anything after it were
+        // never acknowledged by a successful append.
+        let mut last_seq = 0;
+        let records = bytes.get(HEADER_LEN..).unwrap_or_default();
+        for record in records.chunks_exact(RECORD_LEN) {
+            let Some((seq, review)) = decode_record(record).filter(|(seq, _)| *seq > last_seq)
+            else {
+                break;
+            };
+            last_seq = seq;
+            journal.file_len += RECORD_LEN as u64;
+            if seq > journal.snapshot_seq {
+                journal.push(review);
+                journal.pending += 1;
+            }
+        }
+        journal.next_seq = journal.next_seq.max(last_seq + 1);
+        if journal.file_len < bytes.len().max(HEADER_LEN) as u64 {
+            journal.file.set_len(journal.file_len)?;
+        }
+        journal.file.seek(SeekFrom::Start(journal.file_len))?;
+        Ok(journal)
+    }
+
+    fn load_snapshot(&mut self, bytes: &[u8]) -> io::Result<()> {
+        let (body, checksum) = bytes
+            .split_last_chunk::<8>()
+            .ok_or_else(|| invalid_data("truncated snapshot"))?;
+        if fnv1a64(body) != u64::from_le_bytes(*checksum) {
+            return Err(invalid_data("snapshot checksum mismatch"));
+        }
+        let mut body = body;
+        let rating_len = match take::<HEADER_LEN>(&mut body)? {
+            found if found == header(SNAPSHOT_MAGIC, 1) => 1,
+            found if found == header(SNAPSHOT_MAGIC, SNAPSHOT_VERSION) => 4,
+            _ => return Err(invalid_data("not a snapshot file")),
+        };
+        let seq = take_u64(&mut body)?;
+        let num_cards = take_u64(&mut body)? as usize;
+        let num_reviews = take_u64(&mut body)? as usize;
+        let expected_len = num_cards
+            .checked_mul(16)
+            .zip(num_reviews.checked_mul(8 + rating_len))
+            .and_then(|(cards, reviews)| cards.checked_add(reviews)?.checked_add(8));
+        if expected_len != Some(body.len()) {
+            return Err(invalid_data("snapshot size mismatch"));
+        }
+        let card_ids = (0..num_cards)
+            .map(|_| take(&mut body).map(i64::from_le_bytes))
+            .collect::<io::Result<Vec<_>>>()?;
+        let offsets = (0..=num_cards)
+            .map(|_| take_u64(&mut body).map(|offset| offset as usize))
+            .collect::<io::Result<Vec<_>>>()?;
+        if offsets[0] != 0
+            || offsets[num_cards] != num_reviews
+            || offsets.windows(2).any(|pair| pair[0] > pair[1])
+        {
+            return Err(invalid_data("snapshot offsets out of order"));
+        }
+        let (timestamps, ratings) = body.split_at(num_reviews * 8);
+        for (card, card_id) in card_ids.into_iter().enumerate() {
+            for k in offsets[card]..offsets[card + 1] {
+                self.push(JournalReview {
+                    card_id,
+                    timestamp: i64::from_le_bytes(timestamps[k * 8..k * 8 + 8].try_into().unwrap()),
+                    rating: match rating_len {
+                        1 => ratings[k] as u32,
+                        _ => u32::from_le_bytes(ratings[k * 4..k * 4 + 4].try_into().unwrap()),
+                    },
+                });
+            }
+            // Cards are kept even without reviews, so their index stays stable.
+            self.card(card_id);
+        }
+        self.snapshot_seq = seq;
+        self.next_seq = seq + 1;
+        Ok(())
+    }
+
+    fn card(&mut self, card_id: i64) -> usize {
+        *self.cards.entry(card_id).or_insert_with(|| {
+            self.card_ids.push(card_id);
+            self.card_ids.len() - 1
+        })
+    }
+
+    fn push(&mut self, review: JournalReview) {
+        let card = self.card(review.card_id);
+        self.events.push(Event {
+            card,
+            timestamp: review.timestamp,
+            rating: review.rating,
+        });
+        self.grouped = None;
+    }
+
+    fn append(&mut self, reviews: &[JournalReview]) -> io::Result<()> {
+        let mut records = Vec::with_capacity(reviews.len() * RECORD_LEN);
+        for (i, review) in reviews.iter().enumerate() {
+            encode_record(self.next_seq + i as u64, review, &mut records);
+        }
+        if let Err(error) = self.file.write_all(&records) {
+            // Drop any partial write so the sequence numbers stay increasing.
+            let _ = self.file.set_len(self.file_len);
+            let _ = self.file.seek(SeekFrom::Start(self.file_len));
+            return Err(error);
+        }
+        self.file_len += records.len() as u64;
+        self.next_seq += reviews.len() as u64;
+        self.pending += reviews.len();
+        for review in reviews {
+            self.push(*review);
+        }
+        Ok(())
+    }
+
+    /// Groups the reviews by card, keeping each card's reviews in append order.
+    fn grouped(&mut self) -> &Grouped {
+        self.grouped.get_or_insert_with(|| {
+            let mut offsets = vec![0; self.card_ids.len() + 1];
+            for event in &self.events {
+                offsets[event.card + 1] += 1;
+            }
+            for card in 0..self.card_ids.len() {
+                offsets[card + 1] += offsets[card];
+            }
+            let mut next = offsets.clone();
+            let mut timestamps = vec![0; self.events.len()];
+            let mut ratings = vec![0; self.events.len()];
+            for event in &self.events {
+                let k = next[event.card];
+                next[event.card] += 1;
+                timestamps[k] = event.timestamp;
+                ratings[k] = event.rating;
+            }
+            Grouped {
+                timestamps,
+                ratings,
+                offsets,
+            }
+        })
+    }
+
+    fn compact(&mut self) -> io::Result<()> {
+        let seq = self.next_seq - 1;
+        let num_cards = self.card_ids.len();
+        let mut out = Vec::from(header(SNAPSHOT_MAGIC, SNAPSHOT_VERSION));
+        out.extend_from_slice(&seq.to_le_bytes());
+        out.extend_from_slice(&(num_cards as u64).to_le_bytes());
+        out.extend_from_slice(&(self.events.len() as u64).to_le_bytes());
+        for card_id in &self.card_ids {
+            out.extend_from_slice(&card_id.to_le_bytes());
+        }
+        let grouped = self.grouped();
+        for &offset in &grouped.offsets {
+            out.extend_from_slice(&(offset as u64).to_le_bytes());
+        }
+        for timestamp in &grouped.timestamps {
+            out.extend_from_slice(&timestamp.to_le_bytes());
+        }
+        for rating in &grouped.ratings {
+            out.extend_from_slice(&rating.to_le_bytes());
+        }
+        let checksum = fnv1a64(&out);
+        out.extend_from_slice(&checksum.to_le_bytes());
+
+        // Replace the snapshot atomically, then drop the journal records it now holds.
+        // A crash in between leaves records the next open skips by sequence number.
+        replace_file(&self.snapshot_path, &out)?;
+        self.snapshot_seq = seq;
+
+        self.file.set_len(HEADER_LEN as u64)?;
+        self.file.seek(SeekFrom::Start(HEADER_LEN as u64))?;
+        self.file.sync_all()?;
+        self.file_len = HEADER_LEN as u64;
+        self.pending = 0;
+        Ok(())
+    }
+}
+
+/// Opens a review journal, creating its file if needed.
+///
+/// Loads the snapshot at `snapshot_path`, if there is one, and the reviews appended to
+/// the journal at `journal_path` since it was written. A torn record at the end of the
+/// journal, left by a crash during an append, is discarded, and a journal whose header
+/// was only partly written is treated as empty and written again. Returns NULL if either
+/// file cannot be read or is not in the expected format.
+///
+/// # Safety
+///
+/// The `journal_path` and `snapshot_path` pointers must be valid pointers to null-terminated UTF-8 strings.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_open(
+    journal_path: *const c_char,
+    snapshot_path: *const c_char,
+) -> *mut Journal {
+    let (Ok(journal_path), Ok(snapshot_path)) = (
+        unsafe { CStr::from_ptr(journal_path) }.to_str(),
+        unsafe { CStr::from_ptr(snapshot_path) }.to_str(),
+    ) else {
+        return std::ptr::null_mut();
+    };
+    match Journal::open(Path::new(journal_path), PathBuf::from(snapshot_path)) {
+        Ok(journal) => Box::into_raw(Box::new(journal)),
+        Err(_) => std::ptr::null_mut(),
+    }
+}
+
+/// Closes a journal and frees its memory.
+///
+/// # Safety
+///
+/// The `journal` pointer must be a valid pointer to a Journal instance created by `fsrs_journal_open`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_free(journal: *mut Journal) {
+    if !journal.is_null() {
+        unsafe { drop(Box::from_raw(journal)) };
+    }
+}
+
+/// Appends reviews to the journal with a single write.
+///
+/// Only the new records are written; the data reaches the operating system before the
+/// call returns but is not synced to disk. Returns false, recording none of the reviews,
+/// if the write fails.
+///
+/// # Safety
+///
+/// The `journal` pointer must be a valid pointer to a Journal instance.
+/// The `reviews` pointer must be a valid pointer to an array of JournalReview with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_append(
+    journal: *mut Journal,
+    reviews: *const JournalReview,
+    len: usize,
+) -> bool {
+    let journal = unsafe { &mut *journal };
+    journal.append(unsafe { slice(reviews, len) }).is_ok()
+}
+
+/// Returns the number of reviews in the journal file that are not yet in the snapshot.
+///
+/// # Safety
+///
+/// The `journal` pointer must be a valid pointer to a Journal instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_pending(journal: *const Journal) -> usize {
+    unsafe { &*journal }.pending
+}
+
+/// Writes every review to a new snapshot and empties the journal file.
+///
+/// The snapshot is written to a temporary file and synced before it replaces the old
+/// one, and the directory is synced after the rename, so a crash never leaves a partial
+/// snapshot behind or loses the new one. Returns false if writing
+/// fails; the journal then keeps its records.
+///
+/// # Safety
+///
+/// The `journal` pointer must be a valid pointer to a Journal instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_compact(journal: *mut Journal) -> bool {
+    unsafe { &mut *journal }.compact().is_ok()
+}
+
+/// Returns every review in the journal, grouped by card in the order cards first appeared.
+///
+/// The arrays are owned by the journal and stay valid until the next call that appends
+/// to, compacts or frees it.
+///
+/// # Safety
+///
+/// The `journal` pointer must be a valid pointer to a Journal instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_journal_contents(journal: *mut Journal) -> JournalContents {
+    let journal = unsafe { &mut *journal };
+    let num_cards = journal.card_ids.len();
+    let card_ids = journal.card_ids.as_ptr();
+    let grouped = journal.grouped();
+    JournalContents {
+        card_ids,
+        logs: FsrsReviewLogs {
+            timestamps: grouped.timestamps.as_ptr(),
+            ratings: grouped.ratings.as_ptr(),
+            offsets: grouped.offsets.as_ptr(),
+            num_cards,
+        },
+    }
+}
@@ -1,7 +1,92 @@
-use fsrs::{self, ComputeParametersInput};
+mod apply;
+mod batch;
+mod cache;
+mod card_store;
+mod checkpoint;
+mod collection;
+mod due;
+mod filter;
+mod history;
+mod journal;
+mod memory;
+mod migration;
+mod packed;
+mod parallel;
+mod progress;
+mod reschedule;
+mod ring;
+mod sample;
+mod simulation;
+mod snapshot;
+mod stats;
+mod trace;
+mod training;
 
-// Opaque handle for FSRS - not exported to C header
-pub struct FSRS(pub fsrs::FSRS);
+pub use apply::{ReviewEvent, fsrs_apply_reviews};
+pub use batch::{fsrs_next_states_batch, fsrs_next_states_batch_multi, fsrs_retrievability_batch};
+pub use cache::{
+    HandleCache, fsrs_handle_cache_acquire, fsrs_handle_cache_new, fsrs_handle_cache_release,
+};
+use training::TrainingConfig;
+
+/// Opaque handle for FSRS.
+///
+/// A handle is immutable once `fsrs_new` has returned it, so any number of threads
+/// may pass the same `const fsrs_FSRS*` to the other functions concurrently. No lock
+/// is taken on that path; each call works on its own temporaries. Only `fsrs_free`
+/// must not race with other uses of the handle.
+pub struct FSRS {
+    model: fsrs::FSRS,
+    parameters: Vec<f32>,
+}
+
+// SAFETY: the wrapped model is only read after construction, and every inference
+// call allocates its own tensors, so sharing `&FSRS` between threads is sound.
+unsafe impl Sync for FSRS {}
+
+impl FSRS {
+    /// Builds a model; `None` or an empty slice selects the default parameters.
+    pub(crate) fn new(parameters: Option<&[f32]>) -> Result<Self, fsrs::FSRSError> {
+        let parameters = parameters
+            .filter(|parameters| !parameters.is_empty())
+            .unwrap_or(&fsrs::DEFAULT_PARAMETERS);
+        Ok(Self {
+            model: fsrs::FSRS::new(Some(parameters))?,
+            parameters: parameters.to_vec(),
+        })
+    }
+
+    /// The forgetting curve of the parameters. Its decay is the last parameter of
+    /// FSRS-6, 0.5 before it.
+    pub(crate) fn forgetting_curve(&self) -> ForgettingCurve {
+        ForgettingCurve::new(self.parameters.get(20).copied().unwrap_or(0.5))
+    }
+}
+
+/// The power forgetting curve with `decay`, chosen so that recall is 90% after
+/// `stability` days.
+#[derive(Clone, Copy)]
+pub(crate) struct ForgettingCurve {
+    decay: f32,
+    factor: f32,
+}
+
+impl ForgettingCurve {
+    pub(crate) fn new(decay: f32) -> Self {
+        Self {
+            decay,
+            factor: 0.9f32.powf(-1.0 / decay) - 1.0,
+        }
+    }
+
+    /// The probability of recalling a memory of `stability` after `days_elapsed` days.
+    pub(crate) fn retrievability(&self, stability: f32, days_elapsed: f32) -> f32 {
+        if stability <= 0.0 {
+            return 0.0;
+        }
+        (1.0 + self.factor * days_elapsed / stability).powf(-self.decay)
+    }
+}
 
 #[repr(C)]
 pub struct FsrsItems {
@@ -16,7 +101,7 @@ pub struct FsrsReviews {
 }
 
 #[repr(C)]
-#[derive(Clone)]
+#[derive(Clone, Copy)]
 pub struct MemoryState {
     pub stability: f32,
     pub difficulty: f32,
@@ -54,17 +139,22 @@ pub struct FSRSReview {
 
 /// Creates a new FSRS instance.
 ///
+/// The returned handle may be shared between threads; see `fsrs_FSRS`.
+///
 /// # Safety
 ///
 /// The `parameters` pointer must be a valid pointer to an array of f32 with `len` elements.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn fsrs_new(parameters: *const f32, len: usize) -> *const FSRS {
+    let timer = stats::start();
     let params = if parameters.is_null() {
         None
     } else {
         Some(unsafe { std::slice::from_raw_parts(parameters, len) })
     };
-    Box::into_raw(Box::new(FSRS(fsrs::FSRS::new(params).unwrap())))
+    let fsrs = Box::into_raw(Box::new(FSRS::new(params).unwrap()));
+    stats::NEW.record(timer);
+    fsrs
 }
 
 /// Frees the memory allocated for an FSRS instance.
@@ -81,6 +171,8 @@ pub unsafe extern "C" fn fsrs_free(fsrs: *const FSRS) {
 
 /// Computes the next states for a card.
 ///
+/// Safe to call concurrently from several threads on the same `fsrs` handle.
+///
 /// # Safety
 ///
 /// The `fsrs` pointer must be a valid pointer to an FSRS instance.
@@ -92,17 +184,20 @@ pub unsafe extern "C" fn fsrs_next_states(
     desired_retention: f32,
     days_elapsed: u32,
 ) -> *mut NextStates {
+    let timer = stats::start();
     let fsrs = unsafe { &*fsrs };
     let memory_state = if memory_state.is_null() {
         None
     } else {
-        Some(unsafe { (*memory_state).clone().into() })
+        Some(unsafe { (*memory_state).into() })
     };
     let next_states = fsrs
-        .0
+        .model
         .next_states(memory_state, desired_retention, days_elapsed)
         .unwrap();
-    Box::into_raw(Box::new(next_states.into()))
+    let next_states = Box::into_raw(Box::new(next_states.into()));
+    stats::NEXT_STATES.record(timer);
+    next_states
 }
 
 /// Frees the memory allocated for a NextStates instance.
@@ -159,43 +254,38 @@ pub unsafe extern "C" fn fsrs_next_states_easy(next_states: *const NextStates) -
 
 /// Computes the parameters for a given train set.
 ///
+/// Writes the number of parameters to `len`, e.g. 21 for FSRS-6; pass both to `fsrs_new`
+/// to use them. Returns NULL, with `len` set to 0, if training fails.
+///
 /// # Safety
 ///
 /// The `fsrs` pointer must be a valid pointer to an FSRS instance.
 /// The `train_set` pointer must be a valid pointer to an array of FSRSItem.
+/// The `len` pointer must be a valid pointer to a size_t.
+/// The returned pointer must be freed with `fsrs_parameters_free`.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn fsrs_compute_parameters(
     fsrs: *const FSRS,
     train_set: *mut FsrsItems,
+    len: *mut usize,
 ) -> *mut f32 {
-    let fsrs = unsafe { &*fsrs };
-    let train_set = unsafe {
-        std::slice::from_raw_parts((*train_set).items, (*train_set).len)
-            .iter()
-            .map(|item| (*item).clone().into())
-            .collect()
-    };
-    let params = fsrs
-        .0
-        .compute_parameters(ComputeParametersInput {
-            train_set,
-            progress: None,
-            enable_short_term: true,
-            num_relearning_steps: None,
-        })
-        .unwrap_or_default();
-    Box::into_raw(params.into_boxed_slice()) as *mut f32
+    unsafe { training::compute_parameters(fsrs, train_set, &TrainingConfig::default(), len) }
 }
 
 /// Frees the memory allocated for the parameters.
 ///
 /// # Safety
 ///
-/// The `params` pointer must be a valid pointer to the parameters created by `fsrs_compute_parameters`.
+/// The `params` pointer must be a valid pointer to the parameters created by `fsrs_compute_parameters`,
+/// and `len` the count it reported.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn fsrs_parameters_free(params: *mut f32) {
+pub unsafe extern "C" fn fsrs_parameters_free(params: *mut f32, len: usize) {
     if !params.is_null() {
-        unsafe { drop(Box::from_raw(params)) };
+        unsafe {
+            drop(Box::from_raw(std::ptr::slice_from_raw_parts_mut(
+                params, len,
+            )))
+        };
     }
 }
 
@@ -227,16 +317,19 @@ pub unsafe extern "C" fn fsrs_memory_state_free(memory_state: *mut MemoryState)
 /// The `reviews` pointer must be a valid pointer to an array of FSRSReview.
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn fsrs_item_new(reviews: *mut FsrsReviews) -> *mut FSRSItem {
+    let timer = stats::start();
     let review_slice = unsafe { std::slice::from_raw_parts((*reviews).reviews, (*reviews).len) };
     let review_vec: Vec<FSRSReview> = review_slice.to_vec();
     let review_box = review_vec.into_boxed_slice();
     let reviews_ptr = Box::into_raw(review_box) as *mut FSRSReview;
     let len = unsafe { (*reviews).len };
 
-    Box::into_raw(Box::new(FSRSItem {
+    let item = Box::into_raw(Box::new(FSRSItem {
         reviews: reviews_ptr,
         len,
-    }))
+    }));
+    stats::ITEM_NEW.record(timer);
+    item
 }
 
 /// Frees the memory allocated for an FSRSItem instance.
@@ -274,6 +367,33 @@ pub unsafe extern "C" fn fsrs_review_free(review: *mut FSRSReview) {
     }
 }
 
+/// Views a C array as a slice, treating NULL as empty.
+///
+/// # Safety
+///
+/// If non-null, `ptr` must point to `len` initialized elements that outlive `'a`.
+pub(crate) unsafe fn slice<'a, T>(ptr: *const T, len: usize) -> &'a [T] {
+    if ptr.is_null() || len == 0 {
+        &[]
+    } else {
+        unsafe { std::slice::from_raw_parts(ptr, len) }
+    }
+}
+
+/// Views a C array as a mutable slice, treating NULL as empty.
+///
+/// # Safety
+///
+/// If non-null, `ptr` must point to `len` initialized elements that outlive `'a` and are
+/// not accessed through any other pointer meanwhile.
+pub(crate) unsafe fn slice_mut<'a, T>(ptr: *mut T, len: usize) -> &'a mut [T] {
+    if ptr.is_null() || len == 0 {
+        &mut []
+    } else {
+        unsafe { std::slice::from_raw_parts_mut(ptr, len) }
+    }
+}
+
 // Conversion functions between internal fsrs types and C-compatible types
 impl From<fsrs::MemoryState> for MemoryState {
     fn from(state: fsrs::MemoryState) -> Self {
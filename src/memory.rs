@@ -0,0 +1,193 @@
+#[cfg(feature = "memory-tracking")]
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::mem::size_of;
+use std::sync::atomic::{AtomicBool, AtomicIsize, AtomicU64, Ordering};
+
+// The constants below follow from the data structures training allocates; none has
+// been fitted to a measured training run.
+
+/// Memory the training backend needs regardless of the train set: the model, its
+/// optimizer state, thread pools and their stacks.
+const TRAINING_BASE_BYTES: usize = 64 << 20;
+/// Copies of the train set alive at once during training: the one converted from the
+/// C items, and the filtered and length-sorted copies fsrs makes of it.
+const TRAIN_SET_COPIES: usize = 3;
+/// Bytes of batch tensors per item (delta_t, label and weight, as f32) and per review
+/// (time and rating history, as f32), built for all batches before the first epoch.
+const TENSOR_BYTES_PER_ITEM: usize = 3 * size_of::<f32>();
+const TENSOR_BYTES_PER_REVIEW: usize = 2 * size_of::<f32>();
+/// Bytes the allocator typically adds to each allocation.
+const ALLOCATION_OVERHEAD: usize = 16;
+
+static ENABLED: AtomicBool = AtomicBool::new(false);
+/// Bytes allocated minus bytes freed while tracking; negative if memory allocated
+/// before tracking was enabled has been freed since.
+static CURRENT: AtomicIsize = AtomicIsize::new(0);
+static PEAK: AtomicIsize = AtomicIsize::new(0);
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+/// The system allocator, counting the bytes it hands out while tracking is enabled.
+///
+/// A process has one global allocator, so installing it from a library would override
+/// the choice of every Rust program linking the crate. It is only installed when the
+/// crate is built with the `memory-tracking` feature, e.g. for the C libraries.
+#[cfg(feature = "memory-tracking")]
+struct CountingAllocator;
+
+#[cfg(feature = "memory-tracking")]
+#[global_allocator]
+static ALLOCATOR: CountingAllocator = CountingAllocator;
+
+#[cfg(feature = "memory-tracking")]
+fn track(allocated: usize, freed: usize) {
+    if !ENABLED.load(Ordering::Relaxed) {
+        return;
+    }
+    let delta = allocated as isize - freed as isize;
+    let current = CURRENT.fetch_add(delta, Ordering::Relaxed) + delta;
+    if current > PEAK.load(Ordering::Relaxed) {
+        PEAK.fetch_max(current, Ordering::Relaxed);
+    }
+    if allocated > 0 {
+        ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+#[cfg(feature = "memory-tracking")]
+unsafe impl GlobalAlloc for CountingAllocator {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let ptr = unsafe { System.alloc(layout) };
+        if !ptr.is_null() {
+            track(layout.size(), 0);
+        }
+        ptr
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let ptr = unsafe { System.alloc_zeroed(layout) };
+        if !ptr.is_null() {
+            track(layout.size(), 0);
+        }
+        ptr
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { System.dealloc(ptr, layout) };
+        track(0, layout.size());
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let new_ptr = unsafe { System.realloc(ptr, layout, new_size) };
+        if !new_ptr.is_null() {
+            track(new_size, layout.size());
+        }
+        new_ptr
+    }
+}
+
+/// Heap memory allocated by the library, as counted by `fsrs_memory_usage`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct MemoryUsage {
+    /// Bytes currently allocated.
+    pub current_bytes: usize,
+    /// Most bytes allocated at once since tracking was enabled or the peak was reset.
+    pub peak_bytes: usize,
+    /// Allocations, including reallocations, since tracking was enabled.
+    pub allocations: u64,
+    /// Peak resident set size of the whole process, as reported by the operating system;
+    /// 0 where it is not available. Unlike the other fields, it does not need tracking
+    /// and cannot be reset.
+    pub peak_rss_bytes: usize,
+}
+
+/// Returns the process's peak resident set size from `/proc/self/status`.
+#[cfg(target_os = "linux")]
+fn peak_rss_bytes() -> Option<usize> {
+    let status = std::fs::read_to_string("/proc/self/status").ok()?;
+    let line = status.lines().find(|line| line.starts_with("VmHWM:"))?;
+    let kilobytes: usize = line.split_whitespace().nth(1)?.parse().ok()?;
+    kilobytes.checked_mul(1024)
+}
+
+#[cfg(not(target_os = "linux"))]
+fn peak_rss_bytes() -> Option<usize> {
+    None
+}
+
+/// Enables or disables counting of the library's heap allocations.
+///
+/// Counting needs the library to be built with the `memory-tracking` Cargo feature,
+/// which makes it allocate through a counting wrapper around the system allocator;
+/// without it, this returns false and the counts stay at zero. Tracking is disabled by
+/// default; while disabled, each allocation only pays for one relaxed atomic load.
+/// Enabling resets all counts. Only memory allocated after enabling is counted, so
+/// enable tracking before the work to be measured.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_memory_tracking_enable(enabled: bool) -> bool {
+    if !cfg!(feature = "memory-tracking") {
+        return false;
+    }
+    if enabled {
+        CURRENT.store(0, Ordering::Relaxed);
+        PEAK.store(0, Ordering::Relaxed);
+        ALLOCATIONS.store(0, Ordering::Relaxed);
+    }
+    ENABLED.store(enabled, Ordering::Relaxed);
+    true
+}
+
+/// Copies the current allocation counts into `usage`.
+///
+/// Counts cover the whole process's use of the library rather than one handle or job,
+/// since training and batch calls spread their allocations over the shared worker
+/// threads. To measure one job, run it alone, call `fsrs_memory_reset_peak` before it
+/// starts and read `peak_bytes` when it is done.
+///
+/// # Safety
+///
+/// The `usage` pointer must be a valid pointer to a MemoryUsage instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_memory_usage(usage: *mut MemoryUsage) {
+    unsafe {
+        *usage = MemoryUsage {
+            current_bytes: CURRENT.load(Ordering::Relaxed).max(0) as usize,
+            peak_bytes: PEAK.load(Ordering::Relaxed).max(0) as usize,
+            allocations: ALLOCATIONS.load(Ordering::Relaxed),
+            peak_rss_bytes: peak_rss_bytes().unwrap_or(0),
+        }
+    };
+}
+
+/// Starts a new peak measurement from the memory currently allocated.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_memory_reset_peak() {
+    PEAK.store(CURRENT.load(Ordering::Relaxed), Ordering::Relaxed);
+}
+
+/// Estimates the peak heap memory, in bytes, of training on `num_items` items with
+/// `num_reviews` reviews between them.
+///
+/// The estimate adds up the copies of the train set and the batch tensors training
+/// keeps alive at once, plus a fixed allowance for the model and thread pools, so it
+/// grows linearly in both counts. It is meant as an upper bound of `peak_bytes` from
+/// `fsrs_memory_usage` for the same training run, but its constants are counted from
+/// the structures involved rather than fitted to measured runs. examples/memory.c
+/// checks it on a few small train sets and prints how close it is; before admitting
+/// jobs to machines by it, measure train sets of the sizes they will see the same way,
+/// with a release build of the library with the `memory-tracking` feature. Memory the
+/// allocator itself holds on to is not included, so compare with `peak_rss_bytes` as
+/// well.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_compute_parameters_memory_estimate(
+    num_items: usize,
+    num_reviews: usize,
+) -> usize {
+    let item_bytes = TRAIN_SET_COPIES * (size_of::<Vec<fsrs::FSRSReview>>() + ALLOCATION_OVERHEAD)
+        + TENSOR_BYTES_PER_ITEM;
+    let review_bytes = TRAIN_SET_COPIES * size_of::<fsrs::FSRSReview>() + TENSOR_BYTES_PER_REVIEW;
+    num_items
+        .saturating_mul(item_bytes)
+        .saturating_add(num_reviews.saturating_mul(review_bytes))
+        .saturating_add(TRAINING_BASE_BYTES)
+}
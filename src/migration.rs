@@ -0,0 +1,75 @@
+use rayon::prelude::*;
+
+use crate::{FSRS, MemoryState, slice, slice_mut};
+
+/// Cards per parallel task; converting a single card is far cheaper than a task switch.
+const MIN_CARDS_PER_TASK: usize = 1024;
+
+/// Converts the SM-2 state of many cards into FSRS memory states.
+///
+/// For card `i`, `ease_factors[i]` is the SM-2 ease factor (2.5 for 250%),
+/// `intervals[i]` the current interval in days and `sm2_retentions[i]` the retention
+/// the card was scheduled for. Cards are converted in parallel on the shared pool.
+///
+/// Returns the number of cards that could not be converted; their memory state is set
+/// to zero stability and difficulty. If any array, including `memory_states`, is NULL,
+/// no card is converted and `len` is returned.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `ease_factors`, `intervals` and `sm2_retentions` pointers must be valid pointers to arrays of f32 with `len` elements.
+/// The `memory_states` pointer must be a valid pointer to an array of MemoryState with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_memory_states_from_sm2(
+    fsrs: *const FSRS,
+    ease_factors: *const f32,
+    intervals: *const f32,
+    sm2_retentions: *const f32,
+    memory_states: *mut MemoryState,
+    len: usize,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let ease_factors = unsafe { slice(ease_factors, len) };
+    let intervals = unsafe { slice(intervals, len) };
+    let sm2_retentions = unsafe { slice(sm2_retentions, len) };
+    let memory_states = unsafe { slice_mut(memory_states, len) };
+    if [
+        ease_factors.len(),
+        intervals.len(),
+        sm2_retentions.len(),
+        memory_states.len(),
+    ]
+    .contains(&0)
+    {
+        // A NULL array: no card can be converted, or its result could not be stored.
+        memory_states.fill(MemoryState {
+            stability: 0.0,
+            difficulty: 0.0,
+        });
+        return len;
+    }
+    memory_states
+        .par_iter_mut()
+        .enumerate()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|(i, memory_state)| {
+            match fsrs
+                .model
+                .memory_state_from_sm2(ease_factors[i], intervals[i], sm2_retentions[i])
+            {
+                Ok(state) => {
+                    *memory_state = state.into();
+                    0
+                }
+                Err(_) => {
+                    *memory_state = MemoryState {
+                        stability: 0.0,
+                        difficulty: 0.0,
+                    };
+                    1
+                }
+            }
+        })
+        .sum()
+}
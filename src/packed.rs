@@ -0,0 +1,273 @@
+use rayon::prelude::*;
+
+use crate::{FSRS, MemoryState, NextStates, slice, slice_mut};
+
+/// Cards per parallel task; scheduling a single card is far cheaper than a task switch.
+const MIN_CARDS_PER_TASK: usize = 1024;
+
+/// Smallest and largest stability that can be packed, as powers of two.
+const LOG2_STABILITY_MIN: f32 = -10.0;
+const LOG2_STABILITY_MAX: f32 = 22.0;
+/// Stability codes above zero; code 0 marks a card without a memory state.
+const STABILITY_STEPS: f32 = 65534.0;
+const DIFFICULTY_MIN: f32 = 1.0;
+const DIFFICULTY_MAX: f32 = 10.0;
+const DIFFICULTY_STEPS: f32 = 255.0;
+const MAX_LAST_REVIEW_DAY: i32 = (1 << 24) - 1;
+const MAX_INTERVAL: i32 = u16::MAX as i32;
+
+/// The scheduling state of one card.
+///
+/// A card that has never been reviewed has zero stability and difficulty.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct CardState {
+    pub memory: MemoryState,
+    pub last_review_day: i32,
+    pub due_day: i32,
+}
+
+/// A `CardState` packed into 8 bytes.
+///
+/// Bits 0-15 hold stability on a log scale covering 2^-10 to 2^22 days, with a relative
+/// error below 0.02%. Bits 16-23 hold difficulty in [1, 10] with an absolute error below
+/// 0.018. Bits 24-47 hold the last review day (0 to 16777215) and bits 48-63 the due
+/// day as an offset of up to 65535 days from it. Values outside these ranges are clamped.
+pub type PackedCardState = u64;
+
+impl CardState {
+    /// Returns the packed state, and whether any field had to be clamped to fit.
+    pub(crate) fn pack(&self) -> (PackedCardState, bool) {
+        let MemoryState {
+            stability,
+            difficulty,
+        } = self.memory;
+        let stability_code = if stability > 0.0 {
+            let scaled = (stability.log2() - LOG2_STABILITY_MIN)
+                / (LOG2_STABILITY_MAX - LOG2_STABILITY_MIN)
+                * STABILITY_STEPS;
+            1 + scaled.round().clamp(0.0, STABILITY_STEPS) as u64
+        } else {
+            0
+        };
+        let difficulty_code = ((difficulty - DIFFICULTY_MIN) / (DIFFICULTY_MAX - DIFFICULTY_MIN)
+            * DIFFICULTY_STEPS)
+            .round()
+            .clamp(0.0, DIFFICULTY_STEPS) as u64;
+        let last_review_day = self.last_review_day.clamp(0, MAX_LAST_REVIEW_DAY);
+        let interval = self
+            .due_day
+            .saturating_sub(last_review_day)
+            .clamp(0, MAX_INTERVAL);
+
+        let clamped = (stability > 0.0
+            && !(2f32.powf(LOG2_STABILITY_MIN)..=2f32.powf(LOG2_STABILITY_MAX))
+                .contains(&stability))
+            || (stability_code != 0 && !(DIFFICULTY_MIN..=DIFFICULTY_MAX).contains(&difficulty))
+            || last_review_day != self.last_review_day
+            || last_review_day + interval != self.due_day;
+        let packed = stability_code
+            | difficulty_code << 16
+            | (last_review_day as u64) << 24
+            | (interval as u64) << 48;
+        (packed, clamped)
+    }
+
+    pub(crate) fn unpack(packed: PackedCardState) -> Self {
+        let stability_code = packed & 0xffff;
+        let memory = if stability_code == 0 {
+            MemoryState {
+                stability: 0.0,
+                difficulty: 0.0,
+            }
+        } else {
+            let log2_stability = (stability_code - 1) as f32 / STABILITY_STEPS
+                * (LOG2_STABILITY_MAX - LOG2_STABILITY_MIN)
+                + LOG2_STABILITY_MIN;
+            let difficulty_code = (packed >> 16) & 0xff;
+            MemoryState {
+                stability: log2_stability.exp2(),
+                difficulty: difficulty_code as f32 / DIFFICULTY_STEPS
+                    * (DIFFICULTY_MAX - DIFFICULTY_MIN)
+                    + DIFFICULTY_MIN,
+            }
+        };
+        let last_review_day = ((packed >> 24) & 0xff_ffff) as i32;
+        CardState {
+            memory,
+            last_review_day,
+            due_day: last_review_day + (packed >> 48) as i32,
+        }
+    }
+
+    fn memory_state(&self) -> Option<fsrs::MemoryState> {
+        (self.memory.stability > 0.0).then(|| self.memory.into())
+    }
+
+    fn days_elapsed(&self, today: i32) -> u32 {
+        if self.memory.stability > 0.0 {
+            today.saturating_sub(self.last_review_day).max(0) as u32
+        } else {
+            0
+        }
+    }
+
+    /// Returns the state after a review on `today` with `rating` (1 to 4), due once
+    /// `desired_retention` is reached; `None` if the rating is invalid or the model fails.
+    pub(crate) fn review(
+        &self,
+        fsrs: &FSRS,
+        rating: u32,
+        today: i32,
+        desired_retention: f32,
+    ) -> Option<CardState> {
+        let next_states = fsrs
+            .model
+            .next_states(
+                self.memory_state(),
+                desired_retention,
+                self.days_elapsed(today),
+            )
+            .ok()?;
+        let next = match rating {
+            1 => next_states.again,
+            2 => next_states.hard,
+            3 => next_states.good,
+            4 => next_states.easy,
+            _ => return None,
+        };
+        let interval = next.interval.round().clamp(1.0, i32::MAX as f32) as i32;
+        Some(CardState {
+            memory: next.memory.into(),
+            last_review_day: today,
+            due_day: today.saturating_add(interval),
+        })
+    }
+}
+
+/// Packs card states into their compact form.
+///
+/// Returns the number of states that had a field clamped; see `fsrs_PackedCardState`.
+///
+/// # Safety
+///
+/// The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
+/// The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_states_pack(
+    states: *const CardState,
+    packed: *mut PackedCardState,
+    len: usize,
+) -> usize {
+    let states = unsafe { slice(states, len) };
+    let packed = unsafe { slice_mut(packed, len) };
+    let mut clamped = 0;
+    for (state, packed) in states.iter().zip(packed) {
+        let (value, was_clamped) = state.pack();
+        *packed = value;
+        clamped += was_clamped as usize;
+    }
+    clamped
+}
+
+/// Unpacks compact card states.
+///
+/// # Safety
+///
+/// The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+/// The `states` pointer must be a valid pointer to an array of CardState with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_card_states_unpack(
+    packed: *const PackedCardState,
+    states: *mut CardState,
+    len: usize,
+) {
+    let packed = unsafe { slice(packed, len) };
+    let states = unsafe { slice_mut(states, len) };
+    for (packed, state) in packed.iter().zip(states) {
+        *state = CardState::unpack(*packed);
+    }
+}
+
+/// Computes the next states of many packed cards reviewed on `today`.
+///
+/// Cards are processed in parallel on the shared pool. Returns the number of cards the
+/// model failed on; their entry in `next_states` is left unchanged.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+/// The `next_states` pointer must be a valid pointer to an array of NextStates with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_next_states_packed(
+    fsrs: *const FSRS,
+    packed: *const PackedCardState,
+    today: i32,
+    desired_retention: f32,
+    next_states: *mut NextStates,
+    len: usize,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let packed = unsafe { slice(packed, len) };
+    let next_states = unsafe { slice_mut(next_states, len) };
+    next_states
+        .par_iter_mut()
+        .zip(packed)
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|(next, &packed)| {
+            let state = CardState::unpack(packed);
+            match fsrs.model.next_states(
+                state.memory_state(),
+                desired_retention,
+                state.days_elapsed(today),
+            ) {
+                Ok(states) => {
+                    *next = states.into();
+                    0
+                }
+                Err(_) => 1,
+            }
+        })
+        .sum()
+}
+
+/// Applies one review per card to packed states in place.
+///
+/// Card `i` is reviewed on `today` with `ratings[i]` (1 to 4) and becomes due once
+/// `desired_retention` is reached, at least one day later. Cards are processed in
+/// parallel on the shared pool. Returns the number of cards left unchanged because their
+/// rating was invalid or the model failed.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `packed` pointer must be a valid pointer to an array of PackedCardState with `len` elements.
+/// The `ratings` pointer must be a valid pointer to an array of u32 with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_review_packed(
+    fsrs: *const FSRS,
+    packed: *mut PackedCardState,
+    ratings: *const u32,
+    today: i32,
+    desired_retention: f32,
+    len: usize,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let packed = unsafe { slice_mut(packed, len) };
+    let ratings = unsafe { slice(ratings, len) };
+    packed
+        .par_iter_mut()
+        .zip(ratings)
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|(packed, &rating)| {
+            match CardState::unpack(*packed).review(fsrs, rating, today, desired_retention) {
+                Some(state) => {
+                    *packed = state.pack().0;
+                    0
+                }
+                None => 1,
+            }
+        })
+        .sum()
+}
@@ -0,0 +1,33 @@
+use rayon::ThreadPoolBuilder;
+
+/// Runs `op` on a dedicated pool of `num_threads` workers.
+///
+/// With `num_threads == 0`, `op` runs on the calling thread and any parallel work inside
+/// it uses the shared pool.
+pub(crate) fn with_threads<R: Send>(num_threads: usize, op: impl FnOnce() -> R + Send) -> R {
+    if num_threads == 0 {
+        return op();
+    }
+    match ThreadPoolBuilder::new()
+        .num_threads(num_threads)
+        .thread_name(|i| format!("fsrs-worker-{i}"))
+        .build()
+    {
+        Ok(pool) => pool.install(op),
+        Err(_) => op(),
+    }
+}
+
+/// Sets the number of threads in the shared pool used by the batch functions and by
+/// training without an explicit thread count.
+///
+/// Must be called before any other function that uses the pool. Returns false if the
+/// pool has already been started.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_set_num_threads(num_threads: usize) -> bool {
+    ThreadPoolBuilder::new()
+        .num_threads(num_threads)
+        .thread_name(|i| format!("fsrs-{i}"))
+        .build_global()
+        .is_ok()
+}
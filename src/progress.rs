@@ -0,0 +1,52 @@
+use std::sync::{Arc, Mutex, OnceLock};
+use std::thread;
+use std::time::{Duration, Instant};
+
+use fsrs::CombinedProgressState;
+
+const POLL_INTERVAL: Duration = Duration::from_millis(1);
+
+/// Runs a training job and reports the start and end of every epoch to `on_epoch`.
+///
+/// The fsrs crate only publishes training progress through a shared state, so epoch
+/// boundaries are found by polling it from a helper thread and are accurate to about
+/// `POLL_INTERVAL`.
+pub(crate) fn watch_epochs<T>(
+    train: impl FnOnce(Arc<Mutex<CombinedProgressState>>) -> T,
+    mut on_epoch: impl FnMut(usize, Instant, Instant) + Send,
+) -> T {
+    let progress = CombinedProgressState::new_shared();
+    let done = OnceLock::new();
+    thread::scope(|scope| {
+        scope.spawn(|| {
+            let mut epoch = 0;
+            let mut started = Instant::now();
+            loop {
+                let finished = done.get().copied();
+                let current = progress
+                    .lock()
+                    .unwrap()
+                    .splits
+                    .iter()
+                    .map(|split| split.epoch)
+                    .max()
+                    .unwrap_or(0);
+                if current != epoch || finished.is_some() {
+                    let now = finished.unwrap_or_else(Instant::now);
+                    if epoch > 0 {
+                        on_epoch(epoch, started, now);
+                    }
+                    epoch = current;
+                    started = now;
+                }
+                if finished.is_some() {
+                    break;
+                }
+                thread::sleep(POLL_INTERVAL);
+            }
+        });
+        let result = train(progress.clone());
+        let _ = done.set(Instant::now());
+        result
+    })
+}
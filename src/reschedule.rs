@@ -0,0 +1,278 @@
+use std::ffi::c_void;
+use std::thread;
+
+use rayon::prelude::*;
+
+use crate::history::{FsrsReviewHistories, Histories};
+use crate::{FSRS, MemoryState, slice};
+
+/// Cards replayed per pipeline stage of `fsrs_reschedule`. At most two chunks of results
+/// exist at a time: one being replayed and one being handed to the callback.
+const RESCHEDULE_CHUNK: usize = 16 * 1024;
+
+/// A card's recomputed scheduling state, as passed to a `RescheduleCallback`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct RescheduledCard {
+    pub card_id: i64,
+    pub memory: MemoryState,
+    pub due_day: i32,
+}
+
+/// Receives one chunk of rescheduled cards. `cards` is only valid during the call.
+pub type RescheduleCallback =
+    Option<unsafe extern "C" fn(user_data: *mut c_void, cards: *const RescheduledCard, len: usize)>;
+
+/// The next cards to reschedule, as filled in by a `RescheduleSource`.
+///
+/// Card `i` has the reviews `histories` gives it, the id `card_ids[i]` and its last review
+/// on `last_review_days[i]`; both arrays have `histories.num_cards` elements.
+#[repr(C)]
+pub struct RescheduleChunk {
+    pub histories: FsrsReviewHistories,
+    pub card_ids: *const i64,
+    pub last_review_days: *const i32,
+}
+
+/// Supplies the next chunk of cards to `fsrs_reschedule_stream`.
+///
+/// Returns false once every card has been supplied. The chunk's arrays must stay valid
+/// until the source is called again or `fsrs_reschedule_stream` returns.
+pub type RescheduleSource =
+    Option<unsafe extern "C" fn(user_data: *mut c_void, chunk: *mut RescheduleChunk) -> bool>;
+
+/// One chunk of cards as seen by the pipeline.
+struct Chunk<'a> {
+    histories: Histories<'a>,
+    card_ids: &'a [i64],
+    last_review_days: &'a [i32],
+}
+
+/// Replays a card's history and schedules it at `desired_retention`.
+fn reschedule_card(
+    fsrs: &FSRS,
+    reviews: &[crate::FSRSReview],
+    card_id: i64,
+    last_review_day: i32,
+    desired_retention: f32,
+) -> Option<RescheduledCard> {
+    if reviews.is_empty() {
+        return None;
+    }
+    let item = fsrs::FSRSItem {
+        reviews: reviews.iter().map(|review| (*review).into()).collect(),
+    };
+    let state = fsrs.model.memory_state(item, None).ok()?;
+    let interval = fsrs
+        .model
+        .next_interval(Some(state.stability), desired_retention, 0)
+        .round()
+        .max(1.0);
+    Some(RescheduledCard {
+        card_id,
+        memory: state.into(),
+        due_day: last_review_day.saturating_add(interval.min(i32::MAX as f32) as i32),
+    })
+}
+
+/// Replays every card of `chunk` in parallel on the shared pool. Cards that can't be
+/// rescheduled are `None`.
+fn replay_chunk(
+    fsrs: &FSRS,
+    chunk: &Chunk,
+    desired_retention: f32,
+) -> Vec<Option<RescheduledCard>> {
+    (0..chunk.histories.num_cards())
+        .into_par_iter()
+        .map(|i| {
+            reschedule_card(
+                fsrs,
+                chunk.histories.card(i),
+                chunk.card_ids[i],
+                chunk.last_review_days[i],
+                desired_retention,
+            )
+        })
+        .collect()
+}
+
+/// Hands the rescheduled cards of one chunk to `callback` and returns how many were
+/// skipped.
+fn deliver(
+    results: Vec<Option<RescheduledCard>>,
+    cards: &mut Vec<RescheduledCard>,
+    callback: RescheduleCallback,
+    user_data: *mut c_void,
+) -> usize {
+    let len = results.len();
+    cards.clear();
+    cards.extend(results.into_iter().flatten());
+    if let Some(callback) = callback
+        && !cards.is_empty()
+    {
+        unsafe { callback(user_data, cards.as_ptr(), cards.len()) };
+    }
+    len - cards.len()
+}
+
+/// Runs the pipeline over the chunks `next_chunk` yields until it returns `None`.
+///
+/// While the shared pool replays one chunk, the previous chunk's results are handed to
+/// `callback` on the calling thread, so at most two chunks of results exist at a time.
+/// `next_chunk` is only called once the previous chunk has been replayed, so its data
+/// may be overwritten then. A chunk of `n` cards that `next_chunk` reports as `Err(n)`
+/// is skipped whole.
+fn reschedule_chunks<'a>(
+    fsrs: &FSRS,
+    desired_retention: f32,
+    mut next_chunk: impl FnMut() -> Option<Result<Chunk<'a>, usize>>,
+    callback: RescheduleCallback,
+    user_data: *mut c_void,
+) -> usize {
+    let mut skipped = 0;
+    let mut cards = Vec::new();
+    let mut pending = Vec::new();
+    while let Some(chunk) = next_chunk() {
+        let chunk = match chunk {
+            Ok(chunk) => chunk,
+            Err(num_cards) => {
+                skipped += num_cards;
+                continue;
+            }
+        };
+        let (results, delivered) = thread::scope(|scope| {
+            let replay = scope.spawn(|| replay_chunk(fsrs, &chunk, desired_retention));
+            let delivered = deliver(
+                std::mem::take(&mut pending),
+                &mut cards,
+                callback,
+                user_data,
+            );
+            (replay.join(), delivered)
+        });
+        skipped += delivered;
+        pending = match results {
+            Ok(results) => results,
+            // Only reachable if the arrays broke their documented layout.
+            Err(_) => vec![None; chunk.histories.num_cards()],
+        };
+    }
+    skipped + deliver(pending, &mut cards, callback, user_data)
+}
+
+/// Recomputes the memory state and due day of every card after a parameter change.
+///
+/// Each card's history is replayed from scratch, and the card is then scheduled
+/// `round(interval)` days (at least one) after `last_review_days[i]`, where the interval
+/// reaches `desired_retention`. Work proceeds in chunks: while the shared pool replays
+/// one chunk in parallel, the previous one is handed to `callback` on the calling
+/// thread, so memory use stays bounded whatever the collection size. Cards are reported
+/// in input order. To supply the histories chunk by chunk instead of all at once, use
+/// `fsrs_reschedule_stream`.
+///
+/// Returns the number of cards skipped because they have no reviews or their history
+/// could not be replayed. If `card_ids`, `last_review_days` or an array of `histories`
+/// is NULL, no card is rescheduled and `num_cards` is returned.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The `card_ids` and `last_review_days` pointers must be valid pointers to arrays with `num_cards` elements.
+/// The `callback` must be safe to call with `user_data`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_reschedule(
+    fsrs: *const FSRS,
+    histories: *const FsrsReviewHistories,
+    card_ids: *const i64,
+    last_review_days: *const i32,
+    desired_retention: f32,
+    callback: RescheduleCallback,
+    user_data: *mut c_void,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let num_cards = unsafe { (*histories).num_cards };
+    let histories = unsafe { Histories::new(&*histories) };
+    let card_ids = unsafe { slice(card_ids, num_cards) };
+    let last_review_days = unsafe { slice(last_review_days, num_cards) };
+    if !histories.is_complete(num_cards)
+        || card_ids.len() != num_cards
+        || last_review_days.len() != num_cards
+    {
+        return num_cards;
+    }
+
+    let mut starts = (0..num_cards).step_by(RESCHEDULE_CHUNK);
+    let next_chunk = || {
+        let start = starts.next()?;
+        let end = (start + RESCHEDULE_CHUNK).min(num_cards);
+        Some(Ok(Chunk {
+            histories: histories.range(start, end),
+            card_ids: &card_ids[start..end],
+            last_review_days: &last_review_days[start..end],
+        }))
+    };
+    reschedule_chunks(fsrs, desired_retention, next_chunk, callback, user_data)
+}
+
+/// Like `fsrs_reschedule`, but takes the cards chunk by chunk from `source`.
+///
+/// The caller never needs all histories in memory at once: `source` is called on the
+/// calling thread for the next chunk only after the previous one has been replayed, so
+/// it may reuse its buffers, e.g. to read the next cards from a database. While a chunk
+/// is replayed, the previous one is handed to `callback`. Cards are reported in the
+/// order they were supplied.
+///
+/// Returns the number of cards skipped because they have no reviews or their history
+/// could not be replayed, including every card of a chunk that has a NULL array.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `source` must be safe to call with `user_data`, and fill in a valid RescheduleChunk whenever it returns true.
+/// The `callback` must be safe to call with `user_data`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_reschedule_stream(
+    fsrs: *const FSRS,
+    source: RescheduleSource,
+    desired_retention: f32,
+    callback: RescheduleCallback,
+    user_data: *mut c_void,
+) -> usize {
+    let fsrs = unsafe { &*fsrs };
+    let Some(source) = source else {
+        return 0;
+    };
+    let mut raw = RescheduleChunk {
+        histories: FsrsReviewHistories {
+            reviews: std::ptr::null(),
+            offsets: std::ptr::null(),
+            num_cards: 0,
+        },
+        card_ids: std::ptr::null(),
+        last_review_days: std::ptr::null(),
+    };
+    let next_chunk = || {
+        if !unsafe { source(user_data, &mut raw) } {
+            return None;
+        }
+        // The arrays stay valid until the next call to `source`, which only happens once
+        // the pipeline is done with this chunk.
+        let num_cards = raw.histories.num_cards;
+        let histories = unsafe { Histories::new(&*std::ptr::addr_of!(raw.histories)) };
+        let card_ids = unsafe { slice(raw.card_ids, num_cards) };
+        let last_review_days = unsafe { slice(raw.last_review_days, num_cards) };
+        if !histories.is_complete(num_cards)
+            || card_ids.len() != num_cards
+            || last_review_days.len() != num_cards
+        {
+            return Some(Err(num_cards));
+        }
+        Some(Ok(Chunk {
+            histories,
+            card_ids,
+            last_review_days,
+        }))
+    };
+    reschedule_chunks(fsrs, desired_retention, next_chunk, callback, user_data)
+}
@@ -0,0 +1,348 @@
+use std::ffi::c_void;
+use std::mem::{align_of, size_of};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use rayon::prelude::*;
+
+use crate::{FSRS, ItemState, MemoryState, NextStates, slice, slice_mut};
+
+const RING_MAGIC: u64 = u64::from_le_bytes(*b"FSRSRNG1");
+/// Requests per parallel task when serving a large batch.
+const MIN_REQUESTS_PER_TASK: usize = 1024;
+
+/// A request for the next states of one card, as placed in a schedule ring.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct ScheduleRequest {
+    pub request_id: u64,
+    pub memory: MemoryState,
+    pub desired_retention: f32,
+    pub days_elapsed: u32,
+}
+
+/// The answer to a `ScheduleRequest`. `status` is 0 on success; otherwise `next_states`
+/// is undefined.
+#[repr(C)]
+#[derive(Clone)]
+pub struct ScheduleResponse {
+    pub request_id: u64,
+    pub status: u32,
+    pub next_states: NextStates,
+}
+
+/// A ring index on its own cache line, so producer and consumer do not share one.
+#[repr(C, align(64))]
+struct Index(AtomicU64);
+
+/// The start of a schedule ring's memory, followed by the request and response slots.
+///
+/// Indices count slots ever written or read, so `tail - head` is the number of slots in use.
+#[repr(C)]
+struct RingHeader {
+    magic: AtomicU64,
+    capacity: u64,
+    /// Advanced by the client after writing requests.
+    request_tail: Index,
+    /// Advanced by the server after reading requests.
+    request_head: Index,
+    /// Advanced by the server after writing responses.
+    response_tail: Index,
+    /// Advanced by the client after reading responses.
+    response_head: Index,
+}
+
+fn responses_offset(capacity: usize) -> Option<usize> {
+    let end = capacity
+        .checked_mul(size_of::<ScheduleRequest>())?
+        .checked_add(size_of::<RingHeader>())?;
+    end.checked_next_multiple_of(align_of::<ScheduleResponse>())
+}
+
+fn ring_size(capacity: usize) -> Option<usize> {
+    capacity
+        .checked_mul(size_of::<ScheduleResponse>())?
+        .checked_add(responses_offset(capacity)?)
+}
+
+/// A view of an initialized ring in this process's mapping of its memory.
+///
+/// The other side of the ring may be another process, so nothing read from the shared
+/// header is trusted: the capacity is checked once here against the length of this
+/// process's mapping, and every pair of indices is checked before slots are touched.
+struct Ring {
+    header: *const RingHeader,
+    requests: *mut ScheduleRequest,
+    responses: *mut ScheduleResponse,
+    capacity: u64,
+}
+
+impl Ring {
+    /// Returns None if `memory` does not hold a ring, its header is corrupt, or the
+    /// capacity it claims needs more than `memory_len` bytes.
+    ///
+    /// # Safety
+    ///
+    /// `memory` must be null or point to `memory_len` bytes initialized by
+    /// `fsrs_schedule_ring_init`.
+    unsafe fn new(memory: *mut c_void, memory_len: usize) -> Option<Self> {
+        if memory.is_null() || !(memory as usize).is_multiple_of(align_of::<RingHeader>()) {
+            return None;
+        }
+        let header = memory as *const RingHeader;
+        if unsafe { &(*header).magic }.load(Ordering::Acquire) != RING_MAGIC {
+            return None;
+        }
+        let capacity = usize::try_from(unsafe { (*header).capacity }).ok()?;
+        if !capacity.is_power_of_two() || ring_size(capacity).is_none_or(|size| size > memory_len) {
+            return None;
+        }
+        let base = memory as *mut u8;
+        Some(Ring {
+            header,
+            requests: unsafe { base.add(size_of::<RingHeader>()) } as *mut ScheduleRequest,
+            responses: unsafe { base.add(responses_offset(capacity)?) } as *mut ScheduleResponse,
+            capacity: capacity as u64,
+        })
+    }
+
+    fn header(&self) -> &RingHeader {
+        unsafe { &*self.header }
+    }
+
+    fn slot(&self, index: u64) -> usize {
+        (index & (self.capacity - 1)) as usize
+    }
+
+    /// Returns the number of slots in use between `head` and `tail`, or None if the
+    /// indices cannot have come from the ring.
+    fn used(&self, head: u64, tail: u64) -> Option<u64> {
+        tail.checked_sub(head).filter(|&used| used <= self.capacity)
+    }
+}
+
+/// Returns the number of bytes a schedule ring with `capacity` slots per direction needs,
+/// or 0 if `capacity` is not a power of two.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_schedule_ring_size(capacity: usize) -> usize {
+    if !capacity.is_power_of_two() {
+        return 0;
+    }
+    ring_size(capacity).unwrap_or(0)
+}
+
+/// Lays out an empty schedule ring in `memory`.
+///
+/// A schedule ring lets one client thread and one server thread exchange scheduling
+/// requests through memory they share, typically a `shm_open` region mapped by two
+/// processes. Both sides only read and write the shared slots and atomic indices, so
+/// submitting and polling make no system calls. `memory` must be 64-byte aligned, and
+/// `memory_len`, the length of the mapping, must be at least
+/// `fsrs_schedule_ring_size(capacity)`; other processes may use the ring once this
+/// returns. Returns false if `capacity` is not a power of two or `memory` is misaligned
+/// or too short. The other functions take each process's own mapping length, check the
+/// ring's header against it before each use and do nothing, returning 0, if it has been
+/// corrupted.
+///
+/// # Safety
+///
+/// The `memory` pointer must be a valid pointer to `memory_len` writable bytes that no other thread
+/// uses during the call.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_schedule_ring_init(
+    memory: *mut c_void,
+    memory_len: usize,
+    capacity: usize,
+) -> bool {
+    if memory.is_null()
+        || !capacity.is_power_of_two()
+        || ring_size(capacity).is_none_or(|size| size > memory_len)
+        || !(memory as usize).is_multiple_of(align_of::<RingHeader>())
+    {
+        return false;
+    }
+    let header = memory as *mut RingHeader;
+    unsafe {
+        header.write(RingHeader {
+            magic: AtomicU64::new(0),
+            capacity: capacity as u64,
+            request_tail: Index(AtomicU64::new(0)),
+            request_head: Index(AtomicU64::new(0)),
+            response_tail: Index(AtomicU64::new(0)),
+            response_head: Index(AtomicU64::new(0)),
+        });
+        (*header).magic.store(RING_MAGIC, Ordering::Release);
+    }
+    true
+}
+
+/// Places requests in the ring; client side.
+///
+/// Returns how many of `requests`, from the start, were placed; fewer than `len` when
+/// the ring is full. Only one thread may submit to a ring.
+///
+/// # Safety
+///
+/// The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+/// The `requests` pointer must be a valid pointer to an array of ScheduleRequest with `len` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_schedule_ring_submit(
+    memory: *mut c_void,
+    memory_len: usize,
+    requests: *const ScheduleRequest,
+    len: usize,
+) -> usize {
+    let Some(ring) = (unsafe { Ring::new(memory, memory_len) }) else {
+        return 0;
+    };
+    let requests = unsafe { slice(requests, len) };
+    let header = ring.header();
+    let tail = header.request_tail.0.load(Ordering::Relaxed);
+    let head = header.request_head.0.load(Ordering::Acquire);
+    let Some(used) = ring.used(head, tail) else {
+        return 0;
+    };
+    let count = ((ring.capacity - used) as usize).min(requests.len());
+    for (i, request) in requests[..count].iter().enumerate() {
+        unsafe {
+            ring.requests
+                .add(ring.slot(tail + i as u64))
+                .write(*request)
+        };
+    }
+    header
+        .request_tail
+        .0
+        .store(tail + count as u64, Ordering::Release);
+    count
+}
+
+/// Takes finished responses from the ring; client side.
+///
+/// Copies up to `capacity` responses, in request order, to `responses` and returns how
+/// many were copied. Only one thread may poll a ring.
+///
+/// # Safety
+///
+/// The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+/// The `responses` pointer must be a valid pointer to an array of ScheduleResponse with `capacity` elements.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_schedule_ring_poll(
+    memory: *mut c_void,
+    memory_len: usize,
+    responses: *mut ScheduleResponse,
+    capacity: usize,
+) -> usize {
+    let Some(ring) = (unsafe { Ring::new(memory, memory_len) }) else {
+        return 0;
+    };
+    let responses = unsafe { slice_mut(responses, capacity) };
+    let header = ring.header();
+    let head = header.response_head.0.load(Ordering::Relaxed);
+    let tail = header.response_tail.0.load(Ordering::Acquire);
+    let Some(used) = ring.used(head, tail) else {
+        return 0;
+    };
+    let count = (used as usize).min(responses.len());
+    for (i, response) in responses[..count].iter_mut().enumerate() {
+        *response = unsafe { (*ring.responses.add(ring.slot(head + i as u64))).clone() };
+    }
+    header
+        .response_head
+        .0
+        .store(head + count as u64, Ordering::Release);
+    count
+}
+
+/// Answers pending requests in the ring; server side.
+///
+/// Takes up to `max_batch` requests, or as many as there is room for responses, computes
+/// their next states as one batch, in parallel on the shared pool when it is large, and
+/// publishes the responses. Returns the number of requests answered, 0 if none were
+/// pending. Only one thread may serve a ring.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `memory` pointer must be a valid pointer to this process's mapping, `memory_len` bytes long, of a ring initialized by `fsrs_schedule_ring_init`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_schedule_ring_serve(
+    fsrs: *const FSRS,
+    memory: *mut c_void,
+    memory_len: usize,
+    max_batch: usize,
+) -> usize {
+    let Some(ring) = (unsafe { Ring::new(memory, memory_len) }) else {
+        return 0;
+    };
+    let fsrs = unsafe { &*fsrs };
+    let header = ring.header();
+    let request_head = header.request_head.0.load(Ordering::Relaxed);
+    let request_tail = header.request_tail.0.load(Ordering::Acquire);
+    let response_tail = header.response_tail.0.load(Ordering::Relaxed);
+    let response_head = header.response_head.0.load(Ordering::Acquire);
+    let (Some(pending), Some(responses_used)) = (
+        ring.used(request_head, request_tail),
+        ring.used(response_head, response_tail),
+    ) else {
+        return 0;
+    };
+    let room = ring.capacity - responses_used;
+    let count = (pending.min(room) as usize).min(max_batch);
+    if count == 0 {
+        return 0;
+    }
+
+    let requests: Vec<ScheduleRequest> = (0..count as u64)
+        .map(|i| unsafe { *ring.requests.add(ring.slot(request_head + i)) })
+        .collect();
+    // The request slots can be reused as soon as they have been copied.
+    header
+        .request_head
+        .0
+        .store(request_head + count as u64, Ordering::Release);
+
+    let responses: Vec<ScheduleResponse> = requests
+        .par_iter()
+        .with_min_len(MIN_REQUESTS_PER_TASK)
+        .map(|request| {
+            let memory = request.memory;
+            let memory = (memory.stability > 0.0).then(|| memory.into());
+            let result =
+                fsrs.model
+                    .next_states(memory, request.desired_retention, request.days_elapsed);
+            let status = result.is_err() as u32;
+            let next_states = result.map_or_else(
+                |_| {
+                    let empty = ItemState {
+                        memory: request.memory,
+                        interval: 0.0,
+                    };
+                    NextStates {
+                        again: empty.clone(),
+                        hard: empty.clone(),
+                        good: empty.clone(),
+                        easy: empty,
+                    }
+                },
+                NextStates::from,
+            );
+            ScheduleResponse {
+                request_id: request.request_id,
+                status,
+                next_states,
+            }
+        })
+        .collect();
+    for (i, response) in responses.into_iter().enumerate() {
+        unsafe {
+            ring.responses
+                .add(ring.slot(response_tail + i as u64))
+                .write(response)
+        };
+    }
+    header
+        .response_tail
+        .0
+        .store(response_tail + count as u64, Ordering::Release);
+    count
+}
@@ -0,0 +1,126 @@
+use rayon::prelude::*;
+
+use crate::due::mix;
+use crate::history::{FsrsReviewHistories, Histories, items_into_raw, shortest_item};
+use crate::{FSRSReview, FsrsItems};
+
+/// Cards per parallel task when counting or sampling items; counting tasks each keep
+/// their own counters.
+const MIN_CARDS_PER_TASK: usize = 1024;
+/// History lengths are bucketed by powers of two: 1, 2-3, 4-7, 8-15, 16-31 and 32 or
+/// more reviews before the one being predicted.
+const LENGTH_BUCKETS: usize = 6;
+/// One stratum per length bucket and rating of the predicted review.
+const STRATA: usize = LENGTH_BUCKETS * 4;
+
+/// Item counts per stratum, split into older items (`[0]`) and recent ones (`[1]`).
+type Counts = [[u64; 2]; STRATA];
+
+fn stratum(item: &[FSRSReview]) -> usize {
+    let bucket = ((item.len() - 1).ilog2() as usize).min(LENGTH_BUCKETS - 1);
+    let rating = item[item.len() - 1].rating.clamp(1, 4) as usize - 1;
+    bucket * 4 + rating
+}
+
+/// The items of a card as `(length, recent)`, where recent items end in one of the
+/// card's last `recent_reviews` reviews.
+fn card_items(reviews: &[FSRSReview], recent_reviews: u32) -> impl Iterator<Item = (usize, bool)> {
+    let recent_from = reviews.len().saturating_sub(recent_reviews as usize);
+    (shortest_item(reviews)..=reviews.len()).map(move |len| (len, len > recent_from))
+}
+
+/// Returns the probability of keeping each kind of item so that about `max_items` are
+/// kept in proportion to the strata, recent items first.
+fn keep_rates(counts: &Counts, total: u64, max_items: usize) -> [[f64; 2]; STRATA] {
+    if total <= max_items as u64 {
+        return [[1.0; 2]; STRATA];
+    }
+    counts.map(|[old, recent]| {
+        let quota = max_items as f64 * (old + recent) as f64 / total as f64;
+        if quota >= recent as f64 {
+            let rest = quota - recent as f64;
+            [if old > 0 { rest / old as f64 } else { 0.0 }, 1.0]
+        } else {
+            [0.0, quota / recent as f64]
+        }
+    })
+}
+
+/// A uniform number in [0, 1) fixed by the seed, card and item.
+fn draw(seed: u64, card: usize, len: usize) -> f64 {
+    let hash = mix(mix(seed ^ card as u64) ^ len as u64);
+    (hash >> 11) as f64 / (1u64 << 53) as f64
+}
+
+/// Builds a training set of about `max_items` items sampled from many review histories.
+///
+/// The full set is the one `fsrs_train_set_from_histories` would build. The sample keeps
+/// the full set's mix of history lengths and ratings of the predicted review: items are
+/// grouped by both, and each group contributes in proportion to its size. Within a
+/// group, items ending in one of their card's last `recent_reviews` reviews are kept
+/// before older ones, which are sampled pseudo-randomly from `seed`. The histories are
+/// read twice, once to count and once to sample, and only the sampled items are
+/// allocated. The sample size is the returned set's `len`, within a fraction of a
+/// percent of `max_items` for large sets; if the full set has no more than `max_items`
+/// items, all of them are kept.
+///
+/// If `eligible_items` is not null, it receives the size of the full set.
+///
+/// # Safety
+///
+/// The `histories` pointer must be a valid pointer to a FsrsReviewHistories instance.
+/// The `eligible_items` pointer must be null or a valid pointer to a size_t.
+/// The returned pointer must be freed with `fsrs_items_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_train_set_sample_from_histories(
+    histories: *const FsrsReviewHistories,
+    max_items: usize,
+    recent_reviews: u32,
+    seed: u64,
+    eligible_items: *mut usize,
+) -> *mut FsrsItems {
+    let histories = unsafe { Histories::new(&*histories) };
+    let num_cards = histories.num_cards();
+    let counts = (0..num_cards.div_ceil(MIN_CARDS_PER_TASK))
+        .into_par_iter()
+        .map(|task| {
+            let mut counts = [[0u64; 2]; STRATA];
+            let start = task * MIN_CARDS_PER_TASK;
+            for i in start..num_cards.min(start + MIN_CARDS_PER_TASK) {
+                let reviews = histories.card(i);
+                for (len, recent) in card_items(reviews, recent_reviews) {
+                    counts[stratum(&reviews[..len])][recent as usize] += 1;
+                }
+            }
+            counts
+        })
+        .reduce(
+            || [[0u64; 2]; STRATA],
+            |mut a, b| {
+                for (a, b) in a.iter_mut().flatten().zip(b.iter().flatten()) {
+                    *a += b;
+                }
+                a
+            },
+        );
+    let total: u64 = counts.iter().flatten().sum();
+    if !eligible_items.is_null() {
+        unsafe { *eligible_items = total as usize };
+    }
+
+    let rates = keep_rates(&counts, total, max_items);
+    let items: Vec<Vec<Box<[FSRSReview]>>> = (0..num_cards)
+        .into_par_iter()
+        .with_min_len(MIN_CARDS_PER_TASK)
+        .map(|i| {
+            let reviews = histories.card(i);
+            card_items(reviews, recent_reviews)
+                .filter(|&(len, recent)| {
+                    draw(seed, i, len) < rates[stratum(&reviews[..len])][recent as usize]
+                })
+                .map(|(len, _)| reviews[..len].into())
+                .collect()
+        })
+        .collect();
+    items_into_raw(items)
+}
@@ -0,0 +1,203 @@
+use rayon::prelude::*;
+
+use crate::{FSRS, slice_mut};
+
+/// Step between the retentions tried by `fsrs_optimal_retention`.
+const RETENTION_STEP: f32 = 0.01;
+
+/// Most simulations one call may run, so that an absurd range or run count fails
+/// instead of exhausting memory.
+const MAX_SIMULATIONS: usize = 1 << 16;
+
+/// Settings for the review workload simulator.
+///
+/// Start from `fsrs_simulation_config_default` so that fields added later keep their
+/// default values.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct SimulationConfig {
+    /// Number of cards in the simulated collection.
+    pub deck_size: usize,
+    /// Number of days to simulate.
+    pub learn_span: usize,
+    /// Daily study time budget in seconds.
+    pub max_cost_perday: f32,
+    /// Longest interval in days.
+    pub max_ivl: f32,
+    /// New cards introduced per day.
+    pub learn_limit: usize,
+    /// Reviews per day.
+    pub review_limit: usize,
+}
+
+/// Caller-provided arrays receiving a per-day workload forecast.
+///
+/// Each non-NULL array must hold `len` elements; day `d` of the simulation is written to
+/// index `d` for `d < min(len, learn_span)`. Values are averaged over all runs.
+#[repr(C)]
+pub struct WorkloadForecast {
+    /// Reviews of previously learned cards.
+    pub reviews: *mut f32,
+    /// Newly introduced cards.
+    pub learned: *mut f32,
+    /// Expected number of memorized cards at the end of the day.
+    pub memorized: *mut f32,
+    /// Study time in seconds.
+    pub cost: *mut f32,
+    pub len: usize,
+}
+
+impl From<&SimulationConfig> for fsrs::SimulatorConfig {
+    fn from(config: &SimulationConfig) -> Self {
+        fsrs::SimulatorConfig {
+            deck_size: config.deck_size,
+            learn_span: config.learn_span,
+            max_cost_perday: config.max_cost_perday,
+            max_ivl: config.max_ivl,
+            learn_limit: config.learn_limit,
+            review_limit: config.review_limit,
+            ..Default::default()
+        }
+    }
+}
+
+/// Runs `num_runs` simulations with consecutive seeds in parallel on the shared pool.
+///
+/// Returns None if a simulation failed or more than `MAX_SIMULATIONS` would run.
+fn simulate_runs(
+    fsrs: &FSRS,
+    config: &fsrs::SimulatorConfig,
+    desired_retentions: &[f32],
+    seed: u64,
+    num_runs: usize,
+) -> Option<Vec<fsrs::SimulationResult>> {
+    let num_runs = num_runs.max(1);
+    let tasks = desired_retentions
+        .len()
+        .checked_mul(num_runs)
+        .filter(|&tasks| tasks <= MAX_SIMULATIONS)?;
+    (0..tasks)
+        .into_par_iter()
+        .map(|task| {
+            let desired_retention = desired_retentions[task / num_runs];
+            let seed = seed.wrapping_add((task % num_runs) as u64);
+            fsrs::simulate(
+                config,
+                &fsrs.parameters,
+                desired_retention,
+                Some(seed),
+                None,
+            )
+            .ok()
+        })
+        .collect()
+}
+
+/// Returns the default simulation settings.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_simulation_config_default() -> SimulationConfig {
+    let config = fsrs::SimulatorConfig::default();
+    SimulationConfig {
+        deck_size: config.deck_size,
+        learn_span: config.learn_span,
+        max_cost_perday: config.max_cost_perday,
+        max_ivl: config.max_ivl,
+        learn_limit: config.learn_limit,
+        review_limit: config.review_limit,
+    }
+}
+
+/// Simulates future reviews at `desired_retention` and writes a daily forecast.
+///
+/// `num_runs` simulations with seeds `seed, seed + 1, ...` run in parallel on the shared
+/// pool and are averaged, so the result is the same for the same inputs on any machine.
+/// Returns false if the simulation failed or `num_runs` exceeds 65536, leaving `forecast`
+/// untouched.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `config` pointer must be a valid pointer to a SimulationConfig instance.
+/// The `forecast` pointer must be a valid pointer to a WorkloadForecast instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_simulate(
+    fsrs: *const FSRS,
+    config: *const SimulationConfig,
+    desired_retention: f32,
+    seed: u64,
+    num_runs: usize,
+    forecast: *const WorkloadForecast,
+) -> bool {
+    let fsrs = unsafe { &*fsrs };
+    let config = unsafe { &*config };
+    let forecast = unsafe { &*forecast };
+    let Some(runs) = simulate_runs(fsrs, &config.into(), &[desired_retention], seed, num_runs)
+    else {
+        return false;
+    };
+
+    let days = forecast.len.min(config.learn_span);
+    let scale = 1.0 / runs.len() as f32;
+    let average = |out: *mut f32, per_day: &dyn Fn(&fsrs::SimulationResult, usize) -> f32| {
+        for (day, value) in unsafe { slice_mut(out, days) }.iter_mut().enumerate() {
+            *value = runs.iter().map(|run| per_day(run, day)).sum::<f32>() * scale;
+        }
+    };
+    average(forecast.reviews, &|run, day| {
+        run.review_cnt_per_day[day] as f32
+    });
+    average(forecast.learned, &|run, day| {
+        run.learn_cnt_per_day[day] as f32
+    });
+    average(forecast.memorized, &|run, day| {
+        run.memorized_cnt_per_day[day]
+    });
+    average(forecast.cost, &|run, day| run.cost_per_day[day]);
+    true
+}
+
+/// Finds the desired retention that minimizes study time per memorized card.
+///
+/// Every retention from `min_retention` to `max_retention` in steps of 0.01 is simulated
+/// `num_runs` times, with all simulations running in parallel on the shared pool, and the
+/// one with the lowest average total cost per card memorized at the end is returned.
+/// Returns NaN if the range is empty or not finite, a simulation failed, or more than
+/// 65536 simulations would run.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `config` pointer must be a valid pointer to a SimulationConfig instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_optimal_retention(
+    fsrs: *const FSRS,
+    config: *const SimulationConfig,
+    min_retention: f32,
+    max_retention: f32,
+    seed: u64,
+    num_runs: usize,
+) -> f32 {
+    let fsrs = unsafe { &*fsrs };
+    let config = unsafe { &*config };
+    let steps = ((max_retention - min_retention) / RETENTION_STEP + 1e-3).floor();
+    if !steps.is_finite() || steps < 0.0 || steps >= MAX_SIMULATIONS as f32 {
+        return f32::NAN;
+    }
+    let retentions: Vec<f32> = (0..=steps as usize)
+        .map(|step| min_retention + step as f32 * RETENTION_STEP)
+        .collect();
+    let Some(runs) = simulate_runs(fsrs, &config.into(), &retentions, seed, num_runs) else {
+        return f32::NAN;
+    };
+
+    let cost_per_memorized = |run: &fsrs::SimulationResult| {
+        let cost: f32 = run.cost_per_day.iter().sum();
+        let memorized = run.memorized_cnt_per_day.last().copied().unwrap_or(0.0);
+        cost / memorized.max(f32::MIN_POSITIVE)
+    };
+    runs.chunks(num_runs.max(1))
+        .map(|runs| runs.iter().map(cost_per_memorized).sum::<f32>())
+        .zip(retentions)
+        .min_by(|(a, _), (b, _)| a.total_cmp(b))
+        .map_or(f32::NAN, |(_, retention)| retention)
+}
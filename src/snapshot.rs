@@ -0,0 +1,151 @@
+use std::ffi::{CStr, c_char};
+use std::fs;
+use std::path::Path;
+
+use crate::journal::{fnv1a64, replace_file};
+use crate::{FSRS, slice, slice_mut, stats};
+
+const SNAPSHOT_MAGIC: &[u8; 8] = b"FSRSPARM";
+const SNAPSHOT_VERSION: u32 = 1;
+/// Magic, version and parameter count.
+const HEADER_LEN: usize = 16;
+const CHECKSUM_LEN: usize = 8;
+
+impl FSRS {
+    /// Serializes the handle: magic, version, parameter count, the parameters' bit
+    /// patterns and a checksum of everything before it, all little-endian.
+    fn snapshot(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(snapshot_len(self.parameters.len()));
+        out.extend_from_slice(SNAPSHOT_MAGIC);
+        out.extend_from_slice(&SNAPSHOT_VERSION.to_le_bytes());
+        out.extend_from_slice(&(self.parameters.len() as u32).to_le_bytes());
+        for parameter in &self.parameters {
+            out.extend_from_slice(&parameter.to_bits().to_le_bytes());
+        }
+        let checksum = fnv1a64(&out);
+        out.extend_from_slice(&checksum.to_le_bytes());
+        out
+    }
+
+    fn from_snapshot(bytes: &[u8]) -> Option<Self> {
+        let (body, checksum) = bytes.split_last_chunk::<CHECKSUM_LEN>()?;
+        if fnv1a64(body) != u64::from_le_bytes(*checksum)
+            || body.get(..8)? != SNAPSHOT_MAGIC
+            || u32::from_le_bytes(body.get(8..12)?.try_into().ok()?) != SNAPSHOT_VERSION
+        {
+            return None;
+        }
+        let count = u32::from_le_bytes(body.get(12..16)?.try_into().ok()?) as usize;
+        let parameters = body.get(HEADER_LEN..)?;
+        if parameters.len() != count.checked_mul(4)? {
+            return None;
+        }
+        let parameters: Vec<f32> = parameters
+            .chunks_exact(4)
+            .map(|bits| f32::from_bits(u32::from_le_bytes(bits.try_into().unwrap())))
+            .collect();
+        FSRS::new(Some(&parameters)).ok()
+    }
+}
+
+fn snapshot_len(num_parameters: usize) -> usize {
+    HEADER_LEN + num_parameters * 4 + CHECKSUM_LEN
+}
+
+/// Returns the size in bytes of the handle's snapshot.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_snapshot_size(fsrs: *const FSRS) -> usize {
+    snapshot_len(unsafe { &*fsrs }.parameters.len())
+}
+
+/// Writes a versioned binary snapshot of the handle to `buffer`.
+///
+/// The snapshot stores the exact bit pattern of every parameter, which fully determines
+/// the model, so a handle loaded from it on any host schedules identically. Returns the
+/// number of bytes written, or 0 if `capacity` is smaller than `fsrs_snapshot_size`.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `buffer` pointer must be a valid pointer to `capacity` writable bytes.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_snapshot_write(
+    fsrs: *const FSRS,
+    buffer: *mut u8,
+    capacity: usize,
+) -> usize {
+    let snapshot = unsafe { &*fsrs }.snapshot();
+    let buffer = unsafe { slice_mut(buffer, capacity) };
+    match buffer.get_mut(..snapshot.len()) {
+        Some(buffer) => {
+            buffer.copy_from_slice(&snapshot);
+            snapshot.len()
+        }
+        None => 0,
+    }
+}
+
+/// Creates an FSRS instance from a snapshot, e.g. one mapped into memory with `mmap`.
+///
+/// Returns NULL if the snapshot is truncated, corrupt, from another format version or
+/// holds invalid parameters.
+///
+/// # Safety
+///
+/// The `buffer` pointer must be a valid pointer to `len` readable bytes.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_new_from_snapshot(buffer: *const u8, len: usize) -> *const FSRS {
+    let timer = stats::start();
+    let fsrs = match FSRS::from_snapshot(unsafe { slice(buffer, len) }) {
+        Some(fsrs) => Box::into_raw(Box::new(fsrs)),
+        None => std::ptr::null(),
+    };
+    stats::NEW.record(timer);
+    fsrs
+}
+
+/// Saves a snapshot of the handle to the file at `path`, replacing it.
+///
+/// The snapshot is written to a temporary file and synced before it replaces the old
+/// one, and the directory is synced after the rename, so a crash leaves either the old
+/// snapshot or the new one. Returns false if the file cannot be written.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `path` pointer must be a valid pointer to a null-terminated UTF-8 string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_snapshot_save(fsrs: *const FSRS, path: *const c_char) -> bool {
+    let Ok(path) = unsafe { CStr::from_ptr(path) }.to_str() else {
+        return false;
+    };
+    replace_file(Path::new(path), &unsafe { &*fsrs }.snapshot()).is_ok()
+}
+
+/// Creates an FSRS instance from a snapshot file, read with a single read.
+///
+/// Returns NULL if the file cannot be read or does not hold a valid snapshot.
+///
+/// # Safety
+///
+/// The `path` pointer must be a valid pointer to a null-terminated UTF-8 string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_snapshot_load(path: *const c_char) -> *const FSRS {
+    let Ok(path) = unsafe { CStr::from_ptr(path) }.to_str() else {
+        return std::ptr::null();
+    };
+    let timer = stats::start();
+    let fsrs = match fs::read(path)
+        .ok()
+        .and_then(|bytes| FSRS::from_snapshot(&bytes))
+    {
+        Some(fsrs) => Box::into_raw(Box::new(fsrs)),
+        None => std::ptr::null(),
+    };
+    stats::NEW.record(timer);
+    fsrs
+}
@@ -0,0 +1,139 @@
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::time::Instant;
+
+/// Number of latency histogram buckets in `CallStats`.
+///
+/// Bucket 0 counts calls faster than 1µs, bucket `i` calls taking `[2^(i-1), 2^i)` µs;
+/// the last bucket also holds everything slower.
+pub const STATS_HISTOGRAM_BUCKETS: usize = 32;
+
+/// Counters for one instrumented function.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct CallStats {
+    pub calls: u64,
+    pub total_ns: u64,
+    pub max_ns: u64,
+    pub histogram: [u64; STATS_HISTOGRAM_BUCKETS],
+}
+
+/// A snapshot of the library's performance counters.
+///
+/// `new_handle` counts `fsrs_new`, `fsrs_new_from_snapshot` and `fsrs_snapshot_load`.
+/// `epochs` records one sample per training epoch of `fsrs_compute_parameters`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct Stats {
+    pub new_handle: CallStats,
+    pub next_states: CallStats,
+    pub item_new: CallStats,
+    pub compute_parameters: CallStats,
+    pub epochs: CallStats,
+}
+
+static ENABLED: AtomicBool = AtomicBool::new(false);
+
+pub(crate) static NEW: Counter = Counter::new();
+pub(crate) static NEXT_STATES: Counter = Counter::new();
+pub(crate) static ITEM_NEW: Counter = Counter::new();
+pub(crate) static COMPUTE_PARAMETERS: Counter = Counter::new();
+pub(crate) static EPOCHS: Counter = Counter::new();
+
+pub(crate) struct Counter {
+    calls: AtomicU64,
+    total_ns: AtomicU64,
+    max_ns: AtomicU64,
+    histogram: [AtomicU64; STATS_HISTOGRAM_BUCKETS],
+}
+
+impl Counter {
+    const fn new() -> Self {
+        Self {
+            calls: AtomicU64::new(0),
+            total_ns: AtomicU64::new(0),
+            max_ns: AtomicU64::new(0),
+            histogram: [const { AtomicU64::new(0) }; STATS_HISTOGRAM_BUCKETS],
+        }
+    }
+
+    /// Records the time since `start`, if instrumentation was enabled when it was taken.
+    pub(crate) fn record(&self, start: Option<Instant>) {
+        if let Some(start) = start {
+            self.record_ns(start.elapsed().as_nanos() as u64);
+        }
+    }
+
+    pub(crate) fn record_ns(&self, ns: u64) {
+        let micros = ns / 1000;
+        let bucket = (u64::BITS - micros.leading_zeros()) as usize;
+        self.calls.fetch_add(1, Ordering::Relaxed);
+        self.total_ns.fetch_add(ns, Ordering::Relaxed);
+        self.max_ns.fetch_max(ns, Ordering::Relaxed);
+        self.histogram[bucket.min(STATS_HISTOGRAM_BUCKETS - 1)].fetch_add(1, Ordering::Relaxed);
+    }
+
+    fn snapshot(&self) -> CallStats {
+        CallStats {
+            calls: self.calls.load(Ordering::Relaxed),
+            total_ns: self.total_ns.load(Ordering::Relaxed),
+            max_ns: self.max_ns.load(Ordering::Relaxed),
+            histogram: std::array::from_fn(|i| self.histogram[i].load(Ordering::Relaxed)),
+        }
+    }
+
+    fn reset(&self) {
+        self.calls.store(0, Ordering::Relaxed);
+        self.total_ns.store(0, Ordering::Relaxed);
+        self.max_ns.store(0, Ordering::Relaxed);
+        for bucket in &self.histogram {
+            bucket.store(0, Ordering::Relaxed);
+        }
+    }
+}
+
+pub(crate) fn enabled() -> bool {
+    ENABLED.load(Ordering::Relaxed)
+}
+
+/// Starts timing a call. Returns `None` without reading the clock when disabled.
+pub(crate) fn start() -> Option<Instant> {
+    enabled().then(Instant::now)
+}
+
+/// Enables or disables the performance counters.
+///
+/// Counters are disabled by default; while disabled, instrumented calls only pay for one
+/// relaxed atomic load.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_stats_enable(enabled: bool) {
+    ENABLED.store(enabled, Ordering::Relaxed);
+}
+
+/// Copies the current counters into `stats`.
+///
+/// Counters are read individually, so a snapshot taken while other threads are making
+/// calls may be off by the calls in flight.
+///
+/// # Safety
+///
+/// The `stats` pointer must be a valid pointer to a Stats instance.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_stats_snapshot(stats: *mut Stats) {
+    unsafe {
+        *stats = Stats {
+            new_handle: NEW.snapshot(),
+            next_states: NEXT_STATES.snapshot(),
+            item_new: ITEM_NEW.snapshot(),
+            compute_parameters: COMPUTE_PARAMETERS.snapshot(),
+            epochs: EPOCHS.snapshot(),
+        }
+    };
+}
+
+/// Resets all counters to zero.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_stats_reset() {
+    for counter in [&NEW, &NEXT_STATES, &ITEM_NEW, &COMPUTE_PARAMETERS, &EPOCHS] {
+        counter.reset();
+    }
+}
@@ -0,0 +1,151 @@
+use std::ffi::{CStr, c_char};
+use std::fs::File;
+use std::io::{BufWriter, Write};
+use std::sync::Mutex;
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::time::Instant;
+
+static ACTIVE: AtomicBool = AtomicBool::new(false);
+static TRACE: Mutex<Option<Trace>> = Mutex::new(None);
+static NEXT_THREAD_ID: AtomicU64 = AtomicU64::new(1);
+
+thread_local! {
+    static THREAD_ID: u64 = NEXT_THREAD_ID.fetch_add(1, Ordering::Relaxed);
+}
+
+/// An open Chrome trace-event file.
+struct Trace {
+    out: BufWriter<File>,
+    origin: Instant,
+    empty: bool,
+}
+
+impl Trace {
+    fn write_event(
+        &mut self,
+        name: &str,
+        tid: u64,
+        start: Instant,
+        end: Instant,
+        arg: Option<(&str, u64)>,
+    ) -> std::io::Result<()> {
+        let ts = start.saturating_duration_since(self.origin).as_nanos() as f64 / 1000.0;
+        let dur = end.saturating_duration_since(start).as_nanos() as f64 / 1000.0;
+        let separator = if self.empty { "\n" } else { ",\n" };
+        self.empty = false;
+        write!(
+            self.out,
+            r#"{separator}{{"name":"{name}","cat":"fsrs","ph":"X","pid":1,"tid":{tid},"ts":{ts:.3},"dur":{dur:.3}"#
+        )?;
+        if let Some((key, value)) = arg {
+            write!(self.out, r#","args":{{"{key}":{value}}}"#)?;
+        }
+        write!(self.out, "}}")
+    }
+}
+
+pub(crate) fn enabled() -> bool {
+    ACTIVE.load(Ordering::Relaxed)
+}
+
+/// A small per-thread id, stable for the life of the thread.
+pub(crate) fn thread_id() -> u64 {
+    THREAD_ID.with(|id| *id)
+}
+
+/// Records a complete span on thread `tid`, if tracing is active.
+pub(crate) fn complete(
+    name: &str,
+    tid: u64,
+    start: Instant,
+    end: Instant,
+    arg: Option<(&str, u64)>,
+) {
+    if !enabled() {
+        return;
+    }
+    if let Some(trace) = TRACE.lock().unwrap().as_mut() {
+        // A failed write only loses this event; the file is closed properly on stop.
+        let _ = trace.write_event(name, tid, start, end, arg);
+    }
+}
+
+/// A span that is recorded on the current thread when dropped.
+pub(crate) struct Span {
+    name: &'static str,
+    start: Option<Instant>,
+    arg: Option<(&'static str, u64)>,
+}
+
+impl Drop for Span {
+    fn drop(&mut self) {
+        if let Some(start) = self.start {
+            complete(self.name, thread_id(), start, Instant::now(), self.arg);
+        }
+    }
+}
+
+/// Opens a span named `name`. Does not read the clock unless tracing is active.
+pub(crate) fn span(name: &'static str) -> Span {
+    Span {
+        name,
+        start: enabled().then(Instant::now),
+        arg: None,
+    }
+}
+
+/// Like `span`, with one numeric argument shown in the trace viewer.
+pub(crate) fn span_with(name: &'static str, key: &'static str, value: u64) -> Span {
+    Span {
+        name,
+        start: enabled().then(Instant::now),
+        arg: Some((key, value)),
+    }
+}
+
+/// Starts writing a Chrome trace-event JSON file to `path`.
+///
+/// While tracing is active, `fsrs_compute_parameters` records spans for train set
+/// conversion, training and each epoch. The file can be opened in Perfetto or
+/// `chrome://tracing` after `fsrs_trace_stop`. Returns false if the file cannot be
+/// created or a trace is already active.
+///
+/// # Safety
+///
+/// The `path` pointer must be a valid pointer to a NUL-terminated string.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_trace_start(path: *const c_char) -> bool {
+    let Ok(path) = unsafe { CStr::from_ptr(path) }.to_str() else {
+        return false;
+    };
+    let mut trace = TRACE.lock().unwrap();
+    if trace.is_some() {
+        return false;
+    }
+    let Ok(file) = File::create(path) else {
+        return false;
+    };
+    let mut out = BufWriter::new(file);
+    if write!(out, r#"{{"displayTimeUnit":"ms","traceEvents":["#).is_err() {
+        return false;
+    }
+    *trace = Some(Trace {
+        out,
+        origin: Instant::now(),
+        empty: true,
+    });
+    ACTIVE.store(true, Ordering::Relaxed);
+    true
+}
+
+/// Stops tracing and finishes the trace file.
+///
+/// Returns false if no trace was active or the file could not be written completely.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_trace_stop() -> bool {
+    ACTIVE.store(false, Ordering::Relaxed);
+    let Some(mut trace) = TRACE.lock().unwrap().take() else {
+        return false;
+    };
+    write!(trace.out, "\n]}}\n").is_ok() && trace.out.flush().is_ok()
+}
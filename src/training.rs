@@ -0,0 +1,211 @@
+use std::sync::{Arc, Mutex};
+
+use fsrs::{CombinedProgressState, ComputeParametersInput, FSRSItem};
+
+use crate::due::mix;
+use crate::{FSRS, FsrsItems, parallel, progress, stats, trace};
+
+/// Train sets smaller than this are always trained in one pass; staging would save little.
+const EARLY_STOPPING_MIN_ITEMS: usize = 10_000;
+/// One in this many items is held out to score the stages of an early-stopping run.
+const HOLDOUT_EVERY: u64 = 10;
+/// Stage `k` of an early-stopping run trains on `STAGE_FRACTIONS[k]` eighths of the items.
+/// Stages only pay off when they stop training, so there are just two: a plateau is
+/// detected at 3/8 of a full run's items, and a run that does not plateau costs 3/8
+/// more than a full run alone (less the holdout).
+const STAGE_FRACTIONS: [u64; 2] = [1, 2];
+
+/// Options for `fsrs_compute_parameters_with_config`.
+///
+/// Start from `fsrs_training_config_default` so that fields added later keep their
+/// default values.
+///
+/// The fsrs crate fixes the optimizer's batch size, epoch count and learning rate, so
+/// training time is traded for accuracy at the level of the train set instead: with
+/// `early_stopping_tolerance` set, training runs on growing subsets of the items and
+/// stops once a larger subset no longer improves the loss.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct TrainingConfig {
+    /// Number of threads the training backend may use. Training runs on a dedicated pool
+    /// of exactly this many workers, so concurrent jobs do not share or oversubscribe
+    /// threads. 0 uses the shared pool (see `fsrs_set_num_threads`).
+    pub num_threads: usize,
+    /// Whether to fit the short-term (same-day review) parameters. Defaults to true.
+    pub enable_short_term: bool,
+    /// Number of relearning steps the collection uses, which the short-term parameters
+    /// are fitted against. Negative leaves it to the trainer. Defaults to -1.
+    pub num_relearning_steps: i32,
+    /// Stops training early once the loss plateaus. Training then runs on 1/8 and then
+    /// 1/4 of the items, scoring each result by log loss on a fixed held-out tenth. If
+    /// the second improved on the first by less than this fraction, the better of the
+    /// two is kept, for about a third of the items a single run trains on; otherwise
+    /// training runs on every item as usual, about 1.35 times a single run in all. 0
+    /// disables it, as does a train set of fewer than 10 000 items. Defaults to 0.
+    pub early_stopping_tolerance: f32,
+}
+
+impl Default for TrainingConfig {
+    fn default() -> Self {
+        TrainingConfig {
+            num_threads: 0,
+            enable_short_term: true,
+            num_relearning_steps: -1,
+            early_stopping_tolerance: 0.0,
+        }
+    }
+}
+
+type Progress = Option<Arc<Mutex<CombinedProgressState>>>;
+
+fn train_once(
+    fsrs: &FSRS,
+    train_set: Vec<FSRSItem>,
+    progress: Progress,
+    config: &TrainingConfig,
+) -> fsrs::Result<Vec<f32>> {
+    fsrs.model.compute_parameters(ComputeParametersInput {
+        train_set,
+        progress,
+        enable_short_term: config.enable_short_term,
+        num_relearning_steps: usize::try_from(config.num_relearning_steps).ok(),
+    })
+}
+
+/// Trains on growing subsets of `train_set` until the held-out loss plateaus, as
+/// described for `TrainingConfig::early_stopping_tolerance`.
+fn train_with_early_stopping(
+    fsrs: &FSRS,
+    train_set: Vec<FSRSItem>,
+    progress: Progress,
+    config: &TrainingConfig,
+) -> fsrs::Result<Vec<f32>> {
+    // Items are assigned to the holdout and to subsets by hashed position, so each
+    // subset is spread over the whole train set and contains the smaller ones.
+    let mut holdout = Vec::new();
+    let mut staged = Vec::with_capacity(train_set.len());
+    for (i, item) in train_set.iter().enumerate() {
+        let hash = mix(i as u64);
+        if hash.is_multiple_of(HOLDOUT_EVERY) {
+            holdout.push(item.clone());
+        } else {
+            staged.push(((hash >> 32) % 8, item));
+        }
+    }
+    let mut previous: Option<(f32, Vec<f32>)> = None;
+    for eighths in STAGE_FRACTIONS {
+        let subset: Vec<FSRSItem> = staged
+            .iter()
+            .filter(|(class, _)| *class < eighths)
+            .map(|(_, item)| (*item).clone())
+            .collect();
+        let _span = trace::span_with("train_stage", "items", subset.len() as u64);
+        let parameters = train_once(fsrs, subset, progress.clone(), config)?;
+        let loss = fsrs::FSRS::new(Some(&parameters))?
+            .evaluate(holdout.clone(), |_| true)?
+            .log_loss;
+        if let Some((previous_loss, previous_parameters)) = previous.take()
+            && previous_loss - loss < config.early_stopping_tolerance * previous_loss
+        {
+            // The loss can also rise slightly; keep whichever stage scored better.
+            return Ok(if loss <= previous_loss {
+                parameters
+            } else {
+                previous_parameters
+            });
+        }
+        previous = Some((loss, parameters));
+    }
+    train_once(fsrs, train_set, progress, config)
+}
+
+pub(crate) unsafe fn compute_parameters(
+    fsrs: *const FSRS,
+    train_set: *mut FsrsItems,
+    config: &TrainingConfig,
+    len: *mut usize,
+) -> *mut f32 {
+    let timer = stats::start();
+    let _span = trace::span("compute_parameters");
+    let fsrs = unsafe { &*fsrs };
+    let train_set: Vec<fsrs::FSRSItem> = unsafe {
+        let _span = trace::span_with("convert_train_set", "items", (*train_set).len as u64);
+        std::slice::from_raw_parts((*train_set).items, (*train_set).len)
+            .iter()
+            .map(|item| (*item).clone().into())
+            .collect()
+    };
+    let train = |progress| {
+        parallel::with_threads(config.num_threads, || {
+            if config.early_stopping_tolerance > 0.0 && train_set.len() >= EARLY_STOPPING_MIN_ITEMS
+            {
+                train_with_early_stopping(fsrs, train_set, progress, config)
+            } else {
+                train_once(fsrs, train_set, progress, config)
+            }
+        })
+    };
+    let train_span = trace::span("train");
+    let params = if stats::enabled() || trace::enabled() {
+        let tid = trace::thread_id();
+        progress::watch_epochs(
+            |progress| train(Some(progress)),
+            |epoch, started, finished| {
+                if stats::enabled() {
+                    stats::EPOCHS.record_ns((finished - started).as_nanos() as u64);
+                }
+                trace::complete(
+                    "epoch",
+                    tid,
+                    started,
+                    finished,
+                    Some(("epoch", epoch as u64)),
+                );
+            },
+        )
+    } else {
+        train(None)
+    };
+    drop(train_span);
+    let (params, params_len) = match params {
+        Ok(params) => {
+            let params_len = params.len();
+            (
+                Box::into_raw(params.into_boxed_slice()) as *mut f32,
+                params_len,
+            )
+        }
+        Err(_) => (std::ptr::null_mut(), 0),
+    };
+    unsafe { *len = params_len };
+    stats::COMPUTE_PARAMETERS.record(timer);
+    params
+}
+
+/// Returns the default training configuration.
+#[unsafe(no_mangle)]
+pub extern "C" fn fsrs_training_config_default() -> TrainingConfig {
+    TrainingConfig::default()
+}
+
+/// Computes the parameters for a given train set with explicit training options.
+///
+/// Behaves like `fsrs_compute_parameters`, including how the parameter count is
+/// reported through `len`.
+///
+/// # Safety
+///
+/// The `fsrs` pointer must be a valid pointer to an FSRS instance.
+/// The `train_set` pointer must be a valid pointer to an array of FSRSItem.
+/// The `config` pointer must be a valid pointer to a TrainingConfig instance.
+/// The `len` pointer must be a valid pointer to a size_t.
+/// The returned pointer must be freed with `fsrs_parameters_free`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn fsrs_compute_parameters_with_config(
+    fsrs: *const FSRS,
+    train_set: *mut FsrsItems,
+    config: *const TrainingConfig,
+    len: *mut usize,
+) -> *mut f32 {
+    unsafe { compute_parameters(fsrs, train_set, &*config, len) }
+}